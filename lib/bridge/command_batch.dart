@@ -0,0 +1,155 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:karrolle/bridge/native_api.dart';
+
+/// Encodes edits for [NativeApi.executeBatch]; the layout mirrors
+/// `native/src/io/command_batch.hpp`.
+///
+/// The add methods return a placeholder id (-1 for the first add, -2 for
+/// the second, ...) that later commands in the same batch can target.
+class CommandBatch {
+  final BytesBuilder _bytes = BytesBuilder();
+  int _adds = 0;
+
+  bool get isEmpty => _bytes.isEmpty;
+
+  int addRect(double x, double y, double w, double h, int color) {
+    _op(1);
+    _floats([x, y, w, h]);
+    _u32(color);
+    return --_adds;
+  }
+
+  int addEllipse(double x, double y, double w, double h, int color) {
+    _op(2);
+    _floats([x, y, w, h]);
+    _u32(color);
+    return --_adds;
+  }
+
+  int addLine(
+    double x1,
+    double y1,
+    double x2,
+    double y2,
+    int color,
+    double thickness,
+  ) {
+    _op(3);
+    _floats([x1, y1, x2, y2]);
+    _u32(color);
+    _floats([thickness]);
+    return --_adds;
+  }
+
+  int addText(double x, double y, String text, int color, double size) {
+    _op(4);
+    _floats([x, y]);
+    _u32(color);
+    _floats([size]);
+    _string(text);
+    return --_adds;
+  }
+
+  int addImage(
+    double x,
+    double y,
+    double w,
+    double h,
+    Uint32List pixels,
+    int imgW,
+    int imgH,
+  ) {
+    _op(5);
+    _floats([x, y, w, h]);
+    _i32(imgW);
+    _i32(imgH);
+    _bytes.add(pixels.buffer.asUint8List(pixels.offsetInBytes, imgW * imgH * 4));
+    return --_adds;
+  }
+
+  void moveObject(int id, double dx, double dy) {
+    _op(6);
+    _i32(id);
+    _floats([dx, dy]);
+  }
+
+  void moveSelection(double dx, double dy) {
+    _op(7);
+    _floats([dx, dy]);
+  }
+
+  void setObjectRect(int id, double x, double y, double w, double h) {
+    _op(8);
+    _i32(id);
+    _floats([x, y, w, h]);
+  }
+
+  void setObjectColor(int id, int color) {
+    _op(9);
+    _i32(id);
+    _u32(color);
+  }
+
+  void setObjectText(int id, String text) {
+    _op(10);
+    _i32(id);
+    _string(text);
+  }
+
+  void setObjectFontSize(int id, double size) {
+    _op(11);
+    _i32(id);
+    _floats([size]);
+  }
+
+  void removeObject(int id) {
+    _op(12);
+    _i32(id);
+  }
+
+  void selectObject(int id, {bool addToSelection = false}) {
+    _op(13);
+    _i32(id);
+    _op(addToSelection ? 1 : 0);
+  }
+
+  void clearSelection() => _op(14);
+
+  void reorderObject(int id, int index) {
+    _op(15);
+    _i32(id);
+    _i32(index);
+  }
+
+  /// Applies the batch as one undo step and returns the ids of the added
+  /// objects in order, or null if the engine rejected the stream.
+  List<int>? execute() {
+    final addCount = -_adds;
+    _adds = 0;
+    return NativeApi.executeBatch(_bytes.takeBytes(), addCount);
+  }
+
+  void _op(int op) => _bytes.addByte(op);
+
+  void _i32(int v) =>
+      _bytes.add((ByteData(4)..setInt32(0, v, Endian.little)).buffer.asUint8List());
+
+  void _u32(int v) =>
+      _bytes.add((ByteData(4)..setUint32(0, v, Endian.little)).buffer.asUint8List());
+
+  void _floats(List<double> values) {
+    final data = ByteData(values.length * 4);
+    for (var i = 0; i < values.length; i++) {
+      data.setFloat32(i * 4, values[i], Endian.little);
+    }
+    _bytes.add(data.buffer.asUint8List());
+  }
+
+  void _string(String s) {
+    final utf8Bytes = utf8.encode(s);
+    _u32(utf8Bytes.length);
+    _bytes.add(utf8Bytes);
+  }
+}
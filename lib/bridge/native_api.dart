@@ -85,6 +85,22 @@ typedef EngineAddImageDart =
       int imgH,
     );
 
+// Command batch
+typedef EngineExecuteBatchC =
+    Int32 Function(
+      Pointer<Uint8> cmds,
+      Size len,
+      Pointer<Int32> ids,
+      Int32 idCapacity,
+    );
+typedef EngineExecuteBatchDart =
+    int Function(
+      Pointer<Uint8> cmds,
+      int len,
+      Pointer<Int32> ids,
+      int idCapacity,
+    );
+
 // Font
 typedef EngineLoadFontC = Void Function(Pointer<Uint8> data, Int32 length);
 typedef EngineLoadFontDart = void Function(Pointer<Uint8> data, int length);
@@ -93,6 +109,94 @@ typedef EngineLoadFontDart = void Function(Pointer<Uint8> data, int length);
 typedef EngineImportPptxC = Void Function(Pointer<Utf8> filepath);
 typedef EngineImportPptxDart = void Function(Pointer<Utf8> filepath);
 
+typedef EngineSetCacheDirectoryC =
+    Void Function(Pointer<Utf8> directory, Int64 maxBytes);
+typedef EngineSetCacheDirectoryDart =
+    void Function(Pointer<Utf8> directory, int maxBytes);
+
+typedef EngineSetImportImageDpiC =
+    Void Function(Float dpi, Bool keepOriginals);
+typedef EngineSetImportImageDpiDart =
+    void Function(double dpi, bool keepOriginals);
+
+// Decoded pictures
+typedef EngineSetImageCacheBudgetC = Void Function(Int64 maxBytes);
+typedef EngineSetImageCacheBudgetDart = void Function(int maxBytes);
+typedef EngineTrimMemoryC = Void Function(Int32 level);
+typedef EngineTrimMemoryDart = void Function(int level);
+
+// Native documents
+typedef EngineSaveDocumentC = Bool Function(Pointer<Utf8> filepath);
+typedef EngineSaveDocumentDart = bool Function(Pointer<Utf8> filepath);
+typedef EngineOpenDocumentC = Bool Function(Pointer<Utf8> filepath);
+typedef EngineOpenDocumentDart = bool Function(Pointer<Utf8> filepath);
+
+// Edit journal
+typedef EngineJournalOpenC = Bool Function(Pointer<Utf8> filepath);
+typedef EngineJournalOpenDart = bool Function(Pointer<Utf8> filepath);
+typedef EngineJournalFlushC = Bool Function();
+typedef EngineJournalFlushDart = bool Function();
+typedef EngineJournalCheckpointC = Bool Function();
+typedef EngineJournalCheckpointDart = bool Function();
+typedef EngineJournalCloseC = Void Function();
+typedef EngineJournalCloseDart = void Function();
+typedef EngineJournalRecoverC = Bool Function(Pointer<Utf8> filepath);
+typedef EngineJournalRecoverDart = bool Function(Pointer<Utf8> filepath);
+
+// Change events (mirrors EngineEvent in engine.h)
+final class EngineEvent extends Struct {
+  @Uint32()
+  external int type;
+  @Int32()
+  external int uid;
+  @Uint32()
+  external int mask;
+  @Int32()
+  external int index;
+}
+
+const int engineEventObjectAdded = 1;
+const int engineEventObjectRemoved = 2;
+const int engineEventObjectModified = 3;
+const int engineEventSelectionChanged = 4;
+const int engineEventZOrderChanged = 5;
+const int engineEventReset = 6;
+
+const int engineFieldGeometry = 1;
+const int engineFieldColor = 2;
+const int engineFieldText = 4;
+const int engineFieldFontSize = 8;
+
+class SceneEvent {
+  final int type;
+  final int uid;
+  final int mask;
+  final int index;
+
+  const SceneEvent(this.type, this.uid, this.mask, this.index);
+}
+
+typedef EnginePollEventsC =
+    Int32 Function(Pointer<EngineEvent> buffer, Int32 capacity);
+typedef EnginePollEventsDart =
+    int Function(Pointer<EngineEvent> buffer, int capacity);
+
+// Undo/redo
+typedef EngineBeginTransactionC = Void Function();
+typedef EngineBeginTransactionDart = void Function();
+typedef EngineCommitC = Void Function();
+typedef EngineCommitDart = void Function();
+typedef EngineUndoC = Bool Function();
+typedef EngineUndoDart = bool Function();
+typedef EngineRedoC = Bool Function();
+typedef EngineRedoDart = bool Function();
+typedef EngineCanUndoC = Bool Function();
+typedef EngineCanUndoDart = bool Function();
+typedef EngineCanRedoC = Bool Function();
+typedef EngineCanRedoDart = bool Function();
+typedef EngineSetHistoryLimitC = Void Function(Int64 maxBytes);
+typedef EngineSetHistoryLimitDart = void Function(int maxBytes);
+
 // Interaction (Pick / Move / Update)
 typedef EnginePickC = Int32 Function(Int32 x, Int32 y);
 typedef EnginePickDart = int Function(int x, int y);
@@ -116,6 +220,8 @@ typedef EngineGetSelectedIdDart = int Function();
 
 typedef EngineRemoveObjectC = Void Function(Int32 id);
 typedef EngineRemoveObjectDart = void Function(int id);
+typedef EngineReorderObjectC = Void Function(Int32 id, Int32 index);
+typedef EngineReorderObjectDart = void Function(int id, int index);
 
 typedef EngineSelectObjectC = Void Function(Int32 id, Bool addToSelection);
 typedef EngineSelectObjectDart = void Function(int id, bool addToSelection);
@@ -126,6 +232,73 @@ typedef EngineGetSelectedCountDart = int Function();
 typedef EngineGetSelectedIdAtC = Int32 Function(Int32 index);
 typedef EngineGetSelectedIdAtDart = int Function(int index);
 
+// Scene snapshot (mirrors EngineObjectInfo in engine.h)
+final class EngineObjectInfo extends Struct {
+  @Int32()
+  external int uid;
+  @Int32()
+  external int type;
+  @Float()
+  external double x;
+  @Float()
+  external double y;
+  @Float()
+  external double w;
+  @Float()
+  external double h;
+  @Uint32()
+  external int color;
+  @Uint32()
+  external int flags;
+  @Uint32()
+  external int nameOffset;
+  @Uint32()
+  external int reserved;
+}
+
+const int engineObjectSelected = 1;
+const int engineObjectPrimary = 2;
+
+typedef EngineGetSceneSnapshotC =
+    Int32 Function(
+      Pointer<EngineObjectInfo> objects,
+      Int32 capacity,
+      Pointer<Uint8> names,
+      Int32 namesCapacity,
+      Pointer<Int32> namesSize,
+    );
+typedef EngineGetSceneSnapshotDart =
+    int Function(
+      Pointer<EngineObjectInfo> objects,
+      int capacity,
+      Pointer<Uint8> names,
+      int namesCapacity,
+      Pointer<Int32> namesSize,
+    );
+
+class SceneObjectInfo {
+  final int uid;
+  final int type;
+  final double x, y, w, h;
+  final int color;
+  final int flags;
+  final String name;
+
+  const SceneObjectInfo({
+    required this.uid,
+    required this.type,
+    required this.x,
+    required this.y,
+    required this.w,
+    required this.h,
+    required this.color,
+    required this.flags,
+    required this.name,
+  });
+
+  bool get isSelected => flags & engineObjectSelected != 0;
+}
+
 typedef EnginePickHandleC = Int32 Function(Int32 x, Int32 y);
 typedef EnginePickHandleDart = int Function(int x, int y);
 
@@ -173,6 +346,111 @@ typedef EngineGetObjectFontSizeDart = double Function(int id);
 typedef EngineSetObjectFontSizeC = Void Function(Int32 id, Float size);
 typedef EngineSetObjectFontSizeDart = void Function(int id, double size);
 
+// Snapshots (render off the UI thread while editing continues)
+typedef SnapshotHandle = Pointer<Void>;
+typedef EngineSnapshotC = SnapshotHandle Function();
+typedef EngineSnapshotDart = SnapshotHandle Function();
+typedef EngineSnapshotVersionC = Uint64 Function(SnapshotHandle snapshot);
+typedef EngineSnapshotVersionDart = int Function(SnapshotHandle snapshot);
+typedef EngineRenderSnapshotC =
+    Void Function(
+      SnapshotHandle snapshot,
+      Pointer<Uint32> buffer,
+      Int32 width,
+      Int32 height,
+    );
+typedef EngineRenderSnapshotDart =
+    void Function(
+      SnapshotHandle snapshot,
+      Pointer<Uint32> buffer,
+      int width,
+      int height,
+    );
+typedef EngineRenderSnapshotRowsC =
+    Void Function(
+      SnapshotHandle snapshot,
+      Pointer<Uint32> buffer,
+      Int32 width,
+      Int32 height,
+      Int32 top,
+      Int32 rows,
+    );
+typedef EngineRenderSnapshotRowsDart =
+    void Function(
+      SnapshotHandle snapshot,
+      Pointer<Uint32> buffer,
+      int width,
+      int height,
+      int top,
+      int rows,
+    );
+typedef EngineReleaseSnapshotC = Void Function(SnapshotHandle snapshot);
+typedef EngineReleaseSnapshotDart = void Function(SnapshotHandle snapshot);
+
+// Export
+typedef EngineExportPngC =
+    Bool Function(Pointer<Utf8> path, Int32 width, Int32 height, Int32 level);
+typedef EngineExportPngDart =
+    bool Function(Pointer<Utf8> path, int width, int height, int level);
+typedef EngineExportPdfC =
+    Bool Function(Pointer<Utf8> path, Int32 width, Int32 height);
+typedef EngineExportPdfDart =
+    bool Function(Pointer<Utf8> path, int width, int height);
+
+// Pages
+typedef EngineGetPageCountC = Int32 Function();
+typedef EngineGetPageCountDart = int Function();
+typedef EnginePageIndexC = Int32 Function(Int32 index);
+typedef EnginePageIndexDart = int Function(int index);
+typedef EnginePageFlagC = Bool Function(Int32 index);
+typedef EnginePageFlagDart = bool Function(int index);
+typedef EngineMovePageC = Bool Function(Int32 from, Int32 to);
+typedef EngineMovePageDart = bool Function(int from, int to);
+typedef EngineSetImageSmoothingC = Void Function(Bool enabled);
+typedef EngineSetImageSmoothingDart = void Function(bool enabled);
+typedef EngineRenderPageC =
+    Void Function(
+      Int32 index,
+      Pointer<Uint32> buffer,
+      Int32 width,
+      Int32 height,
+    );
+typedef EngineRenderPageDart =
+    void Function(int index, Pointer<Uint32> buffer, int width, int height);
+
+// Engine instances (worker threads: thumbnails, export)
+typedef EngineHandle = Pointer<Void>;
+typedef EngineCreateC = EngineHandle Function();
+typedef EngineCreateDart = EngineHandle Function();
+typedef EngineDestroyC = Void Function(EngineHandle engine);
+typedef EngineDestroyDart = void Function(EngineHandle engine);
+typedef EngineHLoadFontC =
+    Void Function(EngineHandle engine, Pointer<Uint8> data, Int32 length);
+typedef EngineHLoadFontDart =
+    void Function(EngineHandle engine, Pointer<Uint8> data, int length);
+typedef EngineHPathC = Void Function(EngineHandle engine, Pointer<Utf8> path);
+typedef EngineHPathDart = void Function(EngineHandle engine, Pointer<Utf8> path);
+typedef EngineHOpenDocumentC =
+    Bool Function(EngineHandle engine, Pointer<Utf8> filepath);
+typedef EngineHOpenDocumentDart =
+    bool Function(EngineHandle engine, Pointer<Utf8> filepath);
+typedef EngineHRenderC =
+    Void Function(
+      EngineHandle engine,
+      Pointer<Uint32> buffer,
+      Int32 width,
+      Int32 height,
+    );
+typedef EngineHRenderDart =
+    void Function(
+      EngineHandle engine,
+      Pointer<Uint32> buffer,
+      int width,
+      int height,
+    );
+typedef EngineHGetObjectCountC = Int32 Function(EngineHandle engine);
+typedef EngineHGetObjectCountDart = int Function(EngineHandle engine);
+
 class NativeApi {
   static late DynamicLibrary _lib;
   static bool _initialized = false;
@@ -185,8 +463,51 @@ class NativeApi {
   static late EngineAddLineDart _engineAddLine;
   static late EngineAddTextDart _engineAddText;
   static late EngineAddImageDart _engineAddImage;
+  static late EngineExecuteBatchDart _engineExecuteBatch;
+  static late EngineCreateDart _engineCreate;
+  static late EngineDestroyDart _engineDestroy;
+  static late EngineHLoadFontDart _engineHLoadFont;
+  static late EngineHPathDart _engineHImportPptx;
+  static late EngineHOpenDocumentDart _engineHOpenDocument;
+  static late EngineHRenderDart _engineHRender;
+  static late EngineSnapshotDart _engineSnapshot;
+  static late EngineSnapshotVersionDart _engineSnapshotVersion;
+  static late EngineRenderSnapshotDart _engineRenderSnapshot;
+  static late EngineRenderSnapshotRowsDart _engineRenderSnapshotRows;
+  static late EngineReleaseSnapshotDart _engineReleaseSnapshot;
+  static late EngineExportPngDart _engineExportPng;
+  static late EngineExportPdfDart _engineExportPdf;
+  static late EngineGetPageCountDart _engineGetPageCount;
+  static late EngineGetPageCountDart _engineGetActivePage;
+  static late EnginePageFlagDart _engineSetActivePage;
+  static late EnginePageIndexDart _engineAddPage;
+  static late EnginePageIndexDart _engineDuplicatePage;
+  static late EnginePageFlagDart _engineRemovePage;
+  static late EngineMovePageDart _engineMovePage;
+  static late EngineRenderPageDart _engineRenderPage;
+  static late EngineRenderPageDart _engineRenderThumbnail;
+  static late EngineSetImageSmoothingDart _engineSetImageSmoothing;
+  static late EngineHGetObjectCountDart _engineHGetObjectCount;
   static late EngineLoadFontDart _engineLoadFont;
   static late EngineImportPptxDart _engineImportPptx;
+  static late EngineSetCacheDirectoryDart _engineSetCacheDirectory;
+  static late EngineSetImportImageDpiDart _engineSetImportImageDpi;
+  static late EngineSetImageCacheBudgetDart _engineSetImageCacheBudget;
+  static late EngineTrimMemoryDart _engineTrimMemory;
+  static late EngineSaveDocumentDart _engineSaveDocument;
+  static late EngineOpenDocumentDart _engineOpenDocument;
+  static late EngineJournalOpenDart _engineJournalOpen;
+  static late EngineJournalFlushDart _engineJournalFlush;
+  static late EngineJournalCheckpointDart _engineJournalCheckpoint;
+  static late EngineJournalCloseDart _engineJournalClose;
+  static late EngineJournalRecoverDart _engineJournalRecover;
+  static late EngineBeginTransactionDart _engineBeginTransaction;
+  static late EngineCommitDart _engineCommit;
+  static late EngineUndoDart _engineUndo;
+  static late EngineRedoDart _engineRedo;
+  static late EngineCanUndoDart _engineCanUndo;
+  static late EngineCanRedoDart _engineCanRedo;
+  static late EngineSetHistoryLimitDart _engineSetHistoryLimit;
   static late EnginePickDart _enginePick;
   static late EnginePickHandleDart _enginePickHandle;
   static late EngineMoveObjectDart _engineMoveObject;
@@ -195,10 +516,13 @@ class NativeApi {
   static late EngineSetObjectColorDart _engineSetObjectColor;
   static late EngineGetSelectedIdDart _engineGetSelectedId;
   static late EngineRemoveObjectDart _engineRemoveObject;
+  static late EngineReorderObjectDart _engineReorderObject;
+  static late EnginePollEventsDart _enginePollEvents;
   static late EngineSelectObjectDart _engineSelectObject;
   static late EngineClearSelectionDart _engineClearSelection;
   static late EngineGetSelectedCountDart _engineGetSelectedCount;
   static late EngineGetSelectedIdAtDart _engineGetSelectedIdAt;
+  static late EngineGetSceneSnapshotDart _engineGetSceneSnapshot;
   static late EngineGetObjectUidDart _engineGetObjectUid;
   static late EngineGetObjectBoundsDart _engineGetObjectBounds;
   static late EngineGetObjectColorDart _engineGetObjectColor;
@@ -244,6 +568,103 @@ class NativeApi {
           .lookupFunction<EngineAddImageC, EngineAddImageDart>(
             'engine_add_image',
           );
+      _engineCreate = _lib.lookupFunction<EngineCreateC, EngineCreateDart>(
+        'engine_create',
+      );
+      _engineDestroy = _lib.lookupFunction<EngineDestroyC, EngineDestroyDart>(
+        'engine_destroy',
+      );
+      _engineHLoadFont = _lib
+          .lookupFunction<EngineHLoadFontC, EngineHLoadFontDart>(
+            'engine_h_load_font',
+          );
+      _engineHImportPptx = _lib.lookupFunction<EngineHPathC, EngineHPathDart>(
+        'engine_h_import_pptx',
+      );
+      _engineHOpenDocument = _lib
+          .lookupFunction<EngineHOpenDocumentC, EngineHOpenDocumentDart>(
+            'engine_h_open_document',
+          );
+      _engineHRender = _lib.lookupFunction<EngineHRenderC, EngineHRenderDart>(
+        'engine_h_render',
+      );
+      _engineHGetObjectCount = _lib
+          .lookupFunction<EngineHGetObjectCountC, EngineHGetObjectCountDart>(
+            'engine_h_get_object_count',
+          );
+      _engineSnapshot = _lib
+          .lookupFunction<EngineSnapshotC, EngineSnapshotDart>(
+            'engine_snapshot',
+          );
+      _engineSnapshotVersion = _lib
+          .lookupFunction<EngineSnapshotVersionC, EngineSnapshotVersionDart>(
+            'engine_snapshot_version',
+          );
+      _engineRenderSnapshot = _lib
+          .lookupFunction<EngineRenderSnapshotC, EngineRenderSnapshotDart>(
+            'engine_render_snapshot',
+          );
+      _engineRenderSnapshotRows = _lib
+          .lookupFunction<
+            EngineRenderSnapshotRowsC,
+            EngineRenderSnapshotRowsDart
+          >('engine_render_snapshot_rows');
+      _engineReleaseSnapshot = _lib
+          .lookupFunction<EngineReleaseSnapshotC, EngineReleaseSnapshotDart>(
+            'engine_release_snapshot',
+          );
+      _engineExportPng = _lib
+          .lookupFunction<EngineExportPngC, EngineExportPngDart>(
+            'engine_export_png',
+          );
+      _engineExportPdf = _lib
+          .lookupFunction<EngineExportPdfC, EngineExportPdfDart>(
+            'engine_export_pdf',
+          );
+      _engineGetPageCount = _lib
+          .lookupFunction<EngineGetPageCountC, EngineGetPageCountDart>(
+            'engine_get_page_count',
+          );
+      _engineGetActivePage = _lib
+          .lookupFunction<EngineGetPageCountC, EngineGetPageCountDart>(
+            'engine_get_active_page',
+          );
+      _engineSetActivePage = _lib
+          .lookupFunction<EnginePageFlagC, EnginePageFlagDart>(
+            'engine_set_active_page',
+          );
+      _engineAddPage = _lib
+          .lookupFunction<EnginePageIndexC, EnginePageIndexDart>(
+            'engine_add_page',
+          );
+      _engineDuplicatePage = _lib
+          .lookupFunction<EnginePageIndexC, EnginePageIndexDart>(
+            'engine_duplicate_page',
+          );
+      _engineRemovePage = _lib
+          .lookupFunction<EnginePageFlagC, EnginePageFlagDart>(
+            'engine_remove_page',
+          );
+      _engineMovePage = _lib
+          .lookupFunction<EngineMovePageC, EngineMovePageDart>(
+            'engine_move_page',
+          );
+      _engineRenderPage = _lib
+          .lookupFunction<EngineRenderPageC, EngineRenderPageDart>(
+            'engine_render_page',
+          );
+      _engineRenderThumbnail = _lib
+          .lookupFunction<EngineRenderPageC, EngineRenderPageDart>(
+            'engine_render_thumbnail',
+          );
+      _engineSetImageSmoothing = _lib
+          .lookupFunction<EngineSetImageSmoothingC, EngineSetImageSmoothingDart>(
+            'engine_set_image_smoothing',
+          );
+      _engineExecuteBatch = _lib
+          .lookupFunction<EngineExecuteBatchC, EngineExecuteBatchDart>(
+            'engine_execute_batch',
+          );
       _engineLoadFont = _lib
           .lookupFunction<EngineLoadFontC, EngineLoadFontDart>(
             'engine_load_font',
@@ -252,6 +673,74 @@ class NativeApi {
           .lookupFunction<EngineImportPptxC, EngineImportPptxDart>(
             'engine_import_pptx',
           );
+      _engineSetCacheDirectory = _lib
+          .lookupFunction<EngineSetCacheDirectoryC, EngineSetCacheDirectoryDart>(
+            'engine_set_cache_directory',
+          );
+      _engineSetImportImageDpi = _lib
+          .lookupFunction<EngineSetImportImageDpiC, EngineSetImportImageDpiDart>(
+            'engine_set_import_image_dpi',
+          );
+      _engineSetImageCacheBudget = _lib
+          .lookupFunction<
+            EngineSetImageCacheBudgetC,
+            EngineSetImageCacheBudgetDart
+          >('engine_set_image_cache_budget');
+      _engineTrimMemory = _lib
+          .lookupFunction<EngineTrimMemoryC, EngineTrimMemoryDart>(
+            'engine_trim_memory',
+          );
+      _engineSaveDocument = _lib
+          .lookupFunction<EngineSaveDocumentC, EngineSaveDocumentDart>(
+            'engine_save_document',
+          );
+      _engineOpenDocument = _lib
+          .lookupFunction<EngineOpenDocumentC, EngineOpenDocumentDart>(
+            'engine_open_document',
+          );
+      _engineJournalOpen = _lib
+          .lookupFunction<EngineJournalOpenC, EngineJournalOpenDart>(
+            'engine_journal_open',
+          );
+      _engineJournalFlush = _lib
+          .lookupFunction<EngineJournalFlushC, EngineJournalFlushDart>(
+            'engine_journal_flush',
+          );
+      _engineJournalCheckpoint = _lib
+          .lookupFunction<EngineJournalCheckpointC, EngineJournalCheckpointDart>(
+            'engine_journal_checkpoint',
+          );
+      _engineJournalClose = _lib
+          .lookupFunction<EngineJournalCloseC, EngineJournalCloseDart>(
+            'engine_journal_close',
+          );
+      _engineJournalRecover = _lib
+          .lookupFunction<EngineJournalRecoverC, EngineJournalRecoverDart>(
+            'engine_journal_recover',
+          );
+      _engineBeginTransaction = _lib
+          .lookupFunction<EngineBeginTransactionC, EngineBeginTransactionDart>(
+            'engine_begin_transaction',
+          );
+      _engineCommit = _lib.lookupFunction<EngineCommitC, EngineCommitDart>(
+        'engine_commit',
+      );
+      _engineUndo = _lib.lookupFunction<EngineUndoC, EngineUndoDart>(
+        'engine_undo',
+      );
+      _engineRedo = _lib.lookupFunction<EngineRedoC, EngineRedoDart>(
+        'engine_redo',
+      );
+      _engineCanUndo = _lib.lookupFunction<EngineCanUndoC, EngineCanUndoDart>(
+        'engine_can_undo',
+      );
+      _engineCanRedo = _lib.lookupFunction<EngineCanRedoC, EngineCanRedoDart>(
+        'engine_can_redo',
+      );
+      _engineSetHistoryLimit = _lib
+          .lookupFunction<EngineSetHistoryLimitC, EngineSetHistoryLimitDart>(
+            'engine_set_history_limit',
+          );
       _enginePick = _lib.lookupFunction<EnginePickC, EnginePickDart>(
         'engine_pick',
       );
@@ -279,6 +768,14 @@ class NativeApi {
           .lookupFunction<EngineGetSelectedIdC, EngineGetSelectedIdDart>(
             'engine_get_selected_id',
           );
+      _engineReorderObject = _lib
+          .lookupFunction<EngineReorderObjectC, EngineReorderObjectDart>(
+            'engine_reorder_object',
+          );
+      _enginePollEvents = _lib
+          .lookupFunction<EnginePollEventsC, EnginePollEventsDart>(
+            'engine_poll_events',
+          );
       _engineRemoveObject = _lib
           .lookupFunction<EngineRemoveObjectC, EngineRemoveObjectDart>(
             'engine_remove_object',
@@ -299,6 +796,10 @@ class NativeApi {
           .lookupFunction<EngineGetSelectedIdAtC, EngineGetSelectedIdAtDart>(
             'engine_get_selected_id_at',
           );
+      _engineGetSceneSnapshot = _lib
+          .lookupFunction<EngineGetSceneSnapshotC, EngineGetSceneSnapshotDart>(
+            'engine_get_scene_snapshot',
+          );
       _engineGetObjectUid = _lib
           .lookupFunction<EngineGetObjectUidC, EngineGetObjectUidDart>(
             'engine_get_object_uid',
@@ -362,6 +863,185 @@ class NativeApi {
     _engineRender(buffer, width, height);
   }
 
+  // Snapshots can be passed to another isolate (as their address) and
+  // rendered there without blocking edits; release each one when done.
+
+  static SnapshotHandle snapshot() {
+    if (!_initialized) initialize();
+    return _engineSnapshot();
+  }
+
+  static int snapshotVersion(SnapshotHandle snapshot) {
+    if (!_initialized) initialize();
+    return _engineSnapshotVersion(snapshot);
+  }
+
+  static void renderSnapshot(
+    SnapshotHandle snapshot,
+    Pointer<Uint32> buffer,
+    int width,
+    int height,
+  ) {
+    if (!_initialized) initialize();
+    _engineRenderSnapshot(snapshot, buffer, width, height);
+  }
+
+  // Rows [top, top + rows) of the canvas into a width * rows buffer
+  static void renderSnapshotRows(
+    SnapshotHandle snapshot,
+    Pointer<Uint32> buffer,
+    int width,
+    int height,
+    int top,
+    int rows,
+  ) {
+    if (!_initialized) initialize();
+    _engineRenderSnapshotRows(snapshot, buffer, width, height, top, rows);
+  }
+
+  static void releaseSnapshot(SnapshotHandle snapshot) {
+    if (!_initialized) initialize();
+    _engineReleaseSnapshot(snapshot);
+  }
+
+  // Blocks until the file is written; call it from another isolate
+  static bool exportPng(String path, int width, int height, int level) {
+    if (!_initialized) initialize();
+    final ptr = path.toNativeUtf8();
+    final ok = _engineExportPng(ptr, width, height, level);
+    calloc.free(ptr);
+    return ok;
+  }
+
+  // Vector PDF of the document, a page per page; blocks like exportPng
+  static bool exportPdf(String path, int width, int height) {
+    if (!_initialized) initialize();
+    final ptr = path.toNativeUtf8();
+    final ok = _engineExportPdf(ptr, width, height);
+    calloc.free(ptr);
+    return ok;
+  }
+
+  // Pages live in the engine; every other call acts on the active one.
+  // Switching queues a reset event, so the host reloads through pollEvents.
+
+  static int getPageCount() {
+    if (!_initialized) initialize();
+    return _engineGetPageCount();
+  }
+
+  static int getActivePage() {
+    if (!_initialized) initialize();
+    return _engineGetActivePage();
+  }
+
+  static bool setActivePage(int index) {
+    if (!_initialized) initialize();
+    return _engineSetActivePage(index);
+  }
+
+  // -1 appends; returns the new page's index
+  static int addPage([int index = -1]) {
+    if (!_initialized) initialize();
+    return _engineAddPage(index);
+  }
+
+  static int duplicatePage(int index) {
+    if (!_initialized) initialize();
+    return _engineDuplicatePage(index);
+  }
+
+  static bool removePage(int index) {
+    if (!_initialized) initialize();
+    return _engineRemovePage(index);
+  }
+
+  static bool movePage(int from, int to) {
+    if (!_initialized) initialize();
+    return _engineMovePage(from, to);
+  }
+
+  static void renderPage(
+    int index,
+    Pointer<Uint32> buffer,
+    int width,
+    int height,
+  ) {
+    if (!_initialized) initialize();
+    _engineRenderPage(index, buffer, width, height);
+  }
+
+  // Bilinear picture sampling (default); off is faster and keeps pixel art
+  // sharp
+  static void setImageSmoothing(bool enabled) {
+    if (!_initialized) initialize();
+    _engineSetImageSmoothing(enabled);
+  }
+
+  // Sidebar preview of a page, rendered at its size and cached by the
+  // engine until the page changes
+  static void renderThumbnail(
+    int index,
+    Pointer<Uint32> buffer,
+    int width,
+    int height,
+  ) {
+    if (!_initialized) initialize();
+    _engineRenderThumbnail(index, buffer, width, height);
+  }
+
+  // Independent engine instances: safe to use from another isolate while
+  // the default instance is being edited. Each isolate calls these through
+  // its own NativeApi (the library is loaded once per process).
+
+  static EngineHandle createEngine() {
+    if (!_initialized) initialize();
+    return _engineCreate();
+  }
+
+  static void destroyEngine(EngineHandle engine) {
+    if (!_initialized) initialize();
+    _engineDestroy(engine);
+  }
+
+  static void loadFontOn(EngineHandle engine, Uint8List data) {
+    if (!_initialized) initialize();
+    final ptr = calloc<Uint8>(data.length);
+    ptr.asTypedList(data.length).setAll(0, data);
+    _engineHLoadFont(engine, ptr, data.length);
+    calloc.free(ptr);
+  }
+
+  static void importPptxOn(EngineHandle engine, String filepath) {
+    if (!_initialized) initialize();
+    final ptr = filepath.toNativeUtf8();
+    _engineHImportPptx(engine, ptr);
+    calloc.free(ptr);
+  }
+
+  static bool openDocumentOn(EngineHandle engine, String filepath) {
+    if (!_initialized) initialize();
+    final ptr = filepath.toNativeUtf8();
+    final ok = _engineHOpenDocument(engine, ptr);
+    calloc.free(ptr);
+    return ok;
+  }
+
+  static void renderOn(
+    EngineHandle engine,
+    Pointer<Uint32> buffer,
+    int width,
+    int height,
+  ) {
+    if (!_initialized) initialize();
+    _engineHRender(engine, buffer, width, height);
+  }
+
+  static int getObjectCountOn(EngineHandle engine) {
+    if (!_initialized) initialize();
+    return _engineHGetObjectCount(engine);
+  }
+
   static int addRect(double x, double y, double w, double h, int color) {
     if (!_initialized) initialize();
     return _engineAddRect(x, y, w, h, color);
@@ -409,6 +1089,20 @@ class NativeApi {
     return id;
   }
 
+  static List<int>? executeBatch(Uint8List commands, int addCount) {
+    if (!_initialized) initialize();
+    final cmds = calloc<Uint8>(commands.length);
+    cmds.asTypedList(commands.length).setAll(0, commands);
+    final ids = calloc<Int32>(addCount > 0 ? addCount : 1);
+    final added = _engineExecuteBatch(cmds, commands.length, ids, addCount);
+    final result = added < 0
+        ? null
+        : List<int>.of(ids.asTypedList(addCount).take(added));
+    calloc.free(cmds);
+    calloc.free(ids);
+    return result;
+  }
+
   static void loadFont(Uint8List data) {
     if (!_initialized) initialize();
     final ptr = calloc<Uint8>(data.length);
@@ -425,6 +1119,124 @@ class NativeApi {
     calloc.free(ptr);
   }
 
+  static void setCacheDirectory(String? directory, {int maxBytes = 1 << 30}) {
+    if (!_initialized) initialize();
+    if (directory == null) {
+      _engineSetCacheDirectory(nullptr, 0);
+      return;
+    }
+    final ptr = directory.toNativeUtf8();
+    _engineSetCacheDirectory(ptr, maxBytes);
+    calloc.free(ptr);
+  }
+
+  // Caps imported pictures at `dpi` pixels per inch of their size on the
+  // slide; 0 keeps full resolution. PDF export still embeds the original
+  // JPEGs unless `keepOriginals` is false.
+  static void setImportImageDpi(double dpi, {bool keepOriginals = true}) {
+    if (!_initialized) initialize();
+    _engineSetImportImageDpi(dpi, keepOriginals);
+  }
+
+  // Imported pictures are decoded when first shown; beyond `maxBytes` of
+  // decoded pixels the least recently drawn are dropped
+  static void setImageCacheBudget(int maxBytes) {
+    if (!_initialized) initialize();
+    _engineSetImageCacheBudget(maxBytes);
+  }
+
+  static const int trimModerate = 0;
+  static const int trimComplete = 1;
+
+  // Frees decoded pictures (and, when complete, page previews) on memory
+  // pressure
+  static void trimMemory(int level) {
+    if (!_initialized) initialize();
+    _engineTrimMemory(level);
+  }
+
+  static bool saveDocument(String filepath) {
+    if (!_initialized) initialize();
+    final ptr = filepath.toNativeUtf8();
+    final ok = _engineSaveDocument(ptr);
+    calloc.free(ptr);
+    return ok;
+  }
+
+  static bool openDocument(String filepath) {
+    if (!_initialized) initialize();
+    final ptr = filepath.toNativeUtf8();
+    final ok = _engineOpenDocument(ptr);
+    calloc.free(ptr);
+    return ok;
+  }
+
+  static bool journalOpen(String filepath) {
+    if (!_initialized) initialize();
+    final ptr = filepath.toNativeUtf8();
+    final ok = _engineJournalOpen(ptr);
+    calloc.free(ptr);
+    return ok;
+  }
+
+  static bool journalFlush() {
+    if (!_initialized) initialize();
+    return _engineJournalFlush();
+  }
+
+  static bool journalCheckpoint() {
+    if (!_initialized) initialize();
+    return _engineJournalCheckpoint();
+  }
+
+  static void journalClose() {
+    if (!_initialized) initialize();
+    _engineJournalClose();
+  }
+
+  static bool journalRecover(String filepath) {
+    if (!_initialized) initialize();
+    final ptr = filepath.toNativeUtf8();
+    final ok = _engineJournalRecover(ptr);
+    calloc.free(ptr);
+    return ok;
+  }
+
+  static void beginTransaction() {
+    if (!_initialized) initialize();
+    _engineBeginTransaction();
+  }
+
+  static void commit() {
+    if (!_initialized) initialize();
+    _engineCommit();
+  }
+
+  static bool undo() {
+    if (!_initialized) initialize();
+    return _engineUndo();
+  }
+
+  static bool redo() {
+    if (!_initialized) initialize();
+    return _engineRedo();
+  }
+
+  static bool canUndo() {
+    if (!_initialized) initialize();
+    return _engineCanUndo();
+  }
+
+  static bool canRedo() {
+    if (!_initialized) initialize();
+    return _engineCanRedo();
+  }
+
+  static void setHistoryLimit(int maxBytes) {
+    if (!_initialized) initialize();
+    _engineSetHistoryLimit(maxBytes);
+  }
+
   static int pick(int x, int y) {
     if (!_initialized) initialize();
     return _enginePick(x, y);
@@ -465,6 +1277,28 @@ class NativeApi {
     _engineRemoveObject(id);
   }
 
+  static void reorderObject(int id, int index) {
+    if (!_initialized) initialize();
+    _engineReorderObject(id, index);
+  }
+
+  static List<SceneEvent> pollEvents() {
+    if (!_initialized) initialize();
+    const capacity = 256;
+    final buffer = calloc<EngineEvent>(capacity);
+    final events = <SceneEvent>[];
+    while (true) {
+      final count = _enginePollEvents(buffer, capacity);
+      for (var i = 0; i < count; i++) {
+        final e = buffer[i];
+        events.add(SceneEvent(e.type, e.uid, e.mask, e.index));
+      }
+      if (count < capacity) break;
+    }
+    calloc.free(buffer);
+    return events;
+  }
+
   static void selectObject(int id, {bool addToSelection = false}) {
     if (!_initialized) initialize();
     _engineSelectObject(id, addToSelection);
@@ -485,6 +1319,48 @@ class NativeApi {
     return _engineGetSelectedIdAt(index);
   }
 
+  static List<SceneObjectInfo> getSceneSnapshot() {
+    if (!_initialized) initialize();
+    final namesSize = calloc<Int32>();
+    var capacity = _engineGetObjectCount();
+    var namesCapacity = capacity * 16;
+    while (true) {
+      final objects = calloc<EngineObjectInfo>(capacity > 0 ? capacity : 1);
+      final names = calloc<Uint8>(namesCapacity > 0 ? namesCapacity : 1);
+      final count = _engineGetSceneSnapshot(
+        objects,
+        capacity,
+        names,
+        namesCapacity,
+        namesSize,
+      );
+      if (count <= capacity && namesSize.value <= namesCapacity) {
+        final result = List<SceneObjectInfo>.generate(count, (i) {
+          final info = objects[i];
+          return SceneObjectInfo(
+            uid: info.uid,
+            type: info.type,
+            x: info.x,
+            y: info.y,
+            w: info.w,
+            h: info.h,
+            color: info.color,
+            flags: info.flags,
+            name: (names + info.nameOffset).cast<Utf8>().toDartString(),
+          );
+        });
+        calloc.free(objects);
+        calloc.free(names);
+        calloc.free(namesSize);
+        return result;
+      }
+      capacity = count;
+      namesCapacity = namesSize.value;
+      calloc.free(objects);
+      calloc.free(names);
+    }
+  }
+
   static int getObjectUid(int index) {
     if (!_initialized) initialize();
     return _engineGetObjectUid(index);
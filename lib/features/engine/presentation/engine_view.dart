@@ -30,7 +30,7 @@ class EngineView extends StatefulWidget {
 }
 
 class _EngineViewState extends State<EngineView>
-    with SingleTickerProviderStateMixin {
+    with SingleTickerProviderStateMixin, WidgetsBindingObserver {
   ui.Image? _image;
   Pointer<Uint32>? _buffer;
   Ticker? _ticker;
@@ -53,9 +53,16 @@ class _EngineViewState extends State<EngineView>
     super.initState();
     _width = widget.width;
     _height = widget.height;
+    WidgetsBinding.instance.addObserver(this);
     _initEngine();
   }
 
+  @override
+  void didHaveMemoryPressure() {
+    // Pictures off screen are decoded again when shown
+    NativeApi.trimMemory(NativeApi.trimComplete);
+  }
+
   @override
   void didUpdateWidget(EngineView oldWidget) {
     super.didUpdateWidget(oldWidget);
@@ -83,6 +90,8 @@ class _EngineViewState extends State<EngineView>
   Future<void> _initEngine() async {
     try {
       NativeApi.initEngine(_width, _height);
+      // Twice the slide resolution leaves room to zoom in on pictures
+      NativeApi.setImportImageDpi(192);
       StudioController().refreshLayers();
 
       _buffer = calloc<Uint32>(_width * _height);
@@ -129,6 +138,7 @@ class _EngineViewState extends State<EngineView>
 
   @override
   void dispose() {
+    WidgetsBinding.instance.removeObserver(this);
     _ticker?.dispose();
     if (_buffer != null) {
       calloc.free(_buffer!);
@@ -1,15 +1,9 @@
-import 'dart:ffi';
-import 'dart:io';
-import 'dart:typed_data';
-import 'dart:ui' as ui;
+import 'dart:isolate';
 
-import 'package:ffi/ffi.dart';
 import 'package:file_picker/file_picker.dart';
 
 import 'package:karrolle/bridge/native_api.dart';
 import 'package:karrolle/core/logger/app_logger.dart';
-import 'package:pdf/pdf.dart';
-import 'package:pdf/widgets.dart' as pw;
 
 /// Export service for saving documents as various formats
 class ExportService {
@@ -34,41 +28,15 @@ class ExportService {
 
       if (result == null) return null;
 
-      // Render to buffer
-      final buffer = calloc<Uint32>(width * height);
-      NativeApi.render(buffer, width, height);
-
-      // Convert BGRA to RGBA
-      final pixels = buffer.asTypedList(width * height);
-      final rgbaPixels = Uint8List(width * height * 4);
-
-      for (int i = 0; i < pixels.length; i++) {
-        final bgra = pixels[i];
-        final b = (bgra >> 0) & 0xFF;
-        final g = (bgra >> 8) & 0xFF;
-        final r = (bgra >> 16) & 0xFF;
-        final a = (bgra >> 24) & 0xFF;
-
-        rgbaPixels[i * 4 + 0] = r;
-        rgbaPixels[i * 4 + 1] = g;
-        rgbaPixels[i * 4 + 2] = b;
-        rgbaPixels[i * 4 + 3] = a;
-      }
-
-      calloc.free(buffer);
-
-      // Encode as PNG using dart:ui
-      final image = await _createImage(rgbaPixels, width, height);
-      final byteData = await image.toByteData(format: ui.ImageByteFormat.png);
-
-      if (byteData == null) {
-        throw Exception('Failed to encode image as PNG');
+      // The engine renders, encodes and writes the file itself; on another
+      // isolate the UI keeps running meanwhile
+      final ok = await Isolate.run(
+        () => NativeApi.exportPng(result, width, height, 6),
+      );
+      if (!ok) {
+        throw Exception('Failed to export PNG');
       }
 
-      // Save to file
-      final file = File(result);
-      await file.writeAsBytes(byteData.buffer.asUint8List());
-
       AppLog.i('Exported PNG to: $result');
       return result;
     } catch (e) {
@@ -77,23 +45,6 @@ class ExportService {
     }
   }
 
-  /// Create ui.Image from RGBA pixels
-  Future<ui.Image> _createImage(Uint8List pixels, int width, int height) async {
-    final completer = ui.ImmutableBuffer.fromUint8List(pixels);
-    final buffer = await completer;
-
-    final descriptor = ui.ImageDescriptor.raw(
-      buffer,
-      width: width,
-      height: height,
-      pixelFormat: ui.PixelFormat.rgba8888,
-    );
-
-    final codec = await descriptor.instantiateCodec();
-    final frame = await codec.getNextFrame();
-    return frame.image;
-  }
-
   /// Export current canvas as PDF
   Future<String?> exportAsPdf({
     required int width,
@@ -112,60 +63,13 @@ class ExportService {
 
       if (result == null) return null;
 
-      // Render to buffer
-      final buffer = calloc<Uint32>(width * height);
-      NativeApi.render(buffer, width, height);
-
-      // Convert BGRA to RGBA
-      final pixels = buffer.asTypedList(width * height);
-      final rgbaPixels = Uint8List(width * height * 4);
-
-      for (int i = 0; i < pixels.length; i++) {
-        final bgra = pixels[i];
-        final b = (bgra >> 0) & 0xFF;
-        final g = (bgra >> 8) & 0xFF;
-        final r = (bgra >> 16) & 0xFF;
-        final a = (bgra >> 24) & 0xFF;
-
-        rgbaPixels[i * 4 + 0] = r;
-        rgbaPixels[i * 4 + 1] = g;
-        rgbaPixels[i * 4 + 2] = b;
-        rgbaPixels[i * 4 + 3] = a;
-      }
-
-      calloc.free(buffer);
-
-      // Get PNG bytes
-      final image = await _createImage(rgbaPixels, width, height);
-      final byteData = await image.toByteData(format: ui.ImageByteFormat.png);
-
-      if (byteData == null) {
-        throw Exception('Failed to encode image');
-      }
-
-      // Create PDF
-      final pdf = pw.Document();
-      final pdfImage = pw.MemoryImage(byteData.buffer.asUint8List());
-
-      // Calculate page size to match aspect ratio
-      final pageFormat = PdfPageFormat(
-        width.toDouble(),
-        height.toDouble(),
-        marginAll: 0,
+      // Shapes and text stay vectors; the engine writes the file itself
+      final ok = await Isolate.run(
+        () => NativeApi.exportPdf(result, width, height),
       );
-
-      pdf.addPage(
-        pw.Page(
-          pageFormat: pageFormat,
-          build: (context) {
-            return pw.Center(child: pw.Image(pdfImage, fit: pw.BoxFit.contain));
-          },
-        ),
-      );
-
-      // Save PDF
-      final file = File(result);
-      await file.writeAsBytes(await pdf.save());
+      if (!ok) {
+        throw Exception('Failed to export PDF');
+      }
 
       AppLog.i('Exported PDF to: $result');
       return result;
@@ -179,8 +83,6 @@ class ExportService {
   Future<String?> exportAllPagesAsPdf({
     required int width,
     required int height,
-    required int pageCount,
-    required Future<void> Function(int) goToPage,
     String? suggestedName,
   }) async {
     try {
@@ -193,55 +95,15 @@ class ExportService {
 
       if (result == null) return null;
 
-      final pdf = pw.Document();
-      final pageFormat = PdfPageFormat(
-        width.toDouble(),
-        height.toDouble(),
-        marginAll: 0,
+      // The engine writes a page per document page, without switching the
+      // active one
+      final ok = await Isolate.run(
+        () => NativeApi.exportPdf(result, width, height),
       );
-
-      for (int i = 0; i < pageCount; i++) {
-        // Navigate to page
-        await goToPage(i);
-
-        // Small delay to ensure render is complete
-        await Future.delayed(const Duration(milliseconds: 100));
-
-        // Render page
-        final buffer = calloc<Uint32>(width * height);
-        NativeApi.render(buffer, width, height);
-
-        final pixels = buffer.asTypedList(width * height);
-        final rgbaPixels = Uint8List(width * height * 4);
-
-        for (int j = 0; j < pixels.length; j++) {
-          final bgra = pixels[j];
-          rgbaPixels[j * 4 + 0] = (bgra >> 16) & 0xFF;
-          rgbaPixels[j * 4 + 1] = (bgra >> 8) & 0xFF;
-          rgbaPixels[j * 4 + 2] = (bgra >> 0) & 0xFF;
-          rgbaPixels[j * 4 + 3] = (bgra >> 24) & 0xFF;
-        }
-
-        calloc.free(buffer);
-
-        final image = await _createImage(rgbaPixels, width, height);
-        final byteData = await image.toByteData(format: ui.ImageByteFormat.png);
-
-        if (byteData != null) {
-          final pdfImage = pw.MemoryImage(byteData.buffer.asUint8List());
-          pdf.addPage(
-            pw.Page(
-              pageFormat: pageFormat,
-              build: (context) =>
-                  pw.Center(child: pw.Image(pdfImage, fit: pw.BoxFit.contain)),
-            ),
-          );
-        }
+      if (!ok) {
+        throw Exception('Failed to export PDF');
       }
 
-      final file = File(result);
-      await file.writeAsBytes(await pdf.save());
-
       AppLog.i('Exported all pages to PDF: $result');
       return result;
     } catch (e) {
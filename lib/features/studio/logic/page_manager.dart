@@ -1,4 +1,6 @@
 import 'package:flutter/material.dart';
+import 'package:karrolle/bridge/native_api.dart';
+import 'package:karrolle/features/studio/logic/studio_controller.dart';
 
 /// Represents a single page/slide in the document
 class DocumentPage {
@@ -6,8 +8,8 @@ class DocumentPage {
   String name;
   final DateTime createdAt;
 
-  // Page-specific data would be stored in the native engine
-  // This is just metadata for the Flutter UI
+  // The page content lives in the native engine, at the same index;
+  // this is just metadata for the Flutter UI
 
   DocumentPage({required this.id, required this.name, DateTime? createdAt})
     : createdAt = createdAt ?? DateTime.now();
@@ -17,7 +19,10 @@ class DocumentPage {
   }
 }
 
-/// Manages multiple pages in a document
+/// Manages multiple pages in a document.
+///
+/// Mirrors the engine's page list: every change is made natively first, and
+/// switching pages only changes the engine's active page.
 class PageManager {
   static final PageManager _instance = PageManager._internal();
   factory PageManager() => _instance;
@@ -46,19 +51,29 @@ class PageManager {
   }
 
   void _notifyChanges() {
+    // The engine keeps its active page across inserts, removals and moves
+    _currentPageIndex = NativeApi.getActivePage();
     pagesNotifier.value = List.from(_pages);
     currentPageNotifier.value = _currentPageIndex;
+    // Picks up the reset event of a newly active page
+    StudioController().processEngineEvents();
+  }
+
+  /// Rebuilds the page list from the engine after an import or open
+  void syncWithEngine() {
+    _pages.clear();
+    final count = NativeApi.getPageCount();
+    for (int i = 0; i < count; i++) {
+      _pages.add(
+        DocumentPage(id: '${_generateId()}-$i', name: 'Page ${i + 1}'),
+      );
+    }
+    _notifyChanges();
   }
 
   /// Add a new page
   DocumentPage addPage({String? name}) {
-    final newPage = DocumentPage(
-      id: _generateId(),
-      name: name ?? 'Page ${_pages.length + 1}',
-    );
-    _pages.add(newPage);
-    _notifyChanges();
-    return newPage;
+    return insertPage(_pages.length, name: name);
   }
 
   /// Insert a page at specific index
@@ -67,7 +82,8 @@ class PageManager {
       id: _generateId(),
       name: name ?? 'Page ${_pages.length + 1}',
     );
-    _pages.insert(index.clamp(0, _pages.length), newPage);
+    final at = NativeApi.addPage(index.clamp(0, _pages.length));
+    _pages.insert(at, newPage);
     _notifyChanges();
     return newPage;
   }
@@ -76,14 +92,9 @@ class PageManager {
   bool removePage(int index) {
     if (_pages.length <= 1) return false; // Keep at least one page
     if (index < 0 || index >= _pages.length) return false;
+    if (!NativeApi.removePage(index)) return false;
 
     _pages.removeAt(index);
-
-    // Adjust current page index if needed
-    if (_currentPageIndex >= _pages.length) {
-      _currentPageIndex = _pages.length - 1;
-    }
-
     _notifyChanges();
     return true;
   }
@@ -92,11 +103,8 @@ class PageManager {
   bool goToPage(int index) {
     if (index < 0 || index >= _pages.length) return false;
     if (index == _currentPageIndex) return true;
+    if (!NativeApi.setActivePage(index)) return false;
 
-    // TODO: Save current page state to native engine
-    // TODO: Load new page state from native engine
-
-    _currentPageIndex = index;
     _notifyChanges();
     return true;
   }
@@ -118,9 +126,9 @@ class PageManager {
       name: '${original.name} (copy)',
     );
 
-    // TODO: Copy page content in native engine
-
-    _pages.insert(index + 1, duplicate);
+    final at = NativeApi.duplicatePage(index);
+    if (at < 0) return null;
+    _pages.insert(at, duplicate);
     _notifyChanges();
     return duplicate;
   }
@@ -130,19 +138,10 @@ class PageManager {
     if (oldIndex < 0 || oldIndex >= _pages.length) return;
     if (newIndex < 0 || newIndex >= _pages.length) return;
     if (oldIndex == newIndex) return;
+    if (!NativeApi.movePage(oldIndex, newIndex)) return;
 
     final page = _pages.removeAt(oldIndex);
     _pages.insert(newIndex, page);
-
-    // Update current page index
-    if (_currentPageIndex == oldIndex) {
-      _currentPageIndex = newIndex;
-    } else if (oldIndex < _currentPageIndex && newIndex >= _currentPageIndex) {
-      _currentPageIndex--;
-    } else if (oldIndex > _currentPageIndex && newIndex <= _currentPageIndex) {
-      _currentPageIndex++;
-    }
-
     _notifyChanges();
   }
 
@@ -164,9 +163,7 @@ class PageManager {
 
   /// Clear all pages and reset
   void reset() {
-    _pages.clear();
-    _pages.add(DocumentPage(id: _generateId(), name: 'Page 1'));
-    _currentPageIndex = 0;
-    _notifyChanges();
+    NativeApi.initEngine(0, 0);
+    syncWithEngine();
   }
 }
@@ -1,7 +1,7 @@
 import 'package:flutter/material.dart';
 import 'package:karrolle/bridge/native_api.dart';
 import 'package:karrolle/core/logger/app_logger.dart';
-import 'package:karrolle/features/studio/logic/history_manager.dart';
+import 'package:karrolle/features/studio/logic/page_manager.dart';
 import 'dart:ffi';
 import 'package:ffi/ffi.dart';
 import 'package:file_picker/file_picker.dart';
@@ -46,12 +46,6 @@ class SelectionState {
   });
 }
 
-class SimpleObjectState {
-  final int id;
-  final double x, y, w, h;
-  SimpleObjectState(this.id, this.x, this.y, this.w, this.h);
-}
-
 class StudioController {
   // Singleton
   static final StudioController _instance = StudioController._internal();
@@ -61,8 +55,12 @@ class StudioController {
   final ValueNotifier<SelectionState?> selectionNotifier = ValueNotifier(null);
   final ValueNotifier<List<LayerInfo>> layersNotifier = ValueNotifier([]);
 
-  // Transaction state for Undo/Redo
-  List<SimpleObjectState>? _groupTransactionStartStates;
+  // Undo/redo state of the active page's history in the engine
+  final ValueNotifier<bool> canUndoNotifier = ValueNotifier(false);
+  final ValueNotifier<bool> canRedoNotifier = ValueNotifier(false);
+
+  // Whether a drag's engine transaction is open
+  bool _inTransaction = false;
 
   LayerType _typeIdToLayerType(int typeId) {
     switch (typeId) {
@@ -143,17 +141,16 @@ class StudioController {
 
   void refreshLayers() {
     try {
-      final count = NativeApi.getObjectCount();
+      final snapshot = NativeApi.getSceneSnapshot();
       final List<LayerInfo> layers = [];
 
-      for (int i = 0; i < count; i++) {
-        final name = NativeApi.getObjectName(i);
-        final typeId = NativeApi.getObjectType(i);
-        final uid = NativeApi.getObjectUid(i);
-
-        LayerType type = _typeIdToLayerType(typeId);
+      for (int i = 0; i < snapshot.length; i++) {
+        final info = snapshot[i];
+        LayerType type = _typeIdToLayerType(info.type);
 
-        layers.add(LayerInfo(index: i, uid: uid, name: name, type: type));
+        layers.add(
+          LayerInfo(index: i, uid: info.uid, name: info.name, type: type),
+        );
       }
 
       layersNotifier.value = layers;
@@ -162,100 +159,35 @@ class StudioController {
     }
   }
 
-  // --- Transaction Management ---
+  // --- Undo/Redo ---
+  //
+  // The engine records every edit; a drag is grouped into one undo step by
+  // an engine transaction, so the edits it makes need no bookkeeping here.
 
   void startTransaction() {
-    final count = NativeApi.getSelectedCount();
-    _groupTransactionStartStates = [];
-
-    final pX = calloc<Float>();
-    final pY = calloc<Float>();
-    final pW = calloc<Float>();
-    final pH = calloc<Float>();
-
-    for (int i = 0; i < count; i++) {
-      final id = NativeApi.getSelectedIdAt(i);
-      NativeApi.getObjectBounds(id, pX, pY, pW, pH);
-      _groupTransactionStartStates!.add(
-        SimpleObjectState(id, pX.value, pY.value, pW.value, pH.value),
-      );
-    }
-
-    calloc.free(pX);
-    calloc.free(pY);
-    calloc.free(pW);
-    calloc.free(pH);
+    if (_inTransaction) return;
+    NativeApi.beginTransaction();
+    _inTransaction = true;
   }
 
   void commitTransaction() {
-    if (_groupTransactionStartStates == null ||
-        _groupTransactionStartStates!.isEmpty) {
-      return;
-    }
-
-    final pX = calloc<Float>();
-    final pY = calloc<Float>();
-    final pW = calloc<Float>();
-    final pH = calloc<Float>();
-
-    List<Command> moveCommands = [];
-
-    for (var start in _groupTransactionStartStates!) {
-      NativeApi.getObjectBounds(start.id, pX, pY, pW, pH);
-
-      if (start.x != pX.value || start.y != pY.value) {
-        // Moved
-        moveCommands.add(
-          MoveCommand(
-            objectId: start.id,
-            oldX: start.x,
-            oldY: start.y,
-            newX: pX.value,
-            newY: pY.value,
-            w: pW.value,
-            h: pH.value,
-            setRectFn: (id, x, y, w, h) {
-              NativeApi.setObjectRect(id, x, y, w, h);
-              refreshSelection();
-            },
-          ),
-        );
-      } else if (start.w != pW.value || start.h != pH.value) {
-        // Resized
-        moveCommands.add(
-          ResizeCommand(
-            objectId: start.id,
-            oldX: start.x,
-            oldY: start.y,
-            oldW: start.w,
-            oldH: start.h,
-            newX: pX.value,
-            newY: pY.value,
-            newW: pW.value,
-            newH: pH.value,
-            setRectFn: (id, x, y, w, h) {
-              NativeApi.setObjectRect(id, x, y, w, h);
-              refreshSelection();
-            },
-          ),
-        );
-      }
-    }
+    if (!_inTransaction) return;
+    NativeApi.commit();
+    _inTransaction = false;
+    refreshHistory();
+  }
 
-    calloc.free(pX);
-    calloc.free(pY);
-    calloc.free(pW);
-    calloc.free(pH);
+  void undo() {
+    if (NativeApi.undo()) processEngineEvents();
+  }
 
-    if (moveCommands.isNotEmpty) {
-      if (moveCommands.length == 1) {
-        HistoryManager().executor(moveCommands.first);
-      } else {
-        HistoryManager().executor(CompositeCommand(moveCommands));
-      }
-    }
+  void redo() {
+    if (NativeApi.redo()) processEngineEvents();
+  }
 
-    _groupTransactionStartStates = null;
+  void refreshHistory() {
+    canUndoNotifier.value = NativeApi.canUndo();
+    canRedoNotifier.value = NativeApi.canRedo();
   }
 
   // --- Actions ---
@@ -265,21 +197,8 @@ class StudioController {
     final state = selectionNotifier.value!;
     final id = state.id;
 
-    HistoryManager().executor(
-      MoveCommand(
-        objectId: id,
-        oldX: state.x,
-        oldY: state.y,
-        newX: x,
-        newY: y,
-        w: w,
-        h: h,
-        setRectFn: (id, nx, ny, nw, nh) {
-          NativeApi.setObjectRect(id, nx, ny, nw, nh);
-          refreshSelection();
-        },
-      ),
-    );
+    NativeApi.setObjectRect(id, x, y, w, h);
+    refreshHistory();
 
     // Optimistic update
     selectionNotifier.value = SelectionState(
@@ -299,26 +218,9 @@ class StudioController {
     if (selectionNotifier.value == null) return;
     final state = selectionNotifier.value!;
     final id = state.id;
-    final oldColor = state.color;
 
     NativeApi.setObjectColor(id, color);
-
-    // Create history command immediately as this is usually atomic (from picker)
-    HistoryManager().executor(
-      ColorCommand(
-        objectId: id,
-        oldColor: oldColor,
-        newColor: color,
-        setColorFn: (id, c) {
-          NativeApi.setObjectColor(id, c);
-          // Refresh selection directly to update UI
-          final s = _getObjectState(id);
-          if (s != null && selectionNotifier.value?.id == id) {
-            selectionNotifier.value = s;
-          }
-        },
-      ),
-    );
+    refreshHistory();
 
     // Optimistic update
     selectionNotifier.value = SelectionState(
@@ -341,6 +243,7 @@ class StudioController {
 
     NativeApi.setObjectText(id, text);
     refreshSelection();
+    refreshHistory();
   }
 
   void updateSelectionFontSize(double size) {
@@ -350,18 +253,56 @@ class StudioController {
 
     NativeApi.setObjectFontSize(id, size);
     refreshSelection();
+    refreshHistory();
   }
 
   void removeObject(int uid) {
     try {
       NativeApi.removeObject(uid);
-      refreshLayers();
-      refreshSelection();
+      processEngineEvents();
     } catch (e) {
       AppLog.e("Failed to remove object", e);
     }
   }
 
+  /// Moves a layer to [index] in the draw order (0 is the back)
+  void reorderLayer(int uid, int index) {
+    try {
+      NativeApi.reorderObject(uid, index);
+      processEngineEvents();
+    } catch (e) {
+      AppLog.e("Failed to reorder layer", e);
+    }
+  }
+
+  /// Refreshes only the panels affected by engine changes since last call
+  void processEngineEvents() {
+    bool layers = false;
+    bool selection = false;
+    final selectedId = selectionNotifier.value?.id;
+
+    for (final event in NativeApi.pollEvents()) {
+      switch (event.type) {
+        case engineEventObjectAdded:
+        case engineEventObjectRemoved:
+        case engineEventZOrderChanged:
+          layers = true;
+        case engineEventObjectModified:
+          if (event.uid == selectedId) selection = true;
+        case engineEventSelectionChanged:
+          selection = true;
+        case engineEventReset:
+          layers = true;
+          selection = true;
+      }
+    }
+
+    if (layers) refreshLayers();
+    if (selection) refreshSelection();
+    // Edits, page switches and resets all change what can be undone
+    refreshHistory();
+  }
+
   void clearSelection() {
     NativeApi.clearSelection();
     selectionNotifier.value = null;
@@ -376,30 +317,30 @@ class StudioController {
     }
   }
 
-  // --- Add Objects (with Undo) ---
+  // --- Add Objects ---
 
   void addRectangle() {
     final id = NativeApi.addRect(100.0, 100.0, 200.0, 150.0, 0xFF4F46E5);
-    _registerAddCommand(id, "Rectangle");
     refreshLayers();
     NativeApi.selectObject(id);
     refreshSelection();
+    refreshHistory();
   }
 
   void addEllipse() {
     final id = NativeApi.addEllipse(100.0, 100.0, 150.0, 150.0, 0xFFEF4444);
-    _registerAddCommand(id, "Ellipse");
     refreshLayers();
     NativeApi.selectObject(id);
     refreshSelection();
+    refreshHistory();
   }
 
   void addLine() {
     final id = NativeApi.addLine(100, 100, 300, 300, 0xFF000000, thickness: 3);
-    _registerAddCommand(id, "Line");
     refreshLayers();
     NativeApi.selectObject(id);
     refreshSelection();
+    refreshHistory();
   }
 
   void addText() {
@@ -410,10 +351,10 @@ class StudioController {
       0xFF000000,
       24.0,
     );
-    _registerAddCommand(id, "Text");
     refreshLayers();
     NativeApi.selectObject(id);
     refreshSelection();
+    refreshHistory();
   }
 
   void importPptx() async {
@@ -425,37 +366,11 @@ class StudioController {
 
       if (result != null && result.files.single.path != null) {
         NativeApi.importPptx(result.files.single.path!);
-        refreshLayers();
-        refreshSelection();
+        // A page per slide; syncing also reloads the layers of the first
+        PageManager().syncWithEngine();
       }
     } catch (e) {
       AppLog.e("Failed to import PPTX", e);
     }
   }
-
-  void _registerAddCommand(int id, String type) {
-    HistoryManager().executor(
-      AddObjectCommand(
-        objectId: id,
-        addFn: () {
-          // Re-adding is complex because ID might change or we need to restore properties
-          // For simple Undo of Add -> Delete. Redo of Add -> we need to restore.
-          // Simplified: We don't support full redo of Add yet without proper serialization
-          // But Undo (Delete) works.
-        },
-        removeFn: (uid) {
-          NativeApi.removeObject(uid);
-          refreshLayers();
-          refreshSelection();
-        },
-        objectType: type,
-      ),
-    );
-  }
-}
-
-extension HistoryManagerExecutor on HistoryManager {
-  void executor(Command cmd) {
-    executeCommand(cmd);
-  }
 }
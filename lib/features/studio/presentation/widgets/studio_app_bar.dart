@@ -1,5 +1,6 @@
 import 'package:file_picker/file_picker.dart';
 import 'package:karrolle/bridge/native_api.dart';
+import 'package:karrolle/features/studio/logic/page_manager.dart';
 import 'package:flutter/material.dart';
 
 class StudioAppBar extends StatelessWidget {
@@ -13,6 +14,7 @@ class StudioAppBar extends StatelessWidget {
 
     if (result != null && result.files.single.path != null) {
       NativeApi.importPptx(result.files.single.path!);
+      PageManager().syncWithEngine();
     }
   }
 
@@ -1,5 +1,9 @@
+import 'dart:async';
+import 'dart:ffi';
 import 'dart:io';
+import 'dart:typed_data';
 import 'dart:ui' as ui;
+import 'package:ffi/ffi.dart';
 import 'package:file_picker/file_picker.dart';
 import 'package:flutter/material.dart';
 import 'package:karrolle/bridge/native_api.dart';
@@ -162,7 +166,13 @@ class _StudioLeftSidebarState extends State<StudioLeftSidebar>
               padding: const EdgeInsets.all(8),
               itemCount: layers.length,
               onReorder: (oldIndex, newIndex) {
-                // TODO: Implement layer reordering in engine
+                if (newIndex > oldIndex) newIndex -= 1;
+                // The list shows the top layer first
+                final layer = layers[layers.length - 1 - oldIndex];
+                StudioController().reorderLayer(
+                  layer.uid,
+                  layers.length - 1 - newIndex,
+                );
               },
               proxyDecorator: (child, index, animation) {
                 return Material(color: Colors.transparent, child: child);
@@ -515,11 +525,13 @@ class _StudioLeftSidebarState extends State<StudioLeftSidebar>
             Container(
               width: 48,
               height: 27,
+              clipBehavior: Clip.antiAlias,
               decoration: BoxDecoration(
                 color: Colors.white,
                 borderRadius: BorderRadius.circular(4),
                 border: Border.all(color: Colors.white24),
               ),
+              child: _PagePreview(index: index, isActive: isSelected),
             ),
             const SizedBox(width: 12),
 
@@ -602,3 +614,93 @@ class _StudioLeftSidebarState extends State<StudioLeftSidebar>
     );
   }
 }
+
+/// Engine-rendered preview of one page. The engine keeps thumbnails until
+/// their page changes, so asking again is cheap; the active page, the one
+/// being edited, asks periodically.
+class _PagePreview extends StatefulWidget {
+  final int index;
+  final bool isActive;
+
+  const _PagePreview({required this.index, required this.isActive});
+
+  @override
+  State<_PagePreview> createState() => _PagePreviewState();
+}
+
+class _PagePreviewState extends State<_PagePreview> {
+  // Twice the preview's logical size, for high-density screens
+  static const int _width = 96;
+  static const int _height = 54;
+
+  final Pointer<Uint32> _buffer = calloc<Uint32>(_width * _height);
+  Uint32List? _pixels;
+  ui.Image? _image;
+  Timer? _timer;
+
+  @override
+  void initState() {
+    super.initState();
+    _refresh();
+    _updateTimer();
+  }
+
+  @override
+  void didUpdateWidget(_PagePreview oldWidget) {
+    super.didUpdateWidget(oldWidget);
+    // Pages shift when one is added, removed or moved
+    _pixels = null;
+    _refresh();
+    _updateTimer();
+  }
+
+  void _updateTimer() {
+    _timer?.cancel();
+    _timer = widget.isActive
+        ? Timer.periodic(const Duration(milliseconds: 500), (_) => _refresh())
+        : null;
+  }
+
+  void _refresh() {
+    NativeApi.renderThumbnail(widget.index, _buffer, _width, _height);
+    final pixels = _buffer.asTypedList(_width * _height);
+    final previous = _pixels;
+    if (previous != null && _samePixels(previous, pixels)) return;
+    _pixels = Uint32List.fromList(pixels);
+
+    ui.decodeImageFromPixels(
+      _buffer.cast<Uint8>().asTypedList(_width * _height * 4),
+      _width,
+      _height,
+      ui.PixelFormat.bgra8888,
+      (image) {
+        if (mounted) {
+          setState(() => _image = image);
+        } else {
+          image.dispose();
+        }
+      },
+    );
+  }
+
+  static bool _samePixels(Uint32List a, Uint32List b) {
+    for (int i = 0; i < a.length; i++) {
+      if (a[i] != b[i]) return false;
+    }
+    return true;
+  }
+
+  @override
+  void dispose() {
+    _timer?.cancel();
+    calloc.free(_buffer);
+    super.dispose();
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    final image = _image;
+    if (image == null) return const SizedBox.expand();
+    return RawImage(image: image, fit: BoxFit.fill);
+  }
+}
@@ -1,5 +1,4 @@
 import 'package:flutter/material.dart';
-import 'package:karrolle/features/studio/logic/history_manager.dart';
 import 'package:karrolle/features/studio/logic/export_service.dart';
 import 'package:karrolle/features/studio/logic/studio_controller.dart';
 
@@ -60,8 +59,8 @@ class StudioTopBar extends StatelessWidget {
             ),
           ]),
           _buildMenuButton(context, 'Edit', [
-            _MenuItem('Undo', Icons.undo, () => HistoryManager().undo()),
-            _MenuItem('Redo', Icons.redo, () => HistoryManager().redo()),
+            _MenuItem('Undo', Icons.undo, () => StudioController().undo()),
+            _MenuItem('Redo', Icons.redo, () => StudioController().redo()),
           ]),
           _buildMenuButton(context, 'View', [
             _MenuItem(
@@ -106,23 +105,23 @@ class StudioTopBar extends StatelessWidget {
 
           // Undo/Redo with state awareness
           ValueListenableBuilder<bool>(
-            valueListenable: HistoryManager().canUndoNotifier,
+            valueListenable: StudioController().canUndoNotifier,
             builder: (context, canUndo, _) {
               return _buildActionButton(
                 icon: Icons.undo,
-                tooltip: HistoryManager().undoDescription ?? 'Undo (Ctrl+Z)',
-                onTap: canUndo ? () => HistoryManager().undo() : null,
+                tooltip: 'Undo (Ctrl+Z)',
+                onTap: canUndo ? () => StudioController().undo() : null,
                 enabled: canUndo,
               );
             },
           ),
           ValueListenableBuilder<bool>(
-            valueListenable: HistoryManager().canRedoNotifier,
+            valueListenable: StudioController().canRedoNotifier,
             builder: (context, canRedo, _) {
               return _buildActionButton(
                 icon: Icons.redo,
-                tooltip: HistoryManager().redoDescription ?? 'Redo (Ctrl+Y)',
-                onTap: canRedo ? () => HistoryManager().redo() : null,
+                tooltip: 'Redo (Ctrl+Y)',
+                onTap: canRedo ? () => StudioController().redo() : null,
                 enabled: canRedo,
               );
             },
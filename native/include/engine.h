@@ -1,6 +1,7 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef _WIN32
@@ -28,11 +29,80 @@ EXPORT int32_t engine_add_line(float x1, float y1, float x2, float y2, uint32_t
 EXPORT int32_t engine_add_text(float x, float y, const char* text, uint32_t color, float size);
 EXPORT int32_t engine_add_image(float x, float y, float w, float h, const uint32_t* pixels, int32_t imgW, int32_t imgH);
 
+// Applies a command stream (opcodes and layout in src/io/command_batch.hpp)
+// as one undo step. Returns the number of objects added and writes up to
+// `idCapacity` of their ids to `ids`; -1 if the stream is malformed, in
+// which case nothing is applied.
+EXPORT int32_t engine_execute_batch(const uint8_t* cmds, size_t len, int32_t* ids, int32_t idCapacity);
+
 // Font Management
 EXPORT void engine_load_font(const uint8_t* data, int32_t length);
 
 EXPORT void engine_import_pptx(const char* filepath);
 
+// Parsed-deck cache: imports are kept in `directory` as native documents,
+// keyed by PPTX path, size and modification time, and evicted least
+// recently used first beyond `maxBytes`. Pass NULL to disable.
+EXPORT void engine_set_cache_directory(const char* directory, int64_t maxBytes);
+
+// Caps imported pictures at `dpi` pixels per inch of the largest size they
+// are shown at on a slide, so a camera photo in a small frame does not keep
+// its full resolution in memory; 0 (the default) keeps every picture as is.
+// Capped pictures are decoded at the reduced size, and PDF export still
+// embeds JPEG files at full resolution. Without `keepOriginals`, capped
+// pictures are decoded during import and their files dropped. Applies to
+// later imports.
+EXPORT void engine_set_import_image_dpi(float dpi, bool keepOriginals);
+
+// Native documents (pixels are stored decoded and mapped in place on open)
+EXPORT bool engine_save_document(const char* filepath);
+EXPORT bool engine_open_document(const char* filepath);
+
+// Edit journal: a checkpoint document at `filepath` plus an append-only log
+// of later edits in `filepath`.journal. flush() writes the buffered edits
+// (cheap enough for a once-a-second autosave) and compacts the log into a
+// new checkpoint once it outgrows the old one.
+EXPORT bool engine_journal_open(const char* filepath);
+EXPORT bool engine_journal_flush();
+EXPORT bool engine_journal_checkpoint();
+EXPORT void engine_journal_close();
+EXPORT bool engine_journal_recover(const char* filepath);
+
+// Change events, drained by engine_poll_events(). Repeated changes to an
+// object merge into one pending MODIFIED event; on RESET re-read everything.
+typedef struct EngineEvent {
+    uint32_t type;    // ENGINE_EVENT_*
+    int32_t uid;      // object, -1 for selection and reset events
+    uint32_t mask;    // ENGINE_FIELD_* for MODIFIED
+    int32_t index;    // draw order position (ADDED, REMOVED, Z_ORDER), else -1
+} EngineEvent;
+
+#define ENGINE_EVENT_OBJECT_ADDED 1u
+#define ENGINE_EVENT_OBJECT_REMOVED 2u
+#define ENGINE_EVENT_OBJECT_MODIFIED 3u
+#define ENGINE_EVENT_SELECTION_CHANGED 4u
+#define ENGINE_EVENT_Z_ORDER_CHANGED 5u
+#define ENGINE_EVENT_RESET 6u
+
+#define ENGINE_FIELD_GEOMETRY 1u
+#define ENGINE_FIELD_COLOR 2u
+#define ENGINE_FIELD_TEXT 4u
+#define ENGINE_FIELD_FONT_SIZE 8u
+
+// Returns the number of events written (at most `capacity`)
+EXPORT int32_t engine_poll_events(EngineEvent* buffer, int32_t capacity);
+
+// Undo/redo. Edits between begin_transaction() and commit() undo as one
+// step (transactions nest); edits outside a transaction are a step each.
+// The oldest steps are dropped once history holds more than `maxBytes`.
+EXPORT void engine_begin_transaction();
+EXPORT void engine_commit();
+EXPORT bool engine_undo();
+EXPORT bool engine_redo();
+EXPORT bool engine_can_undo();
+EXPORT bool engine_can_redo();
+EXPORT void engine_set_history_limit(int64_t maxBytes);
+
 // Interaction
 EXPORT int32_t engine_pick(int32_t x, int32_t y);
 EXPORT int32_t engine_pick_handle(int32_t x, int32_t y);
@@ -46,20 +116,199 @@ EXPORT int32_t engine_get_selected_id();
 EXPORT void engine_get_object_bounds(int32_t id, float* x, float* y, float* w, float* h);
 EXPORT uint32_t engine_get_object_color(int32_t id);
 EXPORT int32_t engine_get_object_count();
+// The name is copied into a buffer of the engine's, valid until the next
+// engine_get_object_name() call; copy it to keep it
 EXPORT const char* engine_get_object_name(int32_t index);
 EXPORT int32_t engine_get_object_type(int32_t index);
 EXPORT void engine_remove_object(int32_t id);
+// Moves the object to `index` in the draw order (0 is the back)
+EXPORT void engine_reorder_object(int32_t id, int32_t index);
 EXPORT int32_t engine_get_object_uid(int32_t index);
 EXPORT void engine_select_object(int32_t id, bool addToSelection);
 EXPORT void engine_clear_selection();
 EXPORT int32_t engine_get_selected_count();
 EXPORT int32_t engine_get_selected_id_at(int32_t index);
 
+// Bulk query for panels: one record per object in draw order
+typedef struct EngineObjectInfo {
+    int32_t uid;
+    int32_t type;          // 0 rect, 1 text, 2 image, 3 ellipse, 4 line
+    float x, y, w, h;
+    uint32_t color;
+    uint32_t flags;        // ENGINE_OBJECT_*
+    uint32_t nameOffset;   // into the names table, NUL-terminated
+    uint32_t reserved;
+} EngineObjectInfo;
+
+#define ENGINE_OBJECT_SELECTED 1u
+#define ENGINE_OBJECT_PRIMARY 2u   // engine_get_selected_id()
+
+// Fills up to `capacity` records and up to `namesCapacity` bytes of names,
+// stores the bytes the names need in `namesSize`, and returns the object
+// count. Call again with larger buffers if either did not fit.
+EXPORT int32_t engine_get_scene_snapshot(EngineObjectInfo* objects, int32_t capacity,
+                                         char* names, int32_t namesCapacity, int32_t* namesSize);
+
+// Like engine_get_object_name(): valid until the next call
 EXPORT const char* engine_get_object_text(int32_t id);
 EXPORT void engine_set_object_text(int32_t id, const char* text);
 EXPORT float engine_get_object_font_size(int32_t id);
 EXPORT void engine_set_object_font_size(int32_t id, float size);
 
+// Immutable view of the document for rendering off the calling thread.
+// Taking one is cheap: it shares the objects with the document, which copies
+// an object before its next edit. engine_render_snapshot takes no lock, so a
+// worker can render a snapshot while edits continue; a snapshot may be
+// rendered from several threads at once. The version grows with every
+// change to the content, so equal versions mean identical pixels.
+typedef struct EngineSnapshot EngineSnapshot;
+
+EXPORT EngineSnapshot* engine_snapshot(void);
+EXPORT uint64_t engine_snapshot_version(const EngineSnapshot* snapshot);
+EXPORT void engine_render_snapshot(const EngineSnapshot* snapshot, uint32_t* buffer, int32_t width, int32_t height);
+// Renders rows [top, top + rows) of the width x height canvas into a
+// buffer of width * rows pixels, identical to those rows of a full render.
+// Lets a host stream a canvas too large for memory to its own encoder.
+EXPORT void engine_render_snapshot_rows(const EngineSnapshot* snapshot, uint32_t* buffer, int32_t width, int32_t height,
+                                        int32_t top, int32_t rows);
+EXPORT void engine_release_snapshot(EngineSnapshot* snapshot);
+
+// Renders the document at width x height and writes it as a PNG. `level`
+// is the zlib level (0 fastest, 9 smallest). The document is only locked
+// while a snapshot is taken, so this can run on a worker while editing
+// continues; rendering and encoding use every core. The canvas is drawn and
+// encoded in strips, so memory stays around 16 MB plus the encoder's
+// buffers even for poster sizes.
+EXPORT bool engine_export_png(const char* path, int32_t width, int32_t height, int32_t level);
+
+// Writes the document as a vector PDF, one width x height canvas pixel page
+// (96 per inch) per page of the document. Shapes stay paths, text is embedded with a subset of its
+// font, and pictures imported from JPEG keep their original data. Like
+// engine_export_png, the document is only locked while a snapshot is taken.
+EXPORT bool engine_export_pdf(const char* path, int32_t width, int32_t height);
+
+// Pictures are resampled from a mip pyramid built on first use, bilinearly
+// by default. Without smoothing they are sampled nearest-neighbor, which is
+// faster and keeps pixel art sharp. Applies to every page.
+EXPORT void engine_set_image_smoothing(bool enabled);
+
+// Imported pictures stay compressed and are decoded by the first draw that
+// shows them, into a cache of decoded pictures shared by every instance.
+// Beyond `maxBytes` (256 MB by default) the least recently drawn pictures
+// are dropped, to be decoded again when next shown.
+EXPORT void engine_set_image_cache_budget(int64_t maxBytes);
+
+// Releases memory on request of the host, e.g. on a low-memory warning.
+// ENGINE_TRIM_MODERATE evicts decoded pictures down to half the budget;
+// ENGINE_TRIM_COMPLETE evicts them all and drops the page previews.
+#define ENGINE_TRIM_MODERATE 0
+#define ENGINE_TRIM_COMPLETE 1
+EXPORT void engine_trim_memory(int32_t level);
+
+// Pages. A document holds one or more pages, each with its own objects,
+// undo history and change log; an imported deck has a page per slide. Every
+// other call acts on the active page only, so rendering and picking cost
+// does not grow with the page count. Switching pages is cheap: the newly
+// active page queues an ENGINE_EVENT_RESET so the host reloads its objects.
+// Page indices are 0-based; the last page cannot be removed.
+EXPORT int32_t engine_get_page_count(void);
+EXPORT int32_t engine_get_active_page(void);
+EXPORT bool engine_set_active_page(int32_t index);
+// Inserts an empty page at `index` (-1 or past the end appends); returns its index
+EXPORT int32_t engine_add_page(int32_t index);
+// Inserts a copy of the page after it; returns the copy's index, or -1
+EXPORT int32_t engine_duplicate_page(int32_t index);
+EXPORT bool engine_remove_page(int32_t index);
+// Moves a page to `to`; the active page stays active wherever it ends up
+EXPORT bool engine_move_page(int32_t from, int32_t to);
+// Renders any page without its selection, e.g. for slide previews
+EXPORT void engine_render_page(int32_t index, uint32_t* buffer, int32_t width, int32_t height);
+// Preview of a page for a sidebar: the page area (the slide size, or the
+// size given to engine_init) scaled to fit width x height, anchored top
+// left. Rendered at that size, with unreadably small text drawn as bars and
+// pictures from reduced copies, and kept until the page changes, so asking
+// again for an unchanged page is a copy. The engine is only locked while
+// a snapshot is taken.
+EXPORT void engine_render_thumbnail(int32_t index, uint32_t* buffer, int32_t width, int32_t height);
+
+// Independent instances. Each handle owns its own document, history, event
+// queue, font, deck cache and journal, and serializes its own calls, so
+// separate instances can be used from separate threads at the same time.
+// engine_h_<name>(engine, ...) is engine_<name>(...) on `engine`; the calls
+// without a handle act on a default instance. Returned strings stay valid
+// until the next call on the same instance.
+typedef struct EngineInstance EngineInstance;
+
+EXPORT EngineInstance* engine_create(void);
+EXPORT void engine_destroy(EngineInstance* engine);
+
+EXPORT void engine_h_init(EngineInstance* engine, int32_t width, int32_t height);
+EXPORT void engine_h_import_pptx(EngineInstance* engine, const char* filepath);
+EXPORT void engine_h_set_cache_directory(EngineInstance* engine, const char* directory, int64_t maxBytes);
+EXPORT void engine_h_set_import_image_dpi(EngineInstance* engine, float dpi, bool keepOriginals);
+EXPORT bool engine_h_save_document(EngineInstance* engine, const char* filepath);
+EXPORT bool engine_h_open_document(EngineInstance* engine, const char* filepath);
+EXPORT bool engine_h_journal_open(EngineInstance* engine, const char* filepath);
+EXPORT bool engine_h_journal_flush(EngineInstance* engine);
+EXPORT bool engine_h_journal_checkpoint(EngineInstance* engine);
+EXPORT void engine_h_journal_close(EngineInstance* engine);
+EXPORT bool engine_h_journal_recover(EngineInstance* engine, const char* filepath);
+EXPORT int32_t engine_h_poll_events(EngineInstance* engine, EngineEvent* buffer, int32_t capacity);
+EXPORT void engine_h_begin_transaction(EngineInstance* engine);
+EXPORT void engine_h_commit(EngineInstance* engine);
+EXPORT bool engine_h_undo(EngineInstance* engine);
+EXPORT bool engine_h_redo(EngineInstance* engine);
+EXPORT bool engine_h_can_undo(EngineInstance* engine);
+EXPORT bool engine_h_can_redo(EngineInstance* engine);
+EXPORT void engine_h_set_history_limit(EngineInstance* engine, int64_t maxBytes);
+EXPORT void engine_h_render(EngineInstance* engine, uint32_t* buffer, int32_t width, int32_t height);
+EXPORT EngineSnapshot* engine_h_snapshot(EngineInstance* engine);
+EXPORT bool engine_h_export_png(EngineInstance* engine, const char* path, int32_t width, int32_t height, int32_t level);
+EXPORT bool engine_h_export_pdf(EngineInstance* engine, const char* path, int32_t width, int32_t height);
+EXPORT void engine_h_set_image_smoothing(EngineInstance* engine, bool enabled);
+EXPORT void engine_h_trim_memory(EngineInstance* engine, int32_t level);
+EXPORT int32_t engine_h_get_page_count(EngineInstance* engine);
+EXPORT int32_t engine_h_get_active_page(EngineInstance* engine);
+EXPORT bool engine_h_set_active_page(EngineInstance* engine, int32_t index);
+EXPORT int32_t engine_h_add_page(EngineInstance* engine, int32_t index);
+EXPORT int32_t engine_h_duplicate_page(EngineInstance* engine, int32_t index);
+EXPORT bool engine_h_remove_page(EngineInstance* engine, int32_t index);
+EXPORT bool engine_h_move_page(EngineInstance* engine, int32_t from, int32_t to);
+EXPORT void engine_h_render_page(EngineInstance* engine, int32_t index, uint32_t* buffer, int32_t width, int32_t height);
+EXPORT void engine_h_render_thumbnail(EngineInstance* engine, int32_t index, uint32_t* buffer, int32_t width, int32_t height);
+EXPORT int32_t engine_h_add_rect(EngineInstance* engine, float x, float y, float w, float h, uint32_t color);
+EXPORT int32_t engine_h_add_ellipse(EngineInstance* engine, float x, float y, float w, float h, uint32_t color);
+EXPORT int32_t engine_h_add_line(EngineInstance* engine, float x1, float y1, float x2, float y2, uint32_t color, float thickness);
+EXPORT void engine_h_load_font(EngineInstance* engine, const uint8_t* data, int32_t length);
+EXPORT int32_t engine_h_add_text(EngineInstance* engine, float x, float y, const char* text, uint32_t color, float size);
+EXPORT int32_t engine_h_add_image(EngineInstance* engine, float x, float y, float w, float h, const uint32_t* pixels, int32_t imgW, int32_t imgH);
+EXPORT int32_t engine_h_execute_batch(EngineInstance* engine, const uint8_t* cmds, size_t len, int32_t* ids, int32_t idCapacity);
+EXPORT int32_t engine_h_pick(EngineInstance* engine, int32_t x, int32_t y);
+EXPORT int32_t engine_h_pick_handle(EngineInstance* engine, int32_t x, int32_t y);
+EXPORT void engine_h_move_object(EngineInstance* engine, int32_t id, float dx, float dy);
+EXPORT void engine_h_move_selection(EngineInstance* engine, float dx, float dy);
+EXPORT int32_t engine_h_get_selected_id(EngineInstance* engine);
+EXPORT void engine_h_remove_object(EngineInstance* engine, int32_t id);
+EXPORT void engine_h_reorder_object(EngineInstance* engine, int32_t id, int32_t index);
+EXPORT void engine_h_select_object(EngineInstance* engine, int32_t id, bool addToSelection);
+EXPORT void engine_h_clear_selection(EngineInstance* engine);
+EXPORT int32_t engine_h_get_selected_count(EngineInstance* engine);
+EXPORT int32_t engine_h_get_selected_id_at(EngineInstance* engine, int32_t index);
+EXPORT int32_t engine_h_get_scene_snapshot(EngineInstance* engine, EngineObjectInfo* objects, int32_t capacity,
+                                           char* names, int32_t namesCapacity, int32_t* namesSize);
+EXPORT void engine_h_get_object_bounds(EngineInstance* engine, int32_t id, float* x, float* y, float* w, float* h);
+EXPORT void engine_h_set_object_rect(EngineInstance* engine, int32_t id, float x, float y, float w, float h);
+EXPORT void engine_h_set_object_color(EngineInstance* engine, int32_t id, uint32_t color);
+EXPORT uint32_t engine_h_get_object_color(EngineInstance* engine, int32_t id);
+EXPORT int32_t engine_h_get_object_count(EngineInstance* engine);
+EXPORT const char* engine_h_get_object_name(EngineInstance* engine, int32_t index);
+EXPORT int32_t engine_h_get_object_type(EngineInstance* engine, int32_t index);
+EXPORT int32_t engine_h_get_object_uid(EngineInstance* engine, int32_t index);
+EXPORT const char* engine_h_get_object_text(EngineInstance* engine, int32_t id);
+EXPORT void engine_h_set_object_text(EngineInstance* engine, int32_t id, const char* text);
+EXPORT float engine_h_get_object_font_size(EngineInstance* engine, int32_t id);
+EXPORT void engine_h_set_object_font_size(EngineInstance* engine, int32_t id, float size);
+
 #ifdef __cplusplus
 }
 #endif
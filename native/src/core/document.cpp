@@ -0,0 +1,135 @@
+#include "document.hpp"
+#include <algorithm>
+#include <cstdio>
+
+Document::Document() {
+    pages.push_back(newPage());
+}
+
+std::unique_ptr<Page> Document::newPage() {
+    auto page = std::make_unique<Page>();
+    page->scene.font = font;
+    page->scene.smoothImages = smoothImages;
+    return page;
+}
+
+int Document::indexOf(const Scene& scene) const {
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (&pages[i]->scene == &scene) return (int)i;
+    }
+    return -1;
+}
+
+void Document::activated() {
+    active().events.sceneCleared();
+}
+
+bool Document::setActivePage(size_t index) {
+    if (index >= pages.size()) return false;
+    if (index == activeIndex) return true;
+    activeIndex = index;
+    activated();
+    return true;
+}
+
+void Document::insert(size_t index, std::unique_ptr<Page> page) {
+    Page& added = *page;
+    pages.insert(pages.begin() + index, std::move(page));
+    if (index <= activeIndex) ++activeIndex;
+    for (DocumentObserver* o : observers) o->pageAdded(added);
+}
+
+size_t Document::insertPage(size_t index) {
+    index = std::min(index, pages.size());
+    insert(index, newPage());
+    return index;
+}
+
+int Document::duplicatePage(size_t index) {
+    if (index >= pages.size()) return -1;
+    const Scene& source = pages[index]->scene;
+    auto copy = newPage();
+    for (const auto& obj : source.objects) copy->scene.restore(obj->clone());
+    for (const auto& master : source.masters) copy->scene.addMaster(master);
+    // The copy starts without history of its own
+    copy->history.clear();
+    insert(index + 1, std::move(copy));
+    return (int)index + 1;
+}
+
+bool Document::removePage(size_t index) {
+    if (index >= pages.size() || pages.size() <= 1) return false;
+    for (DocumentObserver* o : observers) o->pageRemoved(*pages[index]);
+    pages.erase(pages.begin() + index);
+
+    if (index < activeIndex) {
+        --activeIndex;
+    } else if (index == activeIndex) {
+        activeIndex = std::min(activeIndex, pages.size() - 1);
+        activated();
+    }
+    return true;
+}
+
+bool Document::movePage(size_t from, size_t to) {
+    if (from >= pages.size() || to >= pages.size()) return false;
+    if (from == to) return true;
+    Page* current = pages[activeIndex].get();
+    if (from < to) {
+        std::rotate(pages.begin() + from, pages.begin() + from + 1, pages.begin() + to + 1);
+    } else {
+        std::rotate(pages.begin() + to, pages.begin() + from, pages.begin() + from + 1);
+    }
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i].get() == current) activeIndex = i;
+    }
+    for (DocumentObserver* o : observers) o->pagesReordered();
+    return true;
+}
+
+void Document::reset(size_t count) {
+    for (auto& page : pages) {
+        for (DocumentObserver* o : observers) o->pageRemoved(*page);
+    }
+    pages.clear();
+    for (size_t i = 0; i < std::max<size_t>(count, 1); ++i) {
+        pages.push_back(newPage());
+        for (DocumentObserver* o : observers) o->pageAdded(*pages.back());
+    }
+    activeIndex = 0;
+    activated();
+}
+
+void Document::setPageSize(int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    pageWidth = width;
+    pageHeight = height;
+}
+
+void Document::setSmoothImages(bool smooth) {
+    smoothImages = smooth;
+    for (auto& page : pages) page->scene.setSmoothImages(smooth);
+}
+
+void Document::setFont(const uint8_t* data, int size) {
+    auto loaded = std::make_shared<Font>();
+    if (!loaded->load(data, size)) {
+        printf("Error: Could not load font\n");
+        return;
+    }
+    font = std::move(loaded);
+
+    // Pages sharing a layout keep sharing it
+    Scene::MasterCopies copies;
+    for (auto& page : pages) page->scene.setFont(font, copies);
+}
+
+void Document::addObserver(DocumentObserver* observer) {
+    if (std::find(observers.begin(), observers.end(), observer) == observers.end()) {
+        observers.push_back(observer);
+    }
+}
+
+void Document::removeObserver(DocumentObserver* observer) {
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "scene.hpp"
+#include "history.hpp"
+#include "event_queue.hpp"
+
+// One page: its objects, and the undo history and host change log of
+// those objects
+struct Page {
+    Scene scene;
+    History history{scene};
+    EventQueue events{scene};
+};
+
+// Receives page structure changes; the Scene of each page reports its own
+// object changes
+class DocumentObserver {
+public:
+    virtual ~DocumentObserver() = default;
+
+    virtual void pageAdded(Page& /*page*/) {}
+    // Called before the page is destroyed
+    virtual void pageRemoved(Page& /*page*/) {}
+    virtual void pagesReordered() {}
+};
+
+// The pages of a document, in order; there is always at least one.
+//
+// One page is active. Editing, rendering and picking act on that page
+// alone, so their cost does not grow with the page count, and switching
+// pages only changes the active index. The newly active page's change log
+// gets a reset event so the host reloads it.
+class Document {
+public:
+    Document();
+
+    size_t pageCount() const { return pages.size(); }
+    Page& page(size_t index) { return *pages[index]; }
+    const Page& page(size_t index) const { return *pages[index]; }
+    Page& active() { return *pages[activeIndex]; }
+    size_t getActiveIndex() const { return activeIndex; }
+    // Position of the page holding `scene`, or -1
+    int indexOf(const Scene& scene) const;
+
+    bool setActivePage(size_t index);
+    // Inserts an empty page at `index` (clamped to the end); returns its index
+    size_t insertPage(size_t index);
+    // Inserts a copy of the page right after it; returns the copy's index, or -1.
+    // The copy shares the pictures and masters of the original.
+    int duplicatePage(size_t index);
+    // The last remaining page cannot be removed
+    bool removePage(size_t index);
+    // Moves a page to `to`; the active page stays active
+    bool movePage(size_t from, size_t to);
+    // Replaces every page with `count` empty ones (import, open)
+    void reset(size_t count);
+
+    // Canvas area of a page in pixels: the slide size of an imported deck,
+    // otherwise the host's canvas. Thumbnails show this area.
+    void setPageSize(int width, int height);
+    int getPageWidth() const { return pageWidth; }
+    int getPageHeight() const { return pageHeight; }
+
+    // Bilinear picture sampling on every page (on by default); off is
+    // faster and keeps pixel art sharp
+    void setSmoothImages(bool smooth);
+
+    // Loads a font shared by the text of every page, current and future
+    void setFont(const uint8_t* data, int size);
+    const std::shared_ptr<const Font>& getFont() const { return font; }
+
+    void addObserver(DocumentObserver* observer);
+    void removeObserver(DocumentObserver* observer);
+
+private:
+    std::vector<std::unique_ptr<Page>> pages;
+    size_t activeIndex = 0;
+    int pageWidth = 1920;
+    int pageHeight = 1080;
+    bool smoothImages = true;
+    std::shared_ptr<const Font> font;
+    std::vector<DocumentObserver*> observers;
+
+    std::unique_ptr<Page> newPage();
+    void insert(size_t index, std::unique_ptr<Page> page);
+    void activated();
+};
@@ -0,0 +1,76 @@
+#include "event_queue.hpp"
+#include "scene.hpp"
+#include <algorithm>
+
+// Beyond this the host is not listening; it gets one reset instead
+static const size_t kMaxEvents = 1u << 16;
+
+EventQueue::EventQueue(Scene& scene) : scene(scene) {
+    scene.addObserver(this);
+}
+
+EventQueue::~EventQueue() {
+    scene.removeObserver(this);
+}
+
+size_t EventQueue::poll(SceneEvent* out, size_t cap) {
+    size_t n = std::min(cap, events.size() - head);
+    std::copy(events.begin() + head, events.begin() + head + n, out);
+    head += n;
+    if (head == events.size()) {
+        events.clear();
+        modified.clear();
+        head = 0;
+        selection = SIZE_MAX;
+    }
+    return n;
+}
+
+void EventQueue::push(uint32_t type, int uid, uint32_t mask, int index) {
+    if (events.size() - head >= kMaxEvents) {
+        reset();
+        return;
+    }
+    events.push_back(SceneEvent{type, uid, mask, index});
+}
+
+void EventQueue::reset() {
+    events.clear();
+    modified.clear();
+    head = 0;
+    selection = SIZE_MAX;
+    events.push_back(SceneEvent{EventSceneReset, -1, 0, -1});
+}
+
+void EventQueue::objectAdded(const std::shared_ptr<Object>& obj, int index) {
+    push(EventObjectAdded, obj->id, 0, index);
+}
+
+void EventQueue::objectRemoved(const std::shared_ptr<Object>& obj, int index) {
+    modified.erase(obj->id);
+    push(EventObjectRemoved, obj->id, 0, index);
+}
+
+void EventQueue::objectChanged(Object& obj, uint32_t mask) {
+    auto it = modified.find(obj.id);
+    if (it != modified.end() && it->second >= head) {
+        events[it->second].mask |= mask;
+        return;
+    }
+    modified[obj.id] = events.size();
+    push(EventObjectModified, obj.id, mask, -1);
+}
+
+void EventQueue::objectReordered(const std::shared_ptr<Object>& obj, int, int to) {
+    push(EventZOrderChanged, obj->id, 0, to);
+}
+
+void EventQueue::selectionChanged() {
+    if (selection != SIZE_MAX && selection >= head) return;
+    selection = events.size();
+    push(EventSelectionChanged, -1, 0, -1);
+}
+
+void EventQueue::sceneCleared() {
+    reset();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "scene_observer.hpp"
+
+class Scene;
+
+enum SceneEventType : uint32_t {
+    EventObjectAdded = 1,
+    EventObjectRemoved = 2,
+    EventObjectModified = 3,   // `mask` holds the ObjectField bits
+    EventSelectionChanged = 4,
+    EventZOrderChanged = 5,    // `index` is the new position
+    EventSceneReset = 6,       // refresh everything
+};
+
+// Same layout as EngineEvent in engine.h
+struct SceneEvent {
+    uint32_t type;
+    int32_t uid;     // -1 for selection and reset events
+    uint32_t mask;
+    int32_t index;   // draw order position, -1 if not applicable
+};
+
+// Change log drained by the host. Changes to an object already waiting
+// in the queue are merged into its pending event, and repeated selection
+// changes into one, so a drag costs one event per object per poll. A
+// queue nobody drains collapses into a single reset event.
+class EventQueue : public SceneObserver {
+public:
+    explicit EventQueue(Scene& scene);
+    ~EventQueue() override;
+
+    // Moves up to `cap` pending events into `out`, returns how many
+    size_t poll(SceneEvent* out, size_t cap);
+
+    void objectAdded(const std::shared_ptr<Object>& obj, int index) override;
+    void objectRemoved(const std::shared_ptr<Object>& obj, int index) override;
+    void objectChanged(Object& obj, uint32_t mask) override;
+    void objectReordered(const std::shared_ptr<Object>& obj, int from, int to) override;
+    void selectionChanged() override;
+    void sceneCleared() override;
+
+private:
+    Scene& scene;
+    std::vector<SceneEvent> events;
+    size_t head = 0;                          // first undrained event
+    std::unordered_map<int, size_t> modified; // uid -> its pending Modified event
+    size_t selection = SIZE_MAX;              // pending SelectionChanged event
+
+    void push(uint32_t type, int uid, uint32_t mask, int index);
+    void reset();
+};
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include "stb_truetype.h" 
 
+// A loaded TrueType font. Immutable once loaded, so scenes and their text
+// objects share it across threads.
 class Font {
 public:
     stbtt_fontinfo info;
@@ -19,9 +21,4 @@ public:
         stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
         return true;
     }
-    
-    static Font& GetDefault() {
-        static Font instance;
-        return instance;
-    }
 };
@@ -0,0 +1,219 @@
+#include "history.hpp"
+#include "scene.hpp"
+#include "../objects/image_object.hpp"
+#include <algorithm>
+
+// Memory a removed object keeps alive while its transaction is in history
+static size_t retainedBytes(Object& obj) {
+    size_t bytes = sizeof(Object) + obj.name.capacity();
+    if (auto* img = dynamic_cast<ImageObject*>(&obj)) {
+        if (img->image) {
+            bytes += img->image->byteSize() + img->image->source().encoded.size();
+        }
+    }
+    return bytes;
+}
+
+History::History(Scene& scene) : scene(scene) {
+    scene.addObserver(this);
+}
+
+History::~History() {
+    scene.removeObserver(this);
+}
+
+void History::begin() {
+    ++depth;
+}
+
+void History::commit() {
+    if (depth == 0) return;
+    if (--depth == 0) finish();
+}
+
+History::Transaction& History::current() {
+    return open;
+}
+
+void History::finish() {
+    changeSteps.clear();
+    if (open.steps.empty()) return;
+
+    undoBytes += open.bytes;
+    undoStack.push_back(std::move(open));
+    open = Transaction();
+    redoStack.clear();
+    trim();
+}
+
+void History::trim() {
+    // The latest transaction is always kept, whatever its size
+    while (undoBytes > maxBytes && undoStack.size() > 1) {
+        undoBytes -= undoStack.front().bytes;
+        undoStack.pop_front();
+    }
+}
+
+void History::setLimit(size_t bytes) {
+    maxBytes = bytes;
+    trim();
+}
+
+void History::clear() {
+    undoStack.clear();
+    redoStack.clear();
+    undoBytes = 0;
+    open = Transaction();
+    changeSteps.clear();
+}
+
+void History::objectAdded(const std::shared_ptr<Object>& obj, int index) {
+    if (replaying) return;
+    Step step{Step::Add, obj->id, obj, index, {}, {}};
+    current().steps.push_back(std::move(step));
+    current().bytes += sizeof(Step);
+    if (depth == 0) finish();
+}
+
+void History::objectRemoved(const std::shared_ptr<Object>& obj, int index) {
+    if (replaying) return;
+    Step step{Step::Remove, obj->id, obj, index, {}, {}};
+    current().steps.push_back(std::move(step));
+    current().bytes += sizeof(Step) + retainedBytes(*obj);
+    changeSteps.erase(obj->id);
+    if (depth == 0) finish();
+}
+
+void History::objectChanging(Object& obj, uint32_t mask) {
+    if (replaying) return;
+    Transaction& t = current();
+    auto it = changeSteps.find(obj.id);
+    if (it != changeSteps.end() && t.steps[it->second].before.mask == mask) return;
+
+    Step step{Step::Change, obj.id, nullptr, -1, captureState(obj, mask), {}};
+    t.bytes += sizeof(Step) + step.before.text.size();
+    changeSteps[obj.id] = t.steps.size();
+    t.steps.push_back(std::move(step));
+}
+
+void History::objectChanged(Object& obj, uint32_t mask) {
+    if (replaying) return;
+    Transaction& t = current();
+    auto it = changeSteps.find(obj.id);
+    if (it != changeSteps.end() && t.steps[it->second].before.mask == mask) {
+        Step& step = t.steps[it->second];
+        t.bytes -= step.after.text.size();
+        step.after = captureState(obj, mask);
+        t.bytes += step.after.text.size();
+    }
+    if (depth == 0) finish();
+}
+
+void History::objectReordered(const std::shared_ptr<Object>& obj, int from, int to) {
+    if (replaying) return;
+    Step step{Step::Reorder, obj->id, nullptr, from, {}, {}, to};
+    current().steps.push_back(std::move(step));
+    current().bytes += sizeof(Step);
+    if (depth == 0) finish();
+}
+
+void History::sceneCleared() {
+    if (!replaying) clear();
+}
+
+// Final positions of a run of inserts applied one after another
+static std::vector<std::pair<int, std::shared_ptr<Object>>>
+placeInserts(const std::vector<std::pair<int, std::shared_ptr<Object>>>& inserts) {
+    std::vector<std::pair<int, std::shared_ptr<Object>>> placed(inserts);
+    for (size_t j = 0; j < placed.size(); ++j) {
+        for (size_t l = 0; l < j; ++l) {
+            if (placed[l].first >= placed[j].first) ++placed[l].first;
+        }
+    }
+    std::sort(placed.begin(), placed.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    return placed;
+}
+
+// Replays a transaction backward (undo) or forward (redo). Consecutive adds,
+// removes and changes are applied as one batch, so the draw order is walked
+// once per run instead of once per object.
+void History::apply(Transaction& t, bool forward) {
+    replaying = true;
+    size_t n = t.steps.size();
+    size_t i = 0;
+    while (i < n) {
+        const Step& s = t.steps[forward ? i : n - 1 - i];
+        if (s.kind == Step::Reorder) {
+            scene.reorderObject(s.uid, forward ? s.to : s.index);
+            ++i;
+            continue;
+        }
+
+        // Redoing an add or undoing a remove puts objects back
+        bool inserts = (s.kind == Step::Add) == forward;
+        Step::Kind kind = s.kind;
+        size_t first = i;
+        for (; i < n; ++i) {
+            if (t.steps[forward ? i : n - 1 - i].kind != kind) break;
+        }
+
+        if (kind == Step::Change) {
+            std::vector<std::pair<int, const ObjectState*>> states;
+            states.reserve(i - first);
+            for (size_t k = first; k < i; ++k) {
+                const Step& r = t.steps[forward ? k : n - 1 - k];
+                states.emplace_back(r.uid, forward ? &r.after : &r.before);
+            }
+            scene.applyObjectStates(states);
+        } else if (inserts) {
+            std::vector<std::pair<int, std::shared_ptr<Object>>> run;
+            for (size_t k = first; k < i; ++k) {
+                const Step& r = t.steps[forward ? k : n - 1 - k];
+                run.emplace_back(r.index, r.obj);
+            }
+            scene.restoreObjects(placeInserts(run));
+        } else {
+            std::vector<int> uids;
+            uids.reserve(i - first);
+            for (size_t k = first; k < i; ++k) uids.push_back(t.steps[forward ? k : n - 1 - k].uid);
+            // Keep what was actually removed: it may be a copy of the
+            // object this step was recorded with
+            std::unordered_map<int, std::shared_ptr<Object>> removed;
+            for (auto& obj : scene.removeObjects(uids)) removed[obj->id] = std::move(obj);
+            for (size_t k = first; k < i; ++k) {
+                Step& r = t.steps[forward ? k : n - 1 - k];
+                auto it = removed.find(r.uid);
+                if (it != removed.end()) r.obj = it->second;
+            }
+        }
+    }
+    replaying = false;
+}
+
+bool History::undo() {
+    // An unfinished transaction is closed first
+    if (depth > 0) {
+        depth = 0;
+        finish();
+    }
+    if (undoStack.empty()) return false;
+
+    Transaction t = std::move(undoStack.back());
+    undoStack.pop_back();
+    undoBytes -= t.bytes;
+    apply(t, false);
+    redoStack.push_back(std::move(t));
+    return true;
+}
+
+bool History::redo() {
+    if (depth > 0 || redoStack.empty()) return false;
+
+    Transaction t = std::move(redoStack.back());
+    redoStack.pop_back();
+    apply(t, true);
+    undoBytes += t.bytes;
+    undoStack.push_back(std::move(t));
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "object_state.hpp"
+#include "scene_observer.hpp"
+
+class Scene;
+
+// Undo/redo of Scene mutations.
+//
+// Mutations between begin() and commit() form one transaction; mutations
+// made outside a transaction are recorded as transactions of their own.
+// A transaction stores only what it touched: the before/after values of the
+// changed fields, and the added or removed objects themselves, kept alive
+// by shared ownership so undoing a delete restores the very same object.
+// The oldest transactions are dropped once the history exceeds its memory
+// budget.
+class History : public SceneObserver {
+public:
+    explicit History(Scene& scene);
+    ~History() override;
+
+    void begin();
+    void commit();
+
+    bool undo();
+    bool redo();
+    bool canUndo() const { return !undoStack.empty(); }
+    bool canRedo() const { return !redoStack.empty(); }
+
+    void clear();
+    void setLimit(size_t maxBytes);
+
+    void objectAdded(const std::shared_ptr<Object>& obj, int index) override;
+    void objectRemoved(const std::shared_ptr<Object>& obj, int index) override;
+    void objectChanging(Object& obj, uint32_t mask) override;
+    void objectChanged(Object& obj, uint32_t mask) override;
+    void objectReordered(const std::shared_ptr<Object>& obj, int from, int to) override;
+    void sceneCleared() override;
+
+private:
+    struct Step {
+        enum Kind { Add, Remove, Change, Reorder } kind;
+        int uid;
+        std::shared_ptr<Object> obj;    // Add, Remove
+        int index = -1;                 // draw order position (Add, Remove, Reorder)
+        ObjectState before, after;      // Change
+        int to = -1;                    // Reorder
+    };
+
+    struct Transaction {
+        std::vector<Step> steps;
+        size_t bytes = 0;
+    };
+
+    Scene& scene;
+    std::deque<Transaction> undoStack;
+    std::vector<Transaction> redoStack;
+    size_t undoBytes = 0;
+    size_t maxBytes = 64u << 20;
+
+    int depth = 0;
+    bool replaying = false;
+    Transaction open;
+    // Repeated changes of the same fields of an object (a drag) share a step
+    // (keyed by uid: snapshots make the Scene swap in copies of objects)
+    std::unordered_map<int, size_t> changeSteps;
+
+    Transaction& current();
+    void finish();
+    void trim();
+    void apply(Transaction& t, bool forward);
+};
@@ -0,0 +1,72 @@
+#include "image_cache.hpp"
+#include "image_data.hpp"
+#include <algorithm>
+#include <cstdint>
+
+ImageCache& ImageCache::shared() {
+    // Never destroyed: pictures may outlive static destruction order
+    static ImageCache* cache = new ImageCache();
+    return *cache;
+}
+
+std::shared_ptr<const ImageData> ImageCache::find(const ImageData& source) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(&source);
+    if (it == index.end()) return nullptr;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->pixels;
+}
+
+void ImageCache::insert(const ImageData& source, std::shared_ptr<const ImageData> pixels) {
+    // Mip levels add up to a third of the picture
+    size_t size = pixels->byteSize() * 4 / 3;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(&source);
+    if (it != index.end()) {
+        bytes -= it->second->bytes;
+        entries.erase(it->second);
+    }
+    entries.push_front(Entry{&source, std::move(pixels), size});
+    index[&source] = entries.begin();
+    bytes += size;
+    // The picture just decoded stays, even if it alone is over budget
+    evict(std::max(budget, size));
+}
+
+void ImageCache::remove(const ImageData& source) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(&source);
+    if (it == index.end()) return;
+    bytes -= it->second->bytes;
+    entries.erase(it->second);
+    index.erase(it);
+}
+
+void ImageCache::setBudget(size_t limit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = limit;
+    evict(budget);
+}
+
+size_t ImageCache::getBudget() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return budget;
+}
+
+size_t ImageCache::getBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytes;
+}
+
+void ImageCache::trim(int level) {
+    std::lock_guard<std::mutex> lock(mutex);
+    evict(level <= 0 ? budget / 2 : 0);
+}
+
+void ImageCache::evict(size_t limit) {
+    while (bytes > limit && !entries.empty()) {
+        bytes -= entries.back().bytes;
+        index.erase(entries.back().source);
+        entries.pop_back();
+    }
+}
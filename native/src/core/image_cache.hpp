@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct ImageData;
+
+// Decoded pixels of pictures kept as compressed files (see
+// ImageData::decoded), shared by every document and engine instance.
+//
+// Pictures are decoded on the first draw that needs them and stay cached
+// until the cache grows past its budget, when the least recently drawn are
+// dropped first. A picture being drawn stays valid, since the drawer holds
+// its own reference. Memory follows what is on screen, not the deck size.
+class ImageCache {
+public:
+    static constexpr size_t kDefaultBudget = (size_t)256 << 20;
+
+    static ImageCache& shared();
+
+    // The decoded copy of `source`, marked as just used, or null
+    std::shared_ptr<const ImageData> find(const ImageData& source);
+    void insert(const ImageData& source, std::shared_ptr<const ImageData> pixels);
+    // Called when `source` is destroyed
+    void remove(const ImageData& source);
+
+    void setBudget(size_t bytes);
+    size_t getBudget() const;
+    size_t getBytes() const;
+
+    // Frees memory on request of the host: level 0 evicts down to half the
+    // budget, higher levels evict everything
+    void trim(int level);
+
+private:
+    struct Entry {
+        const ImageData* source;
+        std::shared_ptr<const ImageData> pixels;
+        size_t bytes;
+    };
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<const ImageData*, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+    size_t budget = kDefaultBudget;
+
+    void evict(size_t limit);
+};
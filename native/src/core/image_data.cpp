@@ -0,0 +1,332 @@
+#include "image_data.hpp"
+#include "image_cache.hpp"
+#include <algorithm>
+#include <cstdio>
+
+#include "stb_image.h"
+
+// Sizes the pixel buffer for the image's format and size; returns its bytes
+static uint8_t* allocatePixels(ImageData& image) {
+    size_t count = (size_t)image.width * image.height;
+    if (image.format == PixelFormat::BGRA) {
+        image.storage.resize(count);
+        image.pixels = image.storage.data();
+        return (uint8_t*)image.storage.data();
+    }
+    // RGB gets a spare byte so its last pixel can be read as 32 bits too
+    image.packed.resize(count * image.bytesPerPixel() + (image.format == PixelFormat::RGB ? 1 : 0));
+    return image.packed.data();
+}
+
+// Stores decoded RGBA in the most compact layout its content allows:
+// RGB when nothing is transparent, a mask when every visible pixel has the
+// same color, BGRA otherwise
+static std::shared_ptr<ImageData> pack(const unsigned char* rgba, int w, int h) {
+    size_t count = (size_t)w * h;
+    bool opaque = true, oneColor = true, seen = false;
+    uint32_t color = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char* p = rgba + i * 4;
+        opaque &= p[3] == 255;
+        if (p[3] == 0) continue;
+        uint32_t c = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+        if (!seen) color = c;
+        oneColor &= c == color;
+        seen = true;
+    }
+
+    auto image = std::make_shared<ImageData>();
+    image->width = w;
+    image->height = h;
+    if (opaque) {
+        image->format = PixelFormat::RGB;
+        uint8_t* out = allocatePixels(*image);
+        for (size_t i = 0; i < count; ++i, out += 3) {
+            const unsigned char* p = rgba + i * 4;
+            out[0] = p[2];
+            out[1] = p[1];
+            out[2] = p[0];
+        }
+    } else if (oneColor) {
+        image->format = PixelFormat::Mask;
+        image->maskColor = color;
+        uint8_t* out = allocatePixels(*image);
+        for (size_t i = 0; i < count; ++i) out[i] = rgba[i * 4 + 3];
+    } else {
+        uint32_t* out = (uint32_t*)allocatePixels(*image);
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned char* p = rgba + i * 4;
+            out[i] = ((uint32_t)p[3] << 24) | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+        }
+    }
+    return image;
+}
+
+std::shared_ptr<ImageData> decodeImage(const uint8_t* data, size_t size) {
+    int w, h, channels;
+    unsigned char* rgba = stbi_load_from_memory(data, (int)size, &w, &h, &channels, 4);
+    if (!rgba) return nullptr;
+    std::shared_ptr<ImageData> image = pack(rgba, w, h);
+    stbi_image_free(rgba);
+    return image;
+}
+
+std::shared_ptr<ImageData> makeEncodedImage(std::vector<uint8_t> file) {
+    int w, h, channels;
+    if (!stbi_info_from_memory(file.data(), (int)file.size(), &w, &h, &channels)) return nullptr;
+    auto image = std::make_shared<ImageData>();
+    image->width = w;
+    image->height = h;
+    image->encoded = std::move(file);
+    return image;
+}
+
+std::shared_ptr<ImageData> makeReducedImage(std::shared_ptr<const ImageData> original, int width, int height) {
+    auto image = std::make_shared<ImageData>();
+    image->width = width;
+    image->height = height;
+    image->original = std::move(original);
+    return image;
+}
+
+ImageData::~ImageData() {
+    if (isLazy()) ImageCache::shared().remove(*this);
+}
+
+template <class Pixels>
+static void expandRow(const Pixels& src, int y, uint32_t* out) {
+    const uint8_t* row = src.row(y);
+    for (int x = 0; x < src.image.width; ++x) out[x] = src(row, x);
+}
+
+void ImageData::readRow(int y, uint32_t* out) const {
+    switch (format) {
+    case PixelFormat::BGRA: expandRow(BgraPixels{*this}, y, out); break;
+    case PixelFormat::RGB: expandRow(RgbPixels{*this}, y, out); break;
+    case PixelFormat::Mask: expandRow(MaskPixels{*this}, y, out); break;
+    }
+}
+
+bool ImageData::isOpaque() const {
+    int known = opacity.load(std::memory_order_relaxed);
+    if (known >= 0) return known == 1;
+
+    bool opaque = format == PixelFormat::RGB;
+    if (format == PixelFormat::BGRA && pixels) {
+        // AND of all pixels: the alpha byte stays 255 only if it is in every one
+        uint32_t all = 0xFF000000;
+        size_t count = (size_t)width * height;
+        for (size_t i = 0; i < count; ++i) all &= pixels[i];
+        opaque = (all >> 24) == 0xFF;
+    }
+    opacity.store(opaque ? 1 : 0, std::memory_order_relaxed);
+    return opaque;
+}
+
+void ImageData::takePixels(ImageData& from) {
+    format = from.format;
+    width = from.width;
+    height = from.height;
+    storage = std::move(from.storage);
+    backing = std::move(from.backing);
+    packed = std::move(from.packed);
+    maskColor = from.maskColor;
+    // A moved vector keeps its buffer, so owned pixels stay where they were
+    pixels = from.pixels;
+    opacity.store(from.opacity.load());
+    from.pixels = nullptr;
+}
+
+std::shared_ptr<ImageData> makeImageView(const uint32_t* pixels, int width, int height,
+                                         std::shared_ptr<const void> backing) {
+    auto view = std::make_shared<ImageData>();
+    view->pixels = pixels;
+    view->width = width;
+    view->height = height;
+    view->backing = std::move(backing);
+    auto image = std::make_shared<ImageData>();
+    image->width = width;
+    image->height = height;
+    image->view = std::move(view);
+    return image;
+}
+
+void ImageData::ownPixels() const {
+    std::shared_ptr<const ImageData> borrowed = std::atomic_load(&view);
+    if (!borrowed || !borrowed->backing) return;
+    const uint32_t* p = borrowed->pixels;
+    std::shared_ptr<const ImageData> owned =
+        makeImageData(std::vector<uint32_t>(p, p + (size_t)borrowed->width * borrowed->height),
+                      borrowed->width, borrowed->height);
+    std::atomic_store(&view, owned);
+}
+
+std::shared_ptr<const ImageData> ImageData::decoded() const {
+    if (auto pixels = std::atomic_load(&view)) return pixels;
+    if (!isLazy()) return shared_from_this();
+
+    ImageCache& cache = ImageCache::shared();
+    if (auto hit = cache.find(*this)) return hit;
+    // Threads drawing the same picture wait for one decode
+    std::lock_guard<std::mutex> lock(decodeMutex);
+    if (auto hit = cache.find(*this)) return hit;
+
+    const std::vector<uint8_t>& file = source().encoded;
+    std::shared_ptr<const ImageData> copy = decodeImage(file.data(), file.size());
+    if (!copy) {
+        printf("Error: Could not decode picture (%zu bytes)\n", file.size());
+        // Cached too, so the file is not decoded again on every draw
+        copy = undecodableImage();
+    } else if (copy->width != width || copy->height != height) {
+        copy = downscaleImage(*copy, width, height);
+    }
+    cache.insert(*this, copy);
+    return copy;
+}
+
+const std::shared_ptr<const ImageData>& undecodableImage() {
+    static const std::shared_ptr<const ImageData> image = makeImageData(std::vector<uint32_t>(1, 0), 1, 1);
+    return image;
+}
+
+// Halves the picture with a 2x2 box filter. BGRA channels are summed in
+// pairs, 16 bits apart, so a pixel takes two additions instead of four;
+// the packed formats are averaged byte by byte.
+static std::unique_ptr<ImageData> halve(const ImageData& src) {
+    int w = std::max(1, src.width / 2);
+    int h = std::max(1, src.height / 2);
+    auto out = std::make_unique<ImageData>();
+    out->format = src.format;
+    out->maskColor = src.maskColor;
+    out->width = w;
+    out->height = h;
+
+    // A single row or column is averaged with itself
+    int dx = src.width > 1 ? 1 : 0;
+    size_t dy = src.height > 1 ? (size_t)src.width : 0;
+    uint8_t* bytes = allocatePixels(*out);
+    if (src.format == PixelFormat::BGRA) {
+        for (int y = 0; y < h; ++y) {
+            const uint32_t* r0 = src.pixels + (size_t)2 * y * src.width;
+            const uint32_t* r1 = r0 + dy;
+            uint32_t* dst = out->storage.data() + (size_t)y * w;
+            for (int x = 0; x < w; ++x) {
+                uint32_t a = r0[2 * x], b = r0[2 * x + dx], c = r1[2 * x], d = r1[2 * x + dx];
+                uint32_t rb = (a & 0x00FF00FF) + (b & 0x00FF00FF) + (c & 0x00FF00FF) + (d & 0x00FF00FF) + 0x00020002;
+                uint32_t ag = ((a >> 8) & 0x00FF00FF) + ((b >> 8) & 0x00FF00FF) + ((c >> 8) & 0x00FF00FF) +
+                              ((d >> 8) & 0x00FF00FF) + 0x00020002;
+                dst[x] = ((rb >> 2) & 0x00FF00FF) | (((ag >> 2) & 0x00FF00FF) << 8);
+            }
+        }
+        return out;
+    }
+
+    int n = src.bytesPerPixel();
+    size_t stride = (size_t)src.width * n;
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* r0 = src.packed.data() + (size_t)2 * y * stride;
+        const uint8_t* r1 = r0 + dy * n;
+        uint8_t* dst = bytes + (size_t)y * w * n;
+        for (int x = 0; x < w; ++x) {
+            const uint8_t* a = r0 + (size_t)2 * x * n;
+            const uint8_t* c = r1 + (size_t)2 * x * n;
+            for (int k = 0; k < n; ++k) {
+                *dst++ = (uint8_t)((a[k] + a[k + dx * n] + c[k] + c[k + dx * n] + 2) >> 2);
+            }
+        }
+    }
+    return out;
+}
+
+const ImageData* ImageData::mip(int level) const {
+    if (level <= 0 || !hasPixels()) return this;
+    std::lock_guard<std::mutex> lock(mipMutex);
+    while ((int)mips.size() < level) {
+        const ImageData& last = mips.empty() ? *this : *mips.back();
+        if (last.width == 1 && last.height == 1) break;
+        mips.push_back(halve(last));
+    }
+    return mips.empty() ? this : mips[std::min<size_t>(level, mips.size()) - 1].get();
+}
+
+int ImageData::mipLevelFor(int w, int h) const {
+    int level = 0;
+    int lw = width, lh = height;
+    while (lw / 2 >= w && lh / 2 >= h && (lw > 1 || lh > 1)) {
+        lw = std::max(1, lw / 2);
+        lh = std::max(1, lh / 2);
+        ++level;
+    }
+    return level;
+}
+
+// Source pixels under one destination pixel along an axis, with 16-bit
+// weights summing to 65536
+struct Footprint {
+    int first = 0;
+    std::vector<uint32_t> weights;
+};
+
+static std::vector<Footprint> footprints(int src, int dst) {
+    std::vector<Footprint> out(dst);
+    for (int i = 0; i < dst; ++i) {
+        // Positions in 1/dst source pixels
+        int64_t lo = (int64_t)i * src, hi = lo + src;
+        Footprint& f = out[i];
+        f.first = (int)(lo / dst);
+        int last = (int)((hi - 1) / dst);
+        uint32_t total = 0;
+        for (int s = f.first; s <= last; ++s) {
+            int64_t covered = std::min(hi, (int64_t)(s + 1) * dst) - std::max(lo, (int64_t)s * dst);
+            f.weights.push_back((uint32_t)(covered * 65536 / src));
+            total += f.weights.back();
+        }
+        f.weights[0] += 65536 - total; // rounding
+    }
+    return out;
+}
+
+std::shared_ptr<ImageData> downscaleImage(const ImageData& image, int width, int height) {
+    int sw = image.width, sh = image.height;
+    width = std::max(1, std::min(width, sw));
+    height = std::max(1, std::min(height, sh));
+    std::vector<Footprint> cols = footprints(sw, width);
+    std::vector<Footprint> rows = footprints(sh, height);
+
+    // Same format out as in; channels are just bytes here
+    auto out = std::make_shared<ImageData>();
+    out->format = image.format;
+    out->maskColor = image.maskColor;
+    out->width = width;
+    out->height = height;
+    int n = image.bytesPerPixel();
+    uint8_t* dst = allocatePixels(*out);
+
+    const uint8_t* pixels = image.data();
+    std::vector<uint32_t> acc((size_t)sw * n);
+    for (int y = 0; y < height; ++y) {
+        // Rows first, over bytes regardless of channel: a plain multiply-add
+        // loop the compiler vectorizes
+        std::fill(acc.begin(), acc.end(), 0);
+        const Footprint& fy = rows[y];
+        for (size_t t = 0; t < fy.weights.size(); ++t) {
+            const uint8_t* src = pixels + (size_t)(fy.first + t) * sw * n;
+            uint32_t weight = fy.weights[t];
+            for (size_t i = 0; i < acc.size(); ++i) acc[i] += src[i] * weight;
+        }
+        // 8.8 fixed point, so the column pass fits 32 bits
+        for (uint32_t& v : acc) v = (v + 128) >> 8;
+
+        for (int x = 0; x < width; ++x) {
+            const Footprint& fx = cols[x];
+            uint32_t sum[4] = {0, 0, 0, 0};
+            for (size_t t = 0; t < fx.weights.size(); ++t) {
+                const uint32_t* p = &acc[(size_t)(fx.first + t) * n];
+                uint32_t weight = fx.weights[t];
+                for (int c = 0; c < n; ++c) sum[c] += p[c] * weight;
+            }
+            for (int c = 0; c < n; ++c) *dst++ = (uint8_t)((sum[c] + (1u << 23)) >> 24);
+        }
+    }
+    return out;
+}
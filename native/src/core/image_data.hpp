@@ -0,0 +1,161 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// How the pixels of a picture are laid out. Decoded files use the compact
+// layouts when their content allows.
+enum class PixelFormat : uint8_t {
+    BGRA, // 4 bytes per pixel, in `pixels`
+    RGB,  // fully opaque: B, G, R bytes, in `packed`
+    Mask, // one color at varying opacity: alpha bytes over maskColor, in `packed`
+};
+
+// A picture, shared by every object that shows it.
+//
+// The pixels are either owned, borrowed from memory (e.g. a mapped
+// document) that `backing` keeps alive, or not decoded yet: a picture
+// imported from a file keeps the compressed file and decodes it on the
+// first draw that needs it, into the shared ImageCache.
+//
+// A picture opened in place from a document draws the pixels of a view
+// into the mapping, which ownPixels() can swap for an owned copy while
+// other threads draw.
+struct ImageData : std::enable_shared_from_this<ImageData> {
+    PixelFormat format = PixelFormat::BGRA;
+    const uint32_t* pixels = nullptr; // BGRA, width * height; null until decoded
+    int width = 0;                    // size of the (decoded) pixels
+    int height = 0;
+
+    std::vector<uint32_t> storage;        // owned BGRA pixels
+    std::shared_ptr<const void> backing;  // keeps borrowed pixels valid
+    std::vector<uint8_t> packed;          // RGB and Mask pixels, rows unpadded,
+                                          // RGB with one spare byte at the end
+    uint32_t maskColor = 0;               // Mask: the color, alpha 0
+
+    // The file the picture came from (PNG, JPEG, ...), if kept. It may be
+    // larger than width x height, which it is reduced to when decoded.
+    // Exports embed JPEG files as is instead of re-encoding the pixels.
+    std::vector<uint8_t> encoded;
+    // For a reduced copy: the full-size picture whose file it decodes
+    std::shared_ptr<const ImageData> original;
+
+    ~ImageData();
+
+    bool isJpeg() const { return encoded.size() > 2 && encoded[0] == 0xFF && encoded[1] == 0xD8; }
+    bool hasPixels() const { return pixels || !packed.empty(); }
+    // The picture holding the file: the original of a reduced copy, else itself
+    const ImageData& source() const { return original ? *original : *this; }
+    // Pixels come from the source's `encoded` on demand
+    bool isLazy() const { return !hasPixels() && !source().encoded.empty(); }
+    // Pixels are those of a view (see makeImageView)
+    bool isView() const { return std::atomic_load(&view) != nullptr; }
+    // Replaces the pixels a view borrows with a copy of its own, so the
+    // mapping can be released once draws holding the old view finish
+    void ownPixels() const;
+
+    int bytesPerPixel() const { return format == PixelFormat::BGRA ? 4 : format == PixelFormat::RGB ? 3 : 1; }
+    const uint8_t* data() const { return format == PixelFormat::BGRA ? (const uint8_t*)pixels : packed.data(); }
+    // Memory the picture owns
+    size_t byteSize() const { return storage.size() * sizeof(uint32_t) + packed.size(); }
+    // Row y in BGRA, whatever the format
+    void readRow(int y, uint32_t* out) const;
+    // Whether no pixel shows what is behind it. Found by a scan of BGRA
+    // pixels on first call, then kept.
+    bool isOpaque() const;
+    // Takes over the pixels of `from`, which is left without any
+    void takePixels(ImageData& from);
+
+    // The picture with its pixels: itself, or its decoded copy. Holding
+    // the result keeps the pixels valid even if the cache evicts them
+    // meanwhile. A file that fails to decode gives undecodableImage().
+    std::shared_ptr<const ImageData> decoded() const;
+
+    // Mip pyramid: level n is the picture halved n times with a box
+    // filter; level 0 is the picture itself. Levels are built on first use
+    // and kept, so a picture drawn small is averaged once, not aliased on
+    // every frame. Safe to call from several render threads.
+    const ImageData* mip(int level) const;
+    // The smallest level still at least width x height, so sampling it
+    // never skips source pixels
+    int mipLevelFor(int width, int height) const;
+
+private:
+    friend std::shared_ptr<ImageData> makeImageView(const uint32_t*, int, int, std::shared_ptr<const void>);
+
+    mutable std::shared_ptr<const ImageData> view; // accessed atomically
+    mutable std::atomic<int> opacity{-1}; // -1 unknown, else 0 or 1
+    mutable std::mutex mipMutex;
+    mutable std::vector<std::unique_ptr<ImageData>> mips; // levels 1, 2, ...
+    mutable std::mutex decodeMutex; // one decode at a time per picture
+};
+
+// What decoded() gives for a file that fails to decode: one transparent
+// pixel, shared, which draws nothing
+const std::shared_ptr<const ImageData>& undecodableImage();
+
+// Decodes an image file into BGRA pixels, or null
+std::shared_ptr<ImageData> decodeImage(const uint8_t* data, size_t size);
+// A picture decoded from `file` when first drawn; null if the format or
+// size cannot be read
+std::shared_ptr<ImageData> makeEncodedImage(std::vector<uint8_t> file);
+// A picture that decodes the file of `original` reduced to width x height
+// when first drawn; the original keeps its own size
+std::shared_ptr<ImageData> makeReducedImage(std::shared_ptr<const ImageData> original, int width, int height);
+
+// Copy of the picture reduced to width x height (each at most the source
+// size) with an area-weighted box filter: every source pixel contributes in
+// proportion to how much of the destination pixel it covers, so ratios that
+// are not powers of two neither alias nor blur more than needed
+std::shared_ptr<ImageData> downscaleImage(const ImageData& image, int width, int height);
+
+inline std::shared_ptr<ImageData> makeImageData(std::vector<uint32_t> pixels, int width, int height) {
+    auto image = std::make_shared<ImageData>();
+    image->storage = std::move(pixels);
+    image->pixels = image->storage.data();
+    image->width = width;
+    image->height = height;
+    return image;
+}
+
+// A picture drawing `pixels` in place, valid as long as `backing` lives
+std::shared_ptr<ImageData> makeImageView(const uint32_t* pixels, int width, int height,
+                                         std::shared_ptr<const void> backing);
+
+// Readers of one pixel format, for loops templated on it: row(y) points at
+// a row, and (row, x) gives pixel x of it as BGRA. kOpaque formats can be
+// stored without blending.
+struct BgraPixels {
+    static constexpr bool kOpaque = false;
+    const ImageData& image;
+    const uint8_t* row(int y) const { return (const uint8_t*)(image.pixels + (size_t)y * image.width); }
+    uint32_t operator()(const uint8_t* row, int x) const { return ((const uint32_t*)row)[x]; }
+};
+
+// BGRA whose alpha is known to be 255 throughout
+struct OpaquePixels : BgraPixels {
+    static constexpr bool kOpaque = true;
+};
+
+struct RgbPixels {
+    static constexpr bool kOpaque = true;
+    const ImageData& image;
+    const uint8_t* row(int y) const { return image.packed.data() + (size_t)y * image.width * 3; }
+    // One unaligned load takes B, G, R and the next byte, which alpha covers
+    uint32_t operator()(const uint8_t* row, int x) const {
+        uint32_t p;
+        memcpy(&p, row + (size_t)x * 3, sizeof(p));
+        return p | 0xFF000000u;
+    }
+};
+
+struct MaskPixels {
+    static constexpr bool kOpaque = false;
+    const ImageData& image;
+    const uint8_t* row(int y) const { return image.packed.data() + (size_t)y * image.width; }
+    uint32_t operator()(const uint8_t* row, int x) const { return (uint32_t)row[x] << 24 | image.maskColor; }
+};
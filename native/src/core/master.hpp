@@ -0,0 +1,41 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "object.hpp"
+#include "surface.hpp"
+
+// Content a slide inherits from its layout and master: the background and
+// the non-placeholder shapes (logos, rules, decorations). Each layout and
+// master is built once per import and shared by every slide that uses it.
+class MasterContent {
+public:
+    std::shared_ptr<MasterContent> parent; // layout -> master
+    bool showParentShapes = true;          // p:sldLayout/@showMasterSp
+
+    bool hasBackground = false;
+    uint32_t background = 0xFFFFFFFF;
+    int width = 0;                         // slide size in pixels
+    int height = 0;
+
+    std::vector<std::shared_ptr<Object>> objects;
+
+    void draw(const Surface& surface) const {
+        const MasterContent* bg = this;
+        while (bg && !bg->hasBackground) bg = bg->parent.get();
+        if (bg) {
+            int x1 = std::min(surface.width, width);
+            int y1 = std::min(surface.bottom(), height);
+            for (int py = surface.top; py < y1; ++py) {
+                std::fill_n(surface.row(py), std::max(0, x1), bg->background);
+            }
+        }
+        drawShapes(surface);
+    }
+
+private:
+    void drawShapes(const Surface& surface) const {
+        if (parent && showParentShapes) parent->drawShapes(surface);
+        for (const auto& obj : objects) obj->draw(surface);
+    }
+};
@@ -2,19 +2,29 @@
 #include <string>
 #include <cstdint>
 #include <algorithm>
+#include <memory>
 
-class SceneObject {
+class Font;
+struct Surface;
+
+// Objects are always owned by shared_ptr (scene, history, snapshots)
+class SceneObject : public std::enable_shared_from_this<SceneObject> {
 public:
     int id;
     std::string name;
     float x, y, w, h;
-    
+    // Shared with a SceneSnapshot: the Scene edits a clone() instead
+    bool frozen = false;
+
     virtual ~SceneObject() = default;
 
     SceneObject(int id, std::string name, float x, float y, float w, float h) 
         : id(id), name(std::move(name)), x(x), y(y), w(w), h(h) {}
 
-    virtual void draw(uint32_t* buffer, int bufW, int bufH) = 0;
+    virtual std::shared_ptr<SceneObject> clone() const = 0;
+
+    // Must not modify the object: snapshots draw it from other threads
+    virtual void draw(const Surface& surface) const = 0;
 
     // Type identifiers: 0=rect, 1=text, 2=image, 3=ellipse, 4=line
     virtual int getType() { return 0; }
@@ -40,6 +50,9 @@ public:
     
     virtual void setFontSize(float /*s*/) {}
     virtual float getFontSize() { return 0; }
+
+    // Set by the Scene holding the object; text measures and draws with it
+    virtual void setFont(const std::shared_ptr<const Font>& /*font*/) {}
 };
 
 // Alias for backward compatibility
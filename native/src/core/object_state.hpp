@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "object.hpp"
+#include "../objects/line_object.hpp"
+
+// Editable properties of an object, as changed by the Scene mutators
+enum ObjectField : uint32_t {
+    FieldGeometry = 1,   // x, y, w, h (and line endpoints)
+    FieldColor = 2,
+    FieldText = 4,
+    FieldFontSize = 8,
+};
+
+// Values of the fields in `mask` at one point in time
+struct ObjectState {
+    uint32_t mask = 0;
+    float x = 0, y = 0, w = 0, h = 0;
+    float x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    uint32_t color = 0;
+    std::string text;
+    float fontSize = 0;
+};
+
+inline ObjectState captureState(Object& obj, uint32_t mask) {
+    ObjectState s;
+    s.mask = mask;
+    if (mask & FieldGeometry) {
+        s.x = obj.x; s.y = obj.y; s.w = obj.w; s.h = obj.h;
+        if (auto* line = dynamic_cast<LineObject*>(&obj)) line->getEndpoints(s.x1, s.y1, s.x2, s.y2);
+    }
+    if (mask & FieldColor) s.color = obj.getColor();
+    if (mask & FieldText) s.text = obj.getText();
+    if (mask & FieldFontSize) s.fontSize = obj.getFontSize();
+    return s;
+}
+
+// Text and font size re-measure the bounds, so geometry is applied last
+inline void applyState(Object& obj, const ObjectState& s) {
+    if (s.mask & FieldText) obj.setText(s.text);
+    if (s.mask & FieldFontSize) obj.setFontSize(s.fontSize);
+    if (s.mask & FieldColor) obj.setColor(s.color);
+    if (s.mask & FieldGeometry) {
+        obj.x = s.x; obj.y = s.y; obj.w = s.w; obj.h = s.h;
+        if (auto* line = dynamic_cast<LineObject*>(&obj)) line->setEndpoints(s.x1, s.y1, s.x2, s.y2);
+    }
+}
@@ -5,18 +5,242 @@
 #include <cstdio>
 #include <cmath>
 #include <algorithm>
+#include <functional>
+#include <unordered_map>
 
 void Scene::setFont(const uint8_t* data, int size) {
-    fontDataBlob.assign(data, data + size);
-    Font::GetDefault().load(fontDataBlob.data(), size);
+    auto loaded = std::make_shared<Font>();
+    if (!loaded->load(data, size)) {
+        printf("Error: Could not load font\n");
+        return;
+    }
+    MasterCopies copies;
+    setFont(std::move(loaded), copies);
+}
+
+void Scene::setFont(std::shared_ptr<const Font> loaded, MasterCopies& copies) {
+    font = std::move(loaded);
+    ++version;
+
+    // Text is re-measured in place, so snapshots must not see these objects.
+    // Masters may be shared with the snapshots of other scenes: always copied.
+    for (size_t i = 0; i < objects.size(); ++i) writable(i)->setFont(font);
+    masters = cloneMasters(masters, copies);
+    for (const auto& master : masters) {
+        for (MasterContent* m = master.get(); m; m = m->parent.get()) {
+            for (const auto& obj : m->objects) obj->setFont(font);
+        }
+    }
+}
+
+// Deep copy of layout/master chains, keeping parents shared between layers
+std::vector<std::shared_ptr<MasterContent>>
+Scene::cloneMasters(const std::vector<std::shared_ptr<MasterContent>>& layers, MasterCopies& copies) {
+    std::function<std::shared_ptr<MasterContent>(const std::shared_ptr<MasterContent>&)> copy =
+        [&](const std::shared_ptr<MasterContent>& m) -> std::shared_ptr<MasterContent> {
+        if (!m) return nullptr;
+        auto& slot = copies[m.get()];
+        if (slot) return slot;
+        auto c = std::make_shared<MasterContent>(*m);
+        for (auto& obj : c->objects) obj = obj->clone();
+        c->parent = copy(m->parent);
+        slot = c;
+        return c;
+    };
+
+    std::vector<std::shared_ptr<MasterContent>> out;
+    out.reserve(layers.size());
+    for (const auto& m : layers) out.push_back(copy(m));
+    return out;
+}
+
+bool Scene::snapshotsAlive() {
+    snapshots.erase(std::remove_if(snapshots.begin(), snapshots.end(),
+                                   [](const std::weak_ptr<const SceneSnapshot>& s) { return s.expired(); }),
+                    snapshots.end());
+    return !snapshots.empty();
+}
+
+Object* Scene::writable(size_t index) {
+    std::shared_ptr<Object>& slot = objects[index];
+    if (slot->frozen) {
+        if (snapshotsAlive()) {
+            slot = slot->clone();
+        }
+        slot->frozen = false;
+    }
+    return slot.get();
+}
+
+Object* Scene::editObject(int uid) {
+    int idx = findIndexByUid(uid);
+    if (idx == -1) return nullptr;
+    ++version;
+    return writable(idx);
+}
+
+std::shared_ptr<const SceneSnapshot> Scene::snapshot() {
+    auto snap = std::make_shared<SceneSnapshot>();
+    snap->version = version;
+    snap->smoothImages = smoothImages;
+    snap->objects = objects;
+    snap->masters = masters;
+    for (const auto& obj : objects) obj->frozen = true;
+    snapshots.push_back(snap);
+    return snap;
+}
+
+void Scene::attachFont(Object& obj) {
+    if (font) obj.setFont(font);
+}
+
+void Scene::addObserver(SceneObserver* observer) {
+    if (std::find(observers.begin(), observers.end(), observer) == observers.end()) {
+        observers.push_back(observer);
+    }
+}
+
+void Scene::removeObserver(SceneObserver* observer) {
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void Scene::notifyChanging(Object& obj, uint32_t mask) {
+    for (SceneObserver* o : observers) o->objectChanging(obj, mask);
+}
+
+void Scene::notifyChanged(Object& obj, uint32_t mask) {
+    ++version;
+    for (SceneObserver* o : observers) o->objectChanged(obj, mask);
+}
+
+void Scene::notifySelectionChanged() {
+    for (SceneObserver* o : observers) o->selectionChanged();
 }
 
 int Scene::add(std::shared_ptr<Object> obj) {
-    obj->id = nextUid++; 
+    obj->id = nextUid++;
+    attachFont(*obj);
+    ++version;
     objects.push_back(obj);
+    for (SceneObserver* o : observers) o->objectAdded(objects.back(), (int)objects.size() - 1);
     return obj->id;
 }
 
+void Scene::restore(std::shared_ptr<Object> obj, int index) {
+    nextUid = std::max(nextUid, obj->id + 1);
+    attachFont(*obj);
+    if (index < 0 || index > (int)objects.size()) index = (int)objects.size();
+    ++version;
+    objects.insert(objects.begin() + index, std::move(obj));
+    for (SceneObserver* o : observers) o->objectAdded(objects[index], index);
+}
+
+void Scene::restoreObjects(const std::vector<std::pair<int, std::shared_ptr<Object>>>& items) {
+    if (items.empty()) return;
+
+    std::vector<std::shared_ptr<Object>> merged;
+    merged.reserve(objects.size() + items.size());
+    std::vector<int> placed;
+    placed.reserve(items.size());
+    size_t next = 0;
+    for (const auto& item : items) {
+        while ((int)merged.size() < item.first && next < objects.size()) {
+            merged.push_back(std::move(objects[next++]));
+        }
+        nextUid = std::max(nextUid, item.second->id + 1);
+        attachFont(*item.second);
+        placed.push_back((int)merged.size());
+        merged.push_back(item.second);
+    }
+    while (next < objects.size()) merged.push_back(std::move(objects[next++]));
+    objects.swap(merged);
+    ++version;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        for (SceneObserver* o : observers) o->objectAdded(items[i].second, placed[i]);
+    }
+}
+
+std::vector<std::shared_ptr<Object>> Scene::removeObjects(const std::vector<int>& uids) {
+    std::vector<std::shared_ptr<Object>> removedObjects;
+    if (uids.empty()) return removedObjects;
+
+    std::vector<int> sorted(uids);
+    std::sort(sorted.begin(), sorted.end());
+
+    std::vector<std::pair<std::shared_ptr<Object>, int>> removed;
+    size_t out = 0;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (std::binary_search(sorted.begin(), sorted.end(), objects[i]->id)) {
+            // Index as if removed one at a time, front to back
+            removed.emplace_back(std::move(objects[i]), (int)out);
+        } else {
+            if (out != i) objects[out] = std::move(objects[i]);
+            ++out;
+        }
+    }
+    objects.resize(out);
+    if (!removed.empty()) ++version;
+
+    removedObjects.reserve(removed.size());
+    for (const auto& r : removed) {
+        deselect(r.first->id);
+        for (SceneObserver* o : observers) o->objectRemoved(r.first, r.second);
+        removedObjects.push_back(r.first);
+    }
+    return removedObjects;
+}
+
+void Scene::applyObjectState(int uid, const ObjectState& state) {
+    Object* obj = editObject(uid);
+    if (!obj) return;
+    notifyChanging(*obj, state.mask);
+    applyState(*obj, state);
+    notifyChanged(*obj, state.mask);
+}
+
+void Scene::applyObjectStates(const std::vector<std::pair<int, const ObjectState*>>& states) {
+    if (states.empty()) return;
+    if (states.size() == 1) {
+        applyObjectState(states[0].first, *states[0].second);
+        return;
+    }
+
+    std::unordered_map<int, size_t> indices;
+    indices.reserve(states.size());
+    for (const auto& s : states) indices.emplace(s.first, objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        auto it = indices.find(objects[i]->id);
+        if (it != indices.end()) it->second = i;
+    }
+
+    for (const auto& s : states) {
+        size_t idx = indices[s.first];
+        if (idx == objects.size()) continue;
+        ++version;
+        Object* obj = writable(idx);
+        notifyChanging(*obj, s.second->mask);
+        applyState(*obj, *s.second);
+        notifyChanged(*obj, s.second->mask);
+    }
+}
+
+void Scene::setSmoothImages(bool smooth) {
+    if (smooth == smoothImages) return;
+    smoothImages = smooth;
+    ++version;
+}
+
+void Scene::addMaster(std::shared_ptr<MasterContent> master) {
+    if (!master) return;
+    if (std::find(masters.begin(), masters.end(), master) != masters.end()) return;
+    for (MasterContent* m = master.get(); m; m = m->parent.get()) {
+        for (const auto& obj : m->objects) attachFont(*obj);
+    }
+    ++version;
+    masters.push_back(std::move(master));
+}
+
 int Scene::findIndexByUid(int uid) {
     for (size_t i = 0; i < objects.size(); ++i) {
         if (objects[i]->id == uid) return (int)i;
@@ -30,12 +254,31 @@ Object* Scene::getObject(int uid) {
     return nullptr;
 }
 
-void Scene::render(uint32_t* buffer, int width, int height) {
-    std::fill_n(buffer, width * height, 0xFF252526);
+static void drawContent(Surface surface, bool smoothImages,
+                        const std::vector<std::shared_ptr<MasterContent>>& masters,
+                        const std::vector<std::shared_ptr<Object>>& objects) {
+    surface.smoothImages = smoothImages;
+    std::fill_n(surface.pixels, (size_t)surface.width * surface.rows, 0xFF252526);
+
+    for (const auto& master : masters) {
+        master->draw(surface);
+    }
 
     for (const auto& obj : objects) {
-        obj->draw(buffer, width, height);
+        obj->draw(surface);
     }
+}
+
+void SceneSnapshot::render(const Surface& surface) const {
+    drawContent(surface, smoothImages, masters, objects);
+}
+
+void SceneSnapshot::render(uint32_t* buffer, int width, int height) const {
+    drawContent(Surface(buffer, width, height), smoothImages, masters, objects);
+}
+
+void Scene::render(uint32_t* buffer, int width, int height) {
+    drawContent(Surface(buffer, width, height), smoothImages, masters, objects);
 
     if (selectedUids.empty()) return;
 
@@ -190,26 +433,29 @@ int Scene::pick(int px, int py) {
 // Selection Management
 void Scene::select(int uid, bool addToSelection) {
     if (uid == -1) return;
-    
+
+    // Avoid duplicates
+    bool found = isSelected(uid);
+    if (addToSelection ? found : (found && selectedUids.size() == 1)) return;
+
     if (!addToSelection) {
         selectedUids.clear();
     }
-    
-    // Avoid duplicates
-    bool found = false;
-    for(int id : selectedUids) {
-        if(id == uid) { found = true; break;}
-    }
-    if(!found) selectedUids.push_back(uid);
+    selectedUids.push_back(uid);
+    notifySelectionChanged();
 }
 
 void Scene::deselect(int uid) {
-     auto it = std::remove(selectedUids.begin(), selectedUids.end(), uid);
-     selectedUids.erase(it, selectedUids.end());
+    auto it = std::remove(selectedUids.begin(), selectedUids.end(), uid);
+    if (it == selectedUids.end()) return;
+    selectedUids.erase(it, selectedUids.end());
+    notifySelectionChanged();
 }
 
 void Scene::clearSelection() {
+    if (selectedUids.empty()) return;
     selectedUids.clear();
+    notifySelectionChanged();
 }
 
 bool Scene::isSelected(int uid) {
@@ -226,24 +472,32 @@ int Scene::getPrimarySelection() {
 
 void Scene::moveSelection(float dx, float dy) {
     for (int uid : selectedUids) {
-        Object* obj = getObject(uid);
-        if (obj) obj->move(dx, dy);
+        moveObject(uid, dx, dy);
     }
 }
 
 void Scene::moveObject(int uid, float dx, float dy) {
-    Object* obj = getObject(uid);
-    if (obj) obj->move(dx, dy);
+    Object* obj = editObject(uid);
+    if (!obj) return;
+    notifyChanging(*obj, FieldGeometry);
+    obj->move(dx, dy);
+    notifyChanged(*obj, FieldGeometry);
 }
 
 void Scene::updateObjectRect(int uid, float nx, float ny, float nw, float nh) {
-    Object* obj = getObject(uid);
-    if (obj) obj->setRect(nx, ny, nw, nh);
+    Object* obj = editObject(uid);
+    if (!obj) return;
+    notifyChanging(*obj, FieldGeometry);
+    obj->setRect(nx, ny, nw, nh);
+    notifyChanged(*obj, FieldGeometry);
 }
 
 void Scene::updateObjectColor(int uid, uint32_t col) {
-    Object* obj = getObject(uid);
-    if (obj) obj->setColor(col);
+    Object* obj = editObject(uid);
+    if (!obj) return;
+    notifyChanging(*obj, FieldColor);
+    obj->setColor(col);
+    notifyChanged(*obj, FieldColor);
 }
 
 uint32_t Scene::getObjectColor(int uid) {
@@ -252,19 +506,19 @@ uint32_t Scene::getObjectColor(int uid) {
     return 0;
 }
 
-const char* Scene::getObjectText(int uid) {
+std::string Scene::getObjectText(int uid) {
     Object* obj = getObject(uid);
-    if (obj) {
-        static std::string lastText; 
-        lastText = obj->getText();
-        return lastText.c_str();
-    }
+    if (obj) return obj->getText();
     return "";
 }
 
 void Scene::updateObjectText(int uid, const char* text) {
-    Object* obj = getObject(uid);
-    if (obj) obj->setText(text);
+    Object* obj = editObject(uid);
+    if (!obj) return;
+    // Text objects re-measure their bounds
+    notifyChanging(*obj, FieldText | FieldGeometry);
+    obj->setText(text);
+    notifyChanged(*obj, FieldText | FieldGeometry);
 }
 
 float Scene::getObjectFontSize(int uid) {
@@ -274,8 +528,11 @@ float Scene::getObjectFontSize(int uid) {
 }
 
 void Scene::updateObjectFontSize(int uid, float size) {
-    Object* obj = getObject(uid);
-    if (obj) obj->setFontSize(size);
+    Object* obj = editObject(uid);
+    if (!obj) return;
+    notifyChanging(*obj, FieldFontSize | FieldGeometry);
+    obj->setFontSize(size);
+    notifyChanged(*obj, FieldFontSize | FieldGeometry);
 }
 
 int Scene::getObjectCount() const { return (int)objects.size(); }
@@ -296,9 +553,7 @@ const char* Scene::getObjectName(int index) const {
 
 int Scene::getObjectType(int index) const {
     if (index >= 0 && index < (int)objects.size()) {
-        if (std::dynamic_pointer_cast<TextObject>(objects[index])) return 1;
-        if (std::dynamic_pointer_cast<ImageObject>(objects[index])) return 2;
-        return 0; 
+        return objects[index]->getType();
     }
     return -1;
 }
@@ -306,13 +561,35 @@ int Scene::getObjectType(int index) const {
 void Scene::removeObject(int uid) {
     int idx = findIndexByUid(uid);
     if (idx != -1) {
+        std::shared_ptr<Object> removed = objects[idx];
         objects.erase(objects.begin() + idx);
+        ++version;
         deselect(uid);
+        for (SceneObserver* o : observers) o->objectRemoved(removed, idx);
+    }
+}
+
+void Scene::reorderObject(int uid, int index) {
+    int from = findIndexByUid(uid);
+    if (from == -1) return;
+    index = std::max(0, std::min(index, (int)objects.size() - 1));
+    if (index == from) return;
+
+    std::shared_ptr<Object> obj = objects[from];
+    if (from < index) {
+        std::rotate(objects.begin() + from, objects.begin() + from + 1, objects.begin() + index + 1);
+    } else {
+        std::rotate(objects.begin() + index, objects.begin() + from, objects.begin() + from + 1);
     }
+    ++version;
+    for (SceneObserver* o : observers) o->objectReordered(obj, from, index);
 }
 
 void Scene::clear() {
     objects.clear();
+    masters.clear();
     nextUid = 1;
-    clearSelection();
+    ++version;
+    selectedUids.clear(); // sceneCleared covers the selection
+    for (SceneObserver* o : observers) o->sceneCleared();
 }
@@ -1,23 +1,76 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <string>
 #include <algorithm>
+#include <unordered_map>
 #include "object.hpp"
 #include "font.hpp"
+#include "master.hpp"
+#include "object_state.hpp"
+#include "scene_observer.hpp"
+#include "scene_snapshot.hpp"
 
 class Scene {
+public:
+    // Copies of masters made while changing fonts, by original
+    using MasterCopies = std::unordered_map<const MasterContent*, std::shared_ptr<MasterContent>>;
+
 private:
     int nextUid = 1;
+    uint64_t version = 0;
+    std::vector<SceneObserver*> observers;
+    std::vector<std::weak_ptr<const SceneSnapshot>> snapshots;
+
+    void notifyChanging(Object& obj, uint32_t mask);
+    void notifyChanged(Object& obj, uint32_t mask);
+    void notifySelectionChanged();
+    void attachFont(Object& obj);
+    bool snapshotsAlive();
+    // The object at `index`, cloned first if a live snapshot shares it
+    Object* writable(size_t index);
+    static std::vector<std::shared_ptr<MasterContent>>
+    cloneMasters(const std::vector<std::shared_ptr<MasterContent>>& layers, MasterCopies& copies);
 
 public:
     std::vector<std::shared_ptr<Object>> objects;
-    std::vector<uint8_t> fontDataBlob; 
+    std::shared_ptr<const Font> font; // given to every text object added
+    bool smoothImages = true;         // bilinear picture sampling
     std::vector<int> selectedUids; // Changed to vector to maintain order if needed, or use set
+    // Shared layout/master content drawn beneath the objects; not pickable
+    std::vector<std::shared_ptr<MasterContent>> masters;
+
+    void addObserver(SceneObserver* observer);
+    void removeObserver(SceneObserver* observer);
 
     void setFont(const uint8_t* data, int size);
+    // Shares an already loaded font. Masters are replaced by copies taken
+    // from `copies`, so scenes sharing a layout go on sharing one copy.
+    void setFont(std::shared_ptr<const Font> font, MasterCopies& copies);
+    void setSmoothImages(bool smooth);
     int add(std::shared_ptr<Object> obj);
+    // Inserts keeping obj->id (documents, journal replay); -1 appends
+    void restore(std::shared_ptr<Object> obj, int index = -1);
+    // Batch forms for undo/redo: one pass over the draw order each.
+    // `items` are (final index, object) pairs in ascending index order.
+    void restoreObjects(const std::vector<std::pair<int, std::shared_ptr<Object>>>& items);
+    // Returns the removed objects in draw order
+    std::vector<std::shared_ptr<Object>> removeObjects(const std::vector<int>& uids);
+    // Sets the fields of `state` and notifies observers
+    void applyObjectState(int uid, const ObjectState& state);
+    // Batch form: (uid, state) pairs applied in order, finding every
+    // object with one pass over the draw order
+    void applyObjectStates(const std::vector<std::pair<int, const ObjectState*>>& states);
+    void addMaster(std::shared_ptr<MasterContent> master);
     int findIndexByUid(int uid);
     Object* getObject(int uid);
+    // For changing the object without notifying observers (replay);
+    // safe with snapshots, unlike writing through getObject()
+    Object* editObject(int uid);
+
+    // Bumped by every change to the content (not the selection)
+    uint64_t getVersion() const { return version; }
+    std::shared_ptr<const SceneSnapshot> snapshot();
     void render(uint32_t* buffer, int width, int height);
     void drawSelectionOutline(uint32_t* buffer, int w, int h, Object* obj);
     int pickHandle(int px, int py);
@@ -36,7 +89,7 @@ public:
     void updateObjectRect(int uid, float nx, float ny, float nw, float nh);
     void updateObjectColor(int uid, uint32_t col);
     uint32_t getObjectColor(int uid);
-    const char* getObjectText(int uid);
+    std::string getObjectText(int uid);
     void updateObjectText(int uid, const char* text);
     float getObjectFontSize(int uid);
     void updateObjectFontSize(int uid, float size);
@@ -46,5 +99,7 @@ public:
     const char* getObjectName(int index) const;
     int getObjectType(int index) const;
     void removeObject(int uid);
+    // Moves the object to `index` in the draw order (0 is the back)
+    void reorderObject(int uid, int index);
     void clear();
 };
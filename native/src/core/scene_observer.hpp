@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "object.hpp"
+
+// Receives every mutation made through the Scene API.
+// `index` is the position of the object in the draw order.
+class SceneObserver {
+public:
+    virtual ~SceneObserver() = default;
+
+    virtual void objectAdded(const std::shared_ptr<Object>& /*obj*/, int /*index*/) {}
+    virtual void objectRemoved(const std::shared_ptr<Object>& /*obj*/, int /*index*/) {}
+    // Called before and after the fields in `mask` (ObjectField) change
+    virtual void objectChanging(Object& /*obj*/, uint32_t /*mask*/) {}
+    virtual void objectChanged(Object& /*obj*/, uint32_t /*mask*/) {}
+    // The object moved from `from` to `to` in the draw order
+    virtual void objectReordered(const std::shared_ptr<Object>& /*obj*/, int /*from*/, int /*to*/) {}
+    virtual void selectionChanged() {}
+    // Everything was dropped (init, import, open)
+    virtual void sceneCleared() {}
+};
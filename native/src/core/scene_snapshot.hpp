@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "object.hpp"
+#include "master.hpp"
+#include "surface.hpp"
+
+// A frozen version of a Scene. It shares the objects that were current
+// when it was taken; the Scene clones an object before changing it while
+// a snapshot holds it, so a snapshot can be rendered on any thread without
+// locking while editing goes on.
+struct SceneSnapshot {
+    uint64_t version = 0;
+    bool smoothImages = true;
+    std::vector<std::shared_ptr<Object>> objects;          // never modified
+    std::vector<std::shared_ptr<MasterContent>> masters;   // never modified
+
+    void render(uint32_t* buffer, int width, int height) const;
+    // Only the rows of `surface`; the pixels match the same rows of a
+    // full render
+    void render(const Surface& surface) const;
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Pixels being drawn into: rows [top, top + rows) of a width x height
+// canvas. Objects draw in canvas coordinates and clip to the rows present,
+// so a canvas too large for memory can be rendered a strip at a time.
+struct Surface {
+    uint32_t* pixels;   // canvas row `top`
+    int width;          // also the row stride
+    int height;
+    int top = 0;
+    int rows;
+    // Pictures are sampled bilinearly rather than nearest-neighbor
+    bool smoothImages = true;
+
+    Surface(uint32_t* pixels, int width, int height)
+        : pixels(pixels), width(width), height(height), rows(height) {}
+    Surface(uint32_t* pixels, int width, int height, int top, int rows)
+        : pixels(pixels), width(width), height(height), top(top), rows(rows) {}
+
+    int bottom() const { return top + rows; }
+    uint32_t* row(int y) const { return pixels + (size_t)(y - top) * width; }
+};
@@ -0,0 +1,149 @@
+#include "thumbnail.hpp"
+#include "scene_snapshot.hpp"
+#include "../objects/line_object.hpp"
+#include "../objects/text_object.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Text too small to read: a bar over the x-height of each word, at half
+// the text's opacity, which is about what its glyphs would average to
+class GreekedText : public SceneObject {
+public:
+    uint32_t color;
+    int top, bottom;                            // rows covered
+    std::vector<std::pair<int, int>> words;     // [x0, x1) in pixels
+
+    GreekedText(uint32_t color, int top, int bottom)
+        : SceneObject(0, "Text", 0, 0, 0, 0), color(color), top(top), bottom(bottom) {}
+
+    std::shared_ptr<SceneObject> clone() const override { return std::make_shared<GreekedText>(*this); }
+
+    void draw(const Surface& surface) const override {
+        int y0 = std::max(top, surface.top);
+        int y1 = std::min(bottom, surface.bottom());
+        for (int py = y0; py < y1; ++py) {
+            uint32_t* row = surface.row(py);
+            for (const auto& word : words) {
+                int x1 = std::min(word.second, surface.width);
+                for (int px = std::max(word.first, 0); px < x1; ++px) {
+                    row[px] = blendColor(row[px], color);
+                }
+            }
+        }
+    }
+};
+
+static std::shared_ptr<SceneObject> greek(const TextObject& text, float scale) {
+    if (!text.font) return nullptr;   // would not draw either
+    const Font& face = *text.font;
+    float sc = stbtt_ScaleForPixelHeight(&face.info, text.fontSize);
+
+    int top = (int)((text.y + text.h * 0.35f) * scale);
+    int bottom = std::max(top + 1, (int)((text.y + text.h * 0.8f) * scale));
+    uint32_t alpha = (text.color >> 24) / 2;
+    auto bars = std::make_shared<GreekedText>((alpha << 24) | (text.color & 0x00FFFFFF), top, bottom);
+
+    // Same advances as TextObject::draw
+    int cursor = 0;
+    int start = -1;
+    auto addWord = [&](int end) {
+        int x0 = (int)((text.x + start) * scale);
+        int x1 = std::max(x0 + 1, (int)((text.x + end) * scale));
+        if (!bars->words.empty() && bars->words.back().second >= x0) {
+            bars->words.back().second = x1;
+        } else {
+            bars->words.emplace_back(x0, x1);
+        }
+    };
+    for (char c : text.text) {
+        bool blank = c == ' ' || c == '\t';
+        if (!blank && start < 0) start = cursor;
+        if (blank && start >= 0) {
+            addWord(cursor);
+            start = -1;
+        }
+        int adv, lsb;
+        stbtt_GetCodepointHMetrics(&face.info, c, &adv, &lsb);
+        cursor += (int)(adv * sc);
+    }
+    if (start >= 0) addWord(cursor);
+    return bars;
+}
+
+static std::shared_ptr<SceneObject> scaleObject(const SceneObject& obj, float scale) {
+    if (auto* text = dynamic_cast<const TextObject*>(&obj)) {
+        if (text->fontSize * scale < ThumbnailCache::kGreekPixels) return greek(*text, scale);
+        auto copy = std::make_shared<TextObject>(*text);
+        copy->x = text->x * scale;
+        copy->y = text->y * scale;
+        copy->setFontSize(text->fontSize * scale);
+        return copy;
+    }
+    if (auto* line = dynamic_cast<const LineObject*>(&obj)) {
+        float x1, y1, x2, y2;
+        line->getEndpoints(x1, y1, x2, y2);
+        int thickness = std::max(1, (int)std::lround(line->thickness * scale));
+        return std::make_shared<LineObject>(0, x1 * scale, y1 * scale, x2 * scale, y2 * scale,
+                                            line->color, thickness);
+    }
+
+    // Pictures pick their mip level from the scaled size
+    std::shared_ptr<SceneObject> copy = obj.clone();
+    copy->setRect(obj.x * scale, obj.y * scale, obj.w * scale, obj.h * scale);
+    return copy;
+}
+
+static std::shared_ptr<MasterContent> scaleMaster(const MasterContent& master, float scale) {
+    auto copy = std::make_shared<MasterContent>();
+    if (master.parent) copy->parent = scaleMaster(*master.parent, scale);
+    copy->showParentShapes = master.showParentShapes;
+    copy->hasBackground = master.hasBackground;
+    copy->background = master.background;
+    copy->width = (int)std::ceil(master.width * scale);
+    copy->height = (int)std::ceil(master.height * scale);
+    for (const auto& obj : master.objects) {
+        if (auto scaled = scaleObject(*obj, scale)) copy->objects.push_back(std::move(scaled));
+    }
+    return copy;
+}
+
+void ThumbnailCache::render(const SceneSnapshot& page, float scale, uint32_t* buffer, int width, int height) {
+    SceneSnapshot scaled;
+    scaled.version = page.version;
+    scaled.smoothImages = page.smoothImages;
+    for (const auto& master : page.masters) scaled.masters.push_back(scaleMaster(*master, scale));
+    for (const auto& obj : page.objects) {
+        if (auto copy = scaleObject(*obj, scale)) scaled.objects.push_back(std::move(copy));
+    }
+    scaled.render(buffer, width, height);
+}
+
+bool ThumbnailCache::lookup(const Page& page, uint64_t version, uint32_t* buffer, int width, int height) const {
+    auto it = entries.find(&page);
+    if (it == entries.end()) return false;
+    const Entry& entry = it->second;
+    if (entry.version != version || entry.width != width || entry.height != height) return false;
+    memcpy(buffer, entry.pixels.data(), entry.pixels.size() * sizeof(uint32_t));
+    return true;
+}
+
+void ThumbnailCache::store(const Page& page, uint64_t version, uint64_t since,
+                           const uint32_t* buffer, int width, int height) {
+    if (since != generation) return;
+    Entry& entry = entries[&page];
+    entry.version = version;
+    entry.width = width;
+    entry.height = height;
+    entry.pixels.assign(buffer, buffer + (size_t)width * height);
+}
+
+void ThumbnailCache::clear() {
+    entries.clear();
+    ++generation;
+}
+
+void ThumbnailCache::pageRemoved(Page& page) {
+    entries.erase(&page);
+    ++generation;
+}
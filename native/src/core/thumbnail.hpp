@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "document.hpp"
+
+struct SceneSnapshot;
+class MasterContent;
+class SceneObject;
+
+// Small page previews, rendered directly at their final size.
+//
+// The page is drawn from scaled copies of its objects, with two shortcuts
+// that a full render followed by scaling cannot take: text smaller than
+// kGreekPixels becomes bars where its words are, and pictures are drawn
+// from the mip level of their preview size. Rendered previews are kept per
+// page and version, so a sidebar redraw only renders the pages that
+// changed.
+class ThumbnailCache : public DocumentObserver {
+public:
+    // Text whose size would fall below this many pixels is greeked
+    static constexpr float kGreekPixels = 4.0f;
+
+    // Copies the preview of `page` at `version` into `buffer`, if cached
+    bool lookup(const Page& page, uint64_t version, uint32_t* buffer, int width, int height) const;
+    // Keeps a rendered preview; `since` is getGeneration() from before
+    // the render, so previews of pages removed meanwhile are dropped
+    void store(const Page& page, uint64_t version, uint64_t since,
+               const uint32_t* buffer, int width, int height);
+    uint64_t getGeneration() const { return generation; }
+    void clear();
+
+    // Draws `page` scaled by `scale` into width x height pixels. Needs no
+    // lock: it only reads the snapshot.
+    static void render(const SceneSnapshot& page, float scale, uint32_t* buffer, int width, int height);
+
+    void pageRemoved(Page& page) override;
+
+private:
+    struct Entry {
+        uint64_t version = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> pixels;
+    };
+
+    std::map<const Page*, Entry> entries;
+    uint64_t generation = 0;
+};
@@ -11,3 +11,10 @@ inline uint32_t blendColor(uint32_t bg, uint32_t fg) {
     int b = (((fg) & 0xFF) * a + ((bg) & 0xFF) * invA) >> 8;
     return 0xFF000000 | (r << 16) | (g << 8) | b;
 }
+
+// a + (b - a) * f / 256 per channel, f in [0, 256); two channels at a time
+inline uint32_t lerpColor(uint32_t a, uint32_t b, uint32_t f) {
+    uint32_t rb = ((a & 0x00FF00FF) * (256 - f) + (b & 0x00FF00FF) * f) >> 8;
+    uint32_t ag = ((a >> 8) & 0x00FF00FF) * (256 - f) + ((b >> 8) & 0x00FF00FF) * f;
+    return (rb & 0x00FF00FF) | (ag & 0xFF00FF00);
+}
@@ -1,548 +1,801 @@
 #define STB_TRUETYPE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 #include "engine.h"
-#include "core/scene.hpp"
+#include "core/document.hpp"
+#include "core/thumbnail.hpp"
+#include "core/image_cache.hpp"
 #include "objects/rect_object.hpp"
 #include "objects/text_object.hpp"
 #include "objects/image_object.hpp"
 #include "objects/ellipse_object.hpp"
 #include "objects/line_object.hpp"
+#include "import/pptx_importer.hpp"
+#include "io/document_file.hpp"
+#include "io/deck_cache.hpp"
+#include "io/journal.hpp"
+#include "io/command_batch.hpp"
+#include "io/image_export.hpp"
+#include "io/pdf_writer.hpp"
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
-#include <iostream>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <sstream>
-#include <map>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 // Native dependencies
-#include "zip.h"
-#include "tinyxml2.h"
 #include "../deps/stb_image.h"
 
-using namespace tinyxml2;
+// Everything one document needs; instances share nothing, and each call
+// holds the instance lock, so different instances can be used from
+// different threads at the same time.
+struct EngineInstance {
+    std::mutex mutex;
+    Document document;
+    DeckCache deckCache;
+    Journal journal;
+    ThumbnailCache thumbnails;
+    float maxImageDpi = 0;     // import picture cap, 0 for none
+    bool keepImageOriginals = true;
+    std::string text; // backs engine_get_object_text() until the next call
+    std::string name; // backs engine_get_object_name() until the next call
 
-Scene g_scene;
+    EngineInstance() { document.addObserver(&thumbnails); }
 
-// Helper to convert EMU (English Metric Units) to pixels
-// 1 inch = 914400 EMUs. 
-// Assuming 96 DPI for simplicity: 1 pixel = 914400 / 96 = 9525 EMUs
-float emuToPixel(long long emu) {
-    return (float)emu / 9525.0f;
+    // The active page, which every call but the page calls acts on
+    Scene& scene() { return document.active().scene; }
+    History& history() { return document.active().history; }
+    EventQueue& events() { return document.active().events; }
+};
+
+struct EngineSnapshot {
+    std::shared_ptr<const SceneSnapshot> scene;
+};
+
+EngineInstance* engine_create(void) {
+    return new EngineInstance();
 }
 
-// Parse color from PPTX XML (handles srgbClr, schemeClr with basic mapping)
-uint32_t parseColor(XMLElement* parent, uint32_t defaultColor = 0xFFCCCCCC) {
-    if (!parent) return defaultColor;
-    
-    // Direct RGB color
-    XMLElement* srgbClr = parent->FirstChildElement("a:srgbClr");
-    if (srgbClr) {
-        const char* val = srgbClr->Attribute("val");
-        if (val) {
-            uint32_t rgb = (uint32_t)strtol(val, NULL, 16);
-            return 0xFF000000 | rgb;
-        }
-    }
-    
-    // Scheme color (basic mapping)
-    XMLElement* schemeClr = parent->FirstChildElement("a:schemeClr");
-    if (schemeClr) {
-        const char* val = schemeClr->Attribute("val");
-        if (val) {
-            std::string scheme = val;
-            // Basic theme color mapping
-            if (scheme == "tx1" || scheme == "dk1") return 0xFF000000;
-            if (scheme == "tx2" || scheme == "dk2") return 0xFF444444;
-            if (scheme == "bg1" || scheme == "lt1") return 0xFFFFFFFF;
-            if (scheme == "bg2" || scheme == "lt2") return 0xFFEEEEEE;
-            if (scheme == "accent1") return 0xFF4472C4;
-            if (scheme == "accent2") return 0xFFED7D31;
-            if (scheme == "accent3") return 0xFFA5A5A5;
-            if (scheme == "accent4") return 0xFFFFC000;
-            if (scheme == "accent5") return 0xFF5B9BD5;
-            if (scheme == "accent6") return 0xFF70AD47;
-        }
+void engine_destroy(EngineInstance* engine) {
+    delete engine;
+}
+
+void engine_h_init(EngineInstance* engine, int32_t width, int32_t height) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->document.reset(1);
+    engine->document.setPageSize(width, height);
+}
+
+void engine_h_import_pptx(EngineInstance* engine, const char* filepath) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (engine->deckCache.load(engine->document, filepath)) {
+        printf("PPTX loaded from cache: %zu slides\n", engine->document.pageCount());
+        return;
     }
-    
-    return defaultColor;
-}
-
-// Detect shape type from preset geometry
-std::string detectShapeType(XMLElement* spPr) {
-    if (!spPr) return "rect";
-    
-    XMLElement* prstGeom = spPr->FirstChildElement("a:prstGeom");
-    if (prstGeom) {
-        const char* prst = prstGeom->Attribute("prst");
-        if (prst) {
-            std::string preset = prst;
-            if (preset == "ellipse" || preset == "oval") return "ellipse";
-            if (preset == "line") return "line";
-            if (preset == "roundRect") return "roundRect";
-            if (preset == "triangle" || preset == "rtTriangle") return "triangle";
-            // More presets can be added
-            return preset;
-        }
+    PptxImporter importer(engine->document);
+    importer.setMaxImageDpi(engine->maxImageDpi, engine->keepImageOriginals);
+    if (importer.import(filepath)) {
+        engine->deckCache.store(engine->document, filepath);
     }
-    
-    return "rect"; // Default
 }
 
-void engine_init(int32_t, int32_t) {
-    g_scene.clear();
+void engine_h_set_cache_directory(EngineInstance* engine, const char* directory, int64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->deckCache.configure(directory, maxBytes > 0 ? (uint64_t)maxBytes : 0);
 }
 
-// Cache for loaded images from PPTX
-std::map<std::string, std::vector<uint32_t>> g_imageCache;
-std::map<std::string, std::pair<int, int>> g_imageSizes;
+void engine_h_set_import_image_dpi(EngineInstance* engine, float dpi, bool keepOriginals) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->maxImageDpi = dpi > 0 ? dpi : 0;
+    engine->keepImageOriginals = keepOriginals;
+    // The cap changes the pixels a cache entry stores, and whether capped
+    // pictures keep their originals changes the files it stores
+    uint32_t bits;
+    memcpy(&bits, &engine->maxImageDpi, sizeof(bits));
+    engine->deckCache.setImportSettings(bits | (uint64_t)keepOriginals << 32);
+}
 
-// Helper to extract and decode image from PPTX
-bool loadImageFromPptx(struct zip_t* zip, const std::string& imagePath, 
-                       std::vector<uint32_t>& outPixels, int& outW, int& outH) {
-    // Check cache first
-    if (g_imageCache.find(imagePath) != g_imageCache.end()) {
-        outPixels = g_imageCache[imagePath];
-        auto& sz = g_imageSizes[imagePath];
-        outW = sz.first;
-        outH = sz.second;
-        return true;
-    }
+bool engine_h_save_document(EngineInstance* engine, const char* filepath) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return saveDocument(engine->document, filepath);
+}
 
-    if (zip_entry_open(zip, imagePath.c_str()) < 0) {
-        return false;
-    }
+bool engine_h_open_document(EngineInstance* engine, const char* filepath) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return openDocument(engine->document, filepath);
+}
 
-    void* imgData = NULL;
-    size_t imgSize = 0;
-    
-    if (zip_entry_read(zip, &imgData, &imgSize) < 0) {
-        zip_entry_close(zip);
-        return false;
-    }
-    zip_entry_close(zip);
+bool engine_h_journal_open(EngineInstance* engine, const char* filepath) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->journal.open(engine->document, filepath);
+}
+
+bool engine_h_journal_flush(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->journal.flush();
+}
+
+bool engine_h_journal_checkpoint(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->journal.checkpoint();
+}
+
+void engine_h_journal_close(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->journal.close();
+}
+
+bool engine_h_journal_recover(EngineInstance* engine, const char* filepath) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return Journal::recover(engine->document, filepath);
+}
+
+static_assert(sizeof(EngineEvent) == sizeof(SceneEvent), "EngineEvent layout");
+static_assert(ENGINE_EVENT_RESET == EventSceneReset && ENGINE_FIELD_FONT_SIZE == FieldFontSize,
+              "event constants");
+
+int32_t engine_h_poll_events(EngineInstance* engine, EngineEvent* buffer, int32_t capacity) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (!buffer || capacity <= 0) return 0;
+    return (int32_t)engine->events().poll((SceneEvent*)buffer, (size_t)capacity);
+}
+
+void engine_h_begin_transaction(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->history().begin();
+}
+
+void engine_h_commit(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->history().commit();
+}
+
+bool engine_h_undo(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->history().undo();
+}
+
+bool engine_h_redo(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->history().redo();
+}
+
+bool engine_h_can_undo(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->history().canUndo();
+}
+
+bool engine_h_can_redo(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->history().canRedo();
+}
+
+void engine_h_set_history_limit(EngineInstance* engine, int64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->history().setLimit(maxBytes > 0 ? (size_t)maxBytes : 0);
+}
+
+void engine_h_render(EngineInstance* engine, uint32_t* buffer, int32_t width, int32_t height) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().render(buffer, width, height);
+}
+
+EngineSnapshot* engine_h_snapshot(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return new EngineSnapshot{engine->scene().snapshot()};
+}
+
+uint64_t engine_snapshot_version(const EngineSnapshot* snapshot) {
+    return snapshot ? snapshot->scene->version : 0;
+}
 
-    // Decode image using stb_image
-    int w, h, channels;
-    unsigned char* pixels = stbi_load_from_memory(
-        (const unsigned char*)imgData, (int)imgSize,
-        &w, &h, &channels, 4); // Force RGBA
+void engine_render_snapshot(const EngineSnapshot* snapshot, uint32_t* buffer, int32_t width, int32_t height) {
+    if (snapshot) snapshot->scene->render(buffer, width, height);
+}
+
+void engine_render_snapshot_rows(const EngineSnapshot* snapshot, uint32_t* buffer, int32_t width, int32_t height,
+                                 int32_t top, int32_t rows) {
+    if (!snapshot || top < 0 || rows <= 0 || top + (int64_t)rows > height) return;
+    snapshot->scene->render(Surface(buffer, width, height, top, rows));
+}
 
-    free(imgData);
+void engine_release_snapshot(EngineSnapshot* snapshot) {
+    delete snapshot;
+}
 
-    if (!pixels) {
-        return false;
+bool engine_h_export_png(EngineInstance* engine, const char* path, int32_t width, int32_t height, int32_t level) {
+    if (!path || width <= 0 || height <= 0) return false;
+    std::shared_ptr<const SceneSnapshot> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(engine->mutex);
+        snapshot = engine->scene().snapshot();
     }
+    return exportPng(*snapshot, path, width, height, level);
+}
 
-    // Convert RGBA to BGRA (Windows bitmap format)
-    outPixels.resize(w * h);
-    for (int i = 0; i < w * h; i++) {
-        unsigned char r = pixels[i * 4 + 0];
-        unsigned char g = pixels[i * 4 + 1];
-        unsigned char b = pixels[i * 4 + 2];
-        unsigned char a = pixels[i * 4 + 3];
-        outPixels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+bool engine_h_export_pdf(EngineInstance* engine, const char* path, int32_t width, int32_t height) {
+    if (!path || width <= 0 || height <= 0) return false;
+    // Every page, as it is at the time of the call
+    std::vector<std::shared_ptr<const SceneSnapshot>> pages;
+    {
+        std::lock_guard<std::mutex> lock(engine->mutex);
+        for (size_t i = 0; i < engine->document.pageCount(); ++i) {
+            pages.push_back(engine->document.page(i).scene.snapshot());
+        }
+    }
+    PdfWriter writer;
+    if (!writer.open(path)) return false;
+    for (const auto& page : pages) {
+        if (!writer.writePage(*page, width, height)) break;
     }
+    return writer.close();
+}
+
+int32_t engine_h_get_page_count(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return (int32_t)engine->document.pageCount();
+}
+
+int32_t engine_h_get_active_page(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return (int32_t)engine->document.getActiveIndex();
+}
+
+bool engine_h_set_active_page(EngineInstance* engine, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return index >= 0 && engine->document.setActivePage((size_t)index);
+}
 
-    stbi_image_free(pixels);
+int32_t engine_h_add_page(EngineInstance* engine, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    size_t at = index < 0 ? engine->document.pageCount() : (size_t)index;
+    return (int32_t)engine->document.insertPage(at);
+}
 
-    outW = w;
-    outH = h;
+int32_t engine_h_duplicate_page(EngineInstance* engine, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return index < 0 ? -1 : engine->document.duplicatePage((size_t)index);
+}
 
-    // Cache for later use
-    g_imageCache[imagePath] = outPixels;
-    g_imageSizes[imagePath] = {w, h};
+bool engine_h_remove_page(EngineInstance* engine, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return index >= 0 && engine->document.removePage((size_t)index);
+}
 
-    return true;
+bool engine_h_move_page(EngineInstance* engine, int32_t from, int32_t to) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return from >= 0 && to >= 0 && engine->document.movePage((size_t)from, (size_t)to);
 }
 
-// Parse relationship file to get image references
-std::map<std::string, std::string> parseRelationships(struct zip_t* zip, int slideNum) {
-    std::map<std::string, std::string> rels;
-    
-    std::ostringstream relPath;
-    relPath << "ppt/slides/_rels/slide" << slideNum << ".xml.rels";
-    
-    if (zip_entry_open(zip, relPath.str().c_str()) < 0) {
-        return rels;
+void engine_h_render_page(EngineInstance* engine, int32_t index, uint32_t* buffer, int32_t width, int32_t height) {
+    std::shared_ptr<const SceneSnapshot> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(engine->mutex);
+        if (index < 0 || (size_t)index >= engine->document.pageCount()) return;
+        snapshot = engine->document.page((size_t)index).scene.snapshot();
     }
+    snapshot->render(buffer, width, height);
+}
+
+void engine_h_set_image_smoothing(EngineInstance* engine, bool enabled) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->document.setSmoothImages(enabled);
+}
+
+void engine_set_image_cache_budget(int64_t maxBytes) {
+    ImageCache::shared().setBudget(maxBytes > 0 ? (size_t)maxBytes : 0);
+}
 
-    void* relData = NULL;
-    size_t relSize = 0;
-    
-    if (zip_entry_read(zip, &relData, &relSize) < 0) {
-        zip_entry_close(zip);
-        return rels;
+void engine_h_trim_memory(EngineInstance* engine, int32_t level) {
+    ImageCache::shared().trim(level);
+    if (level >= ENGINE_TRIM_COMPLETE) {
+        std::lock_guard<std::mutex> lock(engine->mutex);
+        engine->thumbnails.clear();
     }
-    zip_entry_close(zip);
-
-    XMLDocument doc;
-    if (doc.Parse((const char*)relData, relSize) == XML_SUCCESS) {
-        XMLElement* root = doc.FirstChildElement("Relationships");
-        if (root) {
-            for (XMLElement* rel = root->FirstChildElement("Relationship"); 
-                 rel; 
-                 rel = rel->NextSiblingElement("Relationship")) {
-                const char* id = rel->Attribute("Id");
-                const char* target = rel->Attribute("Target");
-                if (id && target) {
-                    std::string targetStr = target;
-                    // Convert relative path to absolute
-                    if (targetStr.find("../") == 0) {
-                        targetStr = "ppt/" + targetStr.substr(3);
-                    }
-                    rels[id] = targetStr;
-                }
-            }
-        }
+#ifdef __GLIBC__
+    // Freed pixel buffers below the mmap threshold stay in the heap otherwise
+    malloc_trim(0);
+#endif
+}
+
+void engine_h_render_thumbnail(EngineInstance* engine, int32_t index, uint32_t* buffer, int32_t width, int32_t height) {
+    if (!buffer || width <= 0 || height <= 0) return;
+    Page* page;
+    std::shared_ptr<const SceneSnapshot> snapshot;
+    uint64_t generation;
+    float scale;
+    {
+        std::lock_guard<std::mutex> lock(engine->mutex);
+        if (index < 0 || (size_t)index >= engine->document.pageCount()) return;
+        page = &engine->document.page((size_t)index);
+        if (engine->thumbnails.lookup(*page, page->scene.getVersion(), buffer, width, height)) return;
+        snapshot = page->scene.snapshot();
+        generation = engine->thumbnails.getGeneration();
+        scale = std::min((float)width / engine->document.getPageWidth(),
+                         (float)height / engine->document.getPageHeight());
     }
+    ThumbnailCache::render(*snapshot, scale, buffer, width, height);
 
-    free(relData);
-    return rels;
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->thumbnails.store(*page, snapshot->version, generation, buffer, width, height);
 }
 
-void engine_import_pptx(const char* filepath) {
-    struct zip_t* zip = zip_open(filepath, 0, 'r');
-    if (!zip) {
-        printf("Error: Could not open PPTX (ZIP) file: %s\n", filepath);
-        return;
+int32_t engine_h_add_rect(EngineInstance* engine, float x, float y, float w, float h, uint32_t color) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().add(std::make_shared<RectangleObject>(0, x, y, w, h, color));
+}
+
+int32_t engine_h_add_ellipse(EngineInstance* engine, float x, float y, float w, float h, uint32_t color) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().add(std::make_shared<EllipseObject>(0, x, y, w, h, color));
+}
+
+int32_t engine_h_add_line(EngineInstance* engine, float x1, float y1, float x2, float y2, uint32_t color, float thickness) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().add(std::make_shared<LineObject>(0, x1, y1, x2, y2, color, thickness));
+}
+
+void engine_h_load_font(EngineInstance* engine, const uint8_t* data, int32_t length) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->document.setFont(data, length);
+}
+
+int32_t engine_h_add_text(EngineInstance* engine, float x, float y, const char* text, uint32_t color, float size) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().add(std::make_shared<TextObject>(0, x, y, text, color, size));
+}
+
+int32_t engine_h_add_image(EngineInstance* engine, float x, float y, float w, float h, const uint32_t* pixels, int32_t imgW, int32_t imgH) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().add(std::make_shared<ImageObject>(0, x, y, w, h, pixels, imgW, imgH));
+}
+
+int32_t engine_h_execute_batch(EngineInstance* engine, const uint8_t* cmds, size_t len, int32_t* ids, int32_t idCapacity) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    // One undo step for the whole batch
+    engine->history().begin();
+    int added = executeBatch(engine->scene(), cmds, len, ids, idCapacity);
+    engine->history().commit();
+    return added;
+}
+
+int32_t engine_h_pick(EngineInstance* engine, int32_t x, int32_t y) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().pick(x, y);
+}
+
+int32_t engine_h_pick_handle(EngineInstance* engine, int32_t x, int32_t y) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().pickHandle(x, y);
+}
+
+void engine_h_move_object(EngineInstance* engine, int32_t id, float dx, float dy) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().moveObject(id, dx, dy);
+}
+
+void engine_h_move_selection(EngineInstance* engine, float dx, float dy) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    // One undo step for the whole selection
+    engine->history().begin();
+    engine->scene().moveSelection(dx, dy);
+    engine->history().commit();
+}
+
+int32_t engine_h_get_selected_id(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().getPrimarySelection();
+}
+
+void engine_h_remove_object(EngineInstance* engine, int32_t id) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().removeObject(id);
+}
+
+void engine_h_reorder_object(EngineInstance* engine, int32_t id, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().reorderObject(id, index);
+}
+
+void engine_h_select_object(EngineInstance* engine, int32_t id, bool addToSelection) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().select(id, addToSelection); 
+}
+
+void engine_h_clear_selection(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().clearSelection();
+}
+
+int32_t engine_h_get_selected_count(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return (int32_t)engine->scene().selectedUids.size();
+}
+
+int32_t engine_h_get_selected_id_at(EngineInstance* engine, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (index >= 0 && index < (int32_t)engine->scene().selectedUids.size()) {
+        return engine->scene().selectedUids[index];
     }
+    return -1;
+}
 
-    g_scene.clear();
-    g_imageCache.clear();
-    g_imageSizes.clear();
-
-    // Find all slides
-    for (int slideNum = 1; slideNum <= 100; ++slideNum) {
-        std::ostringstream slidePath;
-        slidePath << "ppt/slides/slide" << slideNum << ".xml";
-        
-        if (zip_entry_open(zip, slidePath.str().c_str()) < 0) {
-            break; // No more slides
+int32_t engine_h_get_scene_snapshot(EngineInstance* engine, EngineObjectInfo* objects, int32_t capacity,
+                                    char* names, int32_t namesCapacity, int32_t* namesSize) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    std::vector<int> selected(engine->scene().selectedUids);
+    std::sort(selected.begin(), selected.end());
+    int primary = engine->scene().getPrimarySelection();
+
+    int32_t count = (int32_t)engine->scene().objects.size();
+    size_t nameBytes = 0;
+    for (int32_t i = 0; i < count; ++i) {
+        Object& obj = *engine->scene().objects[i];
+        size_t nameSize = obj.name.size() + 1;
+        if (names && nameBytes + nameSize <= (size_t)std::max(namesCapacity, 0)) {
+            memcpy(names + nameBytes, obj.name.c_str(), nameSize);
         }
 
-        void* pSlideData = NULL;
-        size_t uncompressed_size = 0;
-        
-        if (zip_entry_read(zip, &pSlideData, &uncompressed_size) < 0) {
-            zip_entry_close(zip);
-            continue;
-        }
-        zip_entry_close(zip);
-
-        // Parse relationships for this slide
-        auto rels = parseRelationships(zip, slideNum);
-
-        // Parse XML
-        XMLDocument doc;
-        if (doc.Parse((const char*)pSlideData, uncompressed_size) == XML_SUCCESS) {
-            XMLElement* sld = doc.FirstChildElement("p:sld");
-            if (sld) {
-                XMLElement* cSld = sld->FirstChildElement("p:cSld");
-                if (cSld) {
-                    XMLElement* spTree = cSld->FirstChildElement("p:spTree");
-                    if (spTree) {
-                        // Iterate through all shapes
-                        for (XMLElement* element = spTree->FirstChildElement(); 
-                             element; 
-                             element = element->NextSiblingElement()) {
-                            
-                            const char* rawName = element->Name();
-                            std::string elName = rawName ? rawName : "";
-                            
-                            // Shape: <p:sp>
-                            if (elName == "p:sp") {
-                                XMLElement* spPr = element->FirstChildElement("p:spPr");
-                                float x = 0, y = 0, w = 100, h = 100;
-                                
-                                if (spPr) {
-                                    XMLElement* xfrm = spPr->FirstChildElement("a:xfrm");
-                                    if (xfrm) {
-                                        XMLElement* off = xfrm->FirstChildElement("a:off");
-                                        if (off) {
-                                            if (off->Attribute("x")) x = emuToPixel(atoll(off->Attribute("x")));
-                                            if (off->Attribute("y")) y = emuToPixel(atoll(off->Attribute("y")));
-                                        }
-                                        XMLElement* ext = xfrm->FirstChildElement("a:ext");
-                                        if (ext) {
-                                            if (ext->Attribute("cx")) w = emuToPixel(atoll(ext->Attribute("cx")));
-                                            if (ext->Attribute("cy")) h = emuToPixel(atoll(ext->Attribute("cy")));
-                                        }
-                                    }
-                                }
-
-                                // Get color from solidFill
-                                uint32_t color = 0xFFCCCCCC;
-                                if (spPr) {
-                                    XMLElement* solidFill = spPr->FirstChildElement("a:solidFill");
-                                    if (solidFill) {
-                                        color = parseColor(solidFill);
-                                    }
-                                }
-
-                                // Detect shape type
-                                std::string shapeType = detectShapeType(spPr);
-                                int newId = (int)g_scene.objects.size() + 1;
-                                
-                                if (shapeType == "ellipse") {
-                                    g_scene.add(std::make_shared<EllipseObject>(
-                                        newId, (int)x, (int)y, (int)w, (int)h, color));
-                                } else if (shapeType == "line") {
-                                    g_scene.add(std::make_shared<LineObject>(
-                                        newId, (int)x, (int)y, (int)(x + w), (int)(y + h), color, 3));
-                                } else {
-                                    // Default to rectangle
-                                    g_scene.add(std::make_shared<RectangleObject>(
-                                        newId, (int)x, (int)y, (int)w, (int)h, color));
-                                }
-
-                                // Extract text if present
-                                XMLElement* txBody = element->FirstChildElement("p:txBody");
-                                if (txBody) {
-                                    std::string fullText = "";
-                                    float fontSize = 24.0f;
-                                    uint32_t textColor = 0xFF000000;
-                                    
-                                    for (XMLElement* p = txBody->FirstChildElement("a:p"); p; p = p->NextSiblingElement("a:p")) {
-                                        for (XMLElement* r = p->FirstChildElement("a:r"); r; r = r->NextSiblingElement("a:r")) {
-                                            // Get run properties for font size
-                                            XMLElement* rPr = r->FirstChildElement("a:rPr");
-                                            if (rPr) {
-                                                const char* sz = rPr->Attribute("sz");
-                                                if (sz) {
-                                                    fontSize = (float)atof(sz) / 100.0f; // Size in hundredths of a point
-                                                }
-                                                // Get text color
-                                                XMLElement* solidFill = rPr->FirstChildElement("a:solidFill");
-                                                if (solidFill) {
-                                                    textColor = parseColor(solidFill, 0xFF000000);
-                                                }
-                                            }
-                                            
-                                            XMLElement* t = r->FirstChildElement("a:t");
-                                            if (t && t->GetText()) {
-                                                fullText += t->GetText();
-                                            }
-                                        }
-                                        fullText += "\n";
-                                    }
-
-                                    if (!fullText.empty()) {
-                                        if (fullText.back() == '\n') fullText.pop_back();
-
-                                        int textId = (int)g_scene.objects.size() + 1;
-                                        g_scene.add(std::make_shared<TextObject>(
-                                            textId,
-                                            (int)(x + 10), (int)(y + 10),
-                                            fullText.c_str(),
-                                            textColor,
-                                            fontSize > 8 ? fontSize : 24.0f
-                                        ));
-                                    }
-                                }
-                            }
-                            // Picture: <p:pic>
-                            else if (elName == "p:pic") {
-                                float x = 0, y = 0, w = 100, h = 100;
-                                std::string imageRelId;
-
-                                // Get image reference
-                                XMLElement* blipFill = element->FirstChildElement("p:blipFill");
-                                if (blipFill) {
-                                    XMLElement* blip = blipFill->FirstChildElement("a:blip");
-                                    if (blip) {
-                                        const char* embed = blip->Attribute("r:embed");
-                                        if (embed) imageRelId = embed;
-                                    }
-                                }
-
-                                XMLElement* spPr = element->FirstChildElement("p:spPr");
-                                if (spPr) {
-                                    XMLElement* xfrm = spPr->FirstChildElement("a:xfrm");
-                                    if (xfrm) {
-                                        XMLElement* off = xfrm->FirstChildElement("a:off");
-                                        XMLElement* ext = xfrm->FirstChildElement("a:ext");
-                                        if (off) {
-                                            if (off->Attribute("x")) x = emuToPixel(atoll(off->Attribute("x")));
-                                            if (off->Attribute("y")) y = emuToPixel(atoll(off->Attribute("y")));
-                                        }
-                                        if (ext) {
-                                            if (ext->Attribute("cx")) w = emuToPixel(atoll(ext->Attribute("cx")));
-                                            if (ext->Attribute("cy")) h = emuToPixel(atoll(ext->Attribute("cy")));
-                                        }
-                                    }
-                                }
-
-                                int picId = (int)g_scene.objects.size() + 1;
-                                
-                                // Try to load the actual image
-                                if (!imageRelId.empty() && rels.find(imageRelId) != rels.end()) {
-                                    std::string imagePath = rels[imageRelId];
-                                    std::vector<uint32_t> pixels;
-                                    int imgW, imgH;
-                                    
-                                    if (loadImageFromPptx(zip, imagePath, pixels, imgW, imgH)) {
-                                        g_scene.add(std::make_shared<ImageObject>(
-                                            picId, (int)x, (int)y, (int)w, (int)h,
-                                            pixels.data(), imgW, imgH));
-                                        continue;
-                                    }
-                                }
-                                
-                                // Fallback: placeholder rectangle
-                                g_scene.add(std::make_shared<RectangleObject>(
-                                    picId, (int)x, (int)y, (int)w, (int)h, 0xFF888888));
-                            }
-                            // Group: <p:grpSp>
-                            else if (elName == "p:grpSp") {
-                                // TODO: Recursively parse group shapes
-                                // For now, skip groups
-                            }
-                        }
-                    }
-                }
+        if (objects && i < capacity) {
+            EngineObjectInfo& info = objects[i];
+            info.uid = obj.id;
+            info.type = obj.getType();
+            info.x = obj.x;
+            info.y = obj.y;
+            info.w = obj.w;
+            info.h = obj.h;
+            info.color = obj.getColor();
+            info.flags = 0;
+            if (std::binary_search(selected.begin(), selected.end(), obj.id)) {
+                info.flags |= ENGINE_OBJECT_SELECTED;
+                if (obj.id == primary) info.flags |= ENGINE_OBJECT_PRIMARY;
             }
+            info.nameOffset = (uint32_t)nameBytes;
+            info.reserved = 0;
         }
+        nameBytes += nameSize;
+    }
+    if (namesSize) *namesSize = (int32_t)nameBytes;
+    return count;
+}
 
-        if (pSlideData) free(pSlideData);
+void engine_h_get_object_bounds(EngineInstance* engine, int32_t id, float* x, float* y, float* w, float* h) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    Object* obj = engine->scene().getObject(id);
+    if (obj) {
+        if (x) *x = obj->x;
+        if (y) *y = obj->y;
+        if (w) *w = obj->w;
+        if (h) *h = obj->h;
     }
+}
+
+void engine_h_set_object_rect(EngineInstance* engine, int32_t id, float x, float y, float w, float h) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().updateObjectRect(id, x, y, w, h);
+}
+
+void engine_h_set_object_color(EngineInstance* engine, int32_t id, uint32_t color) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().updateObjectColor(id, color);
+}
+
+uint32_t engine_h_get_object_color(EngineInstance* engine, int32_t id) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().getObjectColor(id);
+}
+
+int32_t engine_h_get_object_count(EngineInstance* engine) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().getObjectCount();
+}
+
+const char* engine_h_get_object_name(EngineInstance* engine, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->name = engine->scene().getObjectName(index);
+    return engine->name.c_str();
+}
+
+int32_t engine_h_get_object_type(EngineInstance* engine, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().getObjectType(index);
+}
+
+int32_t engine_h_get_object_uid(EngineInstance* engine, int32_t index) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().getObjectUid(index);
+}
+
+const char* engine_h_get_object_text(EngineInstance* engine, int32_t id) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->text = engine->scene().getObjectText(id);
+    return engine->text.c_str();
+}
+
+void engine_h_set_object_text(EngineInstance* engine, int32_t id, const char* text) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().updateObjectText(id, text);
+}
+
+float engine_h_get_object_font_size(EngineInstance* engine, int32_t id) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->scene().getObjectFontSize(id);
+}
+
+void engine_h_set_object_font_size(EngineInstance* engine, int32_t id, float size) {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->scene().updateObjectFontSize(id, size);
+}
+
+// The calls without a handle act on a default instance, created on first use
+
+static EngineInstance* defaultEngine() {
+    static EngineInstance instance;
+    return &instance;
+}
+
+void engine_init(int32_t width, int32_t height) {
+    engine_h_init(defaultEngine(), width, height);
+}
+
+void engine_import_pptx(const char* filepath) {
+    engine_h_import_pptx(defaultEngine(), filepath);
+}
+
+void engine_set_cache_directory(const char* directory, int64_t maxBytes) {
+    engine_h_set_cache_directory(defaultEngine(), directory, maxBytes);
+}
+
+void engine_set_import_image_dpi(float dpi, bool keepOriginals) {
+    engine_h_set_import_image_dpi(defaultEngine(), dpi, keepOriginals);
+}
+
+bool engine_save_document(const char* filepath) {
+    return engine_h_save_document(defaultEngine(), filepath);
+}
+
+bool engine_open_document(const char* filepath) {
+    return engine_h_open_document(defaultEngine(), filepath);
+}
+
+bool engine_journal_open(const char* filepath) {
+    return engine_h_journal_open(defaultEngine(), filepath);
+}
+
+bool engine_journal_flush() {
+    return engine_h_journal_flush(defaultEngine());
+}
+
+bool engine_journal_checkpoint() {
+    return engine_h_journal_checkpoint(defaultEngine());
+}
+
+void engine_journal_close() {
+    engine_h_journal_close(defaultEngine());
+}
+
+bool engine_journal_recover(const char* filepath) {
+    return engine_h_journal_recover(defaultEngine(), filepath);
+}
 
-    zip_close(zip);
-    printf("PPTX imported successfully: %zu objects created\n", g_scene.objects.size());
+int32_t engine_poll_events(EngineEvent* buffer, int32_t capacity) {
+    return engine_h_poll_events(defaultEngine(), buffer, capacity);
+}
+
+void engine_begin_transaction() {
+    engine_h_begin_transaction(defaultEngine());
+}
+
+void engine_commit() {
+    engine_h_commit(defaultEngine());
+}
+
+bool engine_undo() {
+    return engine_h_undo(defaultEngine());
+}
+
+bool engine_redo() {
+    return engine_h_redo(defaultEngine());
+}
+
+bool engine_can_undo() {
+    return engine_h_can_undo(defaultEngine());
+}
+
+bool engine_can_redo() {
+    return engine_h_can_redo(defaultEngine());
+}
+
+void engine_set_history_limit(int64_t maxBytes) {
+    engine_h_set_history_limit(defaultEngine(), maxBytes);
 }
 
 void engine_render(uint32_t* buffer, int32_t width, int32_t height) {
-    g_scene.render(buffer, width, height);
+    engine_h_render(defaultEngine(), buffer, width, height);
+}
+
+EngineSnapshot* engine_snapshot(void) {
+    return engine_h_snapshot(defaultEngine());
+}
+
+bool engine_export_png(const char* path, int32_t width, int32_t height, int32_t level) {
+    return engine_h_export_png(defaultEngine(), path, width, height, level);
+}
+
+bool engine_export_pdf(const char* path, int32_t width, int32_t height) {
+    return engine_h_export_pdf(defaultEngine(), path, width, height);
+}
+
+int32_t engine_get_page_count() {
+    return engine_h_get_page_count(defaultEngine());
+}
+
+int32_t engine_get_active_page() {
+    return engine_h_get_active_page(defaultEngine());
+}
+
+bool engine_set_active_page(int32_t index) {
+    return engine_h_set_active_page(defaultEngine(), index);
+}
+
+int32_t engine_add_page(int32_t index) {
+    return engine_h_add_page(defaultEngine(), index);
+}
+
+int32_t engine_duplicate_page(int32_t index) {
+    return engine_h_duplicate_page(defaultEngine(), index);
+}
+
+bool engine_remove_page(int32_t index) {
+    return engine_h_remove_page(defaultEngine(), index);
+}
+
+bool engine_move_page(int32_t from, int32_t to) {
+    return engine_h_move_page(defaultEngine(), from, to);
+}
+
+void engine_render_page(int32_t index, uint32_t* buffer, int32_t width, int32_t height) {
+    engine_h_render_page(defaultEngine(), index, buffer, width, height);
+}
+
+void engine_set_image_smoothing(bool enabled) {
+    engine_h_set_image_smoothing(defaultEngine(), enabled);
+}
+
+void engine_trim_memory(int32_t level) {
+    engine_h_trim_memory(defaultEngine(), level);
+}
+
+void engine_render_thumbnail(int32_t index, uint32_t* buffer, int32_t width, int32_t height) {
+    engine_h_render_thumbnail(defaultEngine(), index, buffer, width, height);
 }
 
 int32_t engine_add_rect(float x, float y, float w, float h, uint32_t color) {
-    int id = (int)g_scene.objects.size() + 1;
-    g_scene.add(std::make_shared<RectangleObject>(id, x, y, w, h, color));
-    return id;
+    return engine_h_add_rect(defaultEngine(), x, y, w, h, color);
 }
 
 int32_t engine_add_ellipse(float x, float y, float w, float h, uint32_t color) {
-    int id = (int)g_scene.objects.size() + 1;
-    g_scene.add(std::make_shared<EllipseObject>(id, x, y, w, h, color));
-    return id;
+    return engine_h_add_ellipse(defaultEngine(), x, y, w, h, color);
 }
 
 int32_t engine_add_line(float x1, float y1, float x2, float y2, uint32_t color, float thickness) {
-    int id = (int)g_scene.objects.size() + 1;
-    g_scene.add(std::make_shared<LineObject>(id, x1, y1, x2, y2, color, thickness));
-    return id;
+    return engine_h_add_line(defaultEngine(), x1, y1, x2, y2, color, thickness);
 }
 
 void engine_load_font(const uint8_t* data, int32_t length) {
-    g_scene.setFont(data, length);
+    engine_h_load_font(defaultEngine(), data, length);
 }
 
 int32_t engine_add_text(float x, float y, const char* text, uint32_t color, float size) {
-    int id = (int)g_scene.objects.size() + 1;
-    g_scene.add(std::make_shared<TextObject>(id, x, y, text, color, size));
-    return id;
+    return engine_h_add_text(defaultEngine(), x, y, text, color, size);
 }
 
 int32_t engine_add_image(float x, float y, float w, float h, const uint32_t* pixels, int32_t imgW, int32_t imgH) {
-    int id = (int)g_scene.objects.size() + 1;
-    g_scene.add(std::make_shared<ImageObject>(id, x, y, w, h, pixels, imgW, imgH));
-    return id;
+    return engine_h_add_image(defaultEngine(), x, y, w, h, pixels, imgW, imgH);
+}
+
+int32_t engine_execute_batch(const uint8_t* cmds, size_t len, int32_t* ids, int32_t idCapacity) {
+    return engine_h_execute_batch(defaultEngine(), cmds, len, ids, idCapacity);
 }
 
 int32_t engine_pick(int32_t x, int32_t y) {
-    return g_scene.pick(x, y);
+    return engine_h_pick(defaultEngine(), x, y);
 }
 
 int32_t engine_pick_handle(int32_t x, int32_t y) {
-    return g_scene.pickHandle(x, y);
+    return engine_h_pick_handle(defaultEngine(), x, y);
 }
 
 void engine_move_object(int32_t id, float dx, float dy) {
-    g_scene.moveObject(id, dx, dy);
+    engine_h_move_object(defaultEngine(), id, dx, dy);
 }
 
 void engine_move_selection(float dx, float dy) {
-    g_scene.moveSelection(dx, dy);
+    engine_h_move_selection(defaultEngine(), dx, dy);
 }
 
 int32_t engine_get_selected_id() {
-    return g_scene.getPrimarySelection();
+    return engine_h_get_selected_id(defaultEngine());
 }
 
 void engine_remove_object(int32_t id) {
-    g_scene.removeObject(id);
+    engine_h_remove_object(defaultEngine(), id);
+}
+
+void engine_reorder_object(int32_t id, int32_t index) {
+    engine_h_reorder_object(defaultEngine(), id, index);
 }
 
 void engine_select_object(int32_t id, bool addToSelection) {
-    g_scene.select(id, addToSelection); 
+    engine_h_select_object(defaultEngine(), id, addToSelection);
 }
 
 void engine_clear_selection() {
-    g_scene.clearSelection();
+    engine_h_clear_selection(defaultEngine());
 }
 
 int32_t engine_get_selected_count() {
-    return (int32_t)g_scene.selectedUids.size();
+    return engine_h_get_selected_count(defaultEngine());
 }
 
 int32_t engine_get_selected_id_at(int32_t index) {
-    if (index >= 0 && index < (int32_t)g_scene.selectedUids.size()) {
-        return g_scene.selectedUids[index];
-    }
-    return -1;
+    return engine_h_get_selected_id_at(defaultEngine(), index);
+}
+
+int32_t engine_get_scene_snapshot(EngineObjectInfo* objects, int32_t capacity,
+                                  char* names, int32_t namesCapacity, int32_t* namesSize) {
+    return engine_h_get_scene_snapshot(defaultEngine(), objects, capacity, names, namesCapacity, namesSize);
 }
 
 void engine_get_object_bounds(int32_t id, float* x, float* y, float* w, float* h) {
-    Object* obj = g_scene.getObject(id);
-    if (obj) {
-        if (x) *x = obj->x;
-        if (y) *y = obj->y;
-        if (w) *w = obj->w;
-        if (h) *h = obj->h;
-    }
+    engine_h_get_object_bounds(defaultEngine(), id, x, y, w, h);
 }
 
 void engine_set_object_rect(int32_t id, float x, float y, float w, float h) {
-    g_scene.updateObjectRect(id, x, y, w, h);
+    engine_h_set_object_rect(defaultEngine(), id, x, y, w, h);
 }
 
 void engine_set_object_color(int32_t id, uint32_t color) {
-    g_scene.updateObjectColor(id, color);
+    engine_h_set_object_color(defaultEngine(), id, color);
 }
 
 uint32_t engine_get_object_color(int32_t id) {
-    return g_scene.getObjectColor(id);
+    return engine_h_get_object_color(defaultEngine(), id);
 }
 
 int32_t engine_get_object_count() {
-    return g_scene.getObjectCount();
+    return engine_h_get_object_count(defaultEngine());
 }
 
 const char* engine_get_object_name(int32_t index) {
-    return g_scene.getObjectName(index);
+    return engine_h_get_object_name(defaultEngine(), index);
 }
 
 int32_t engine_get_object_type(int32_t index) {
-    return g_scene.getObjectType(index);
+    return engine_h_get_object_type(defaultEngine(), index);
 }
 
 int32_t engine_get_object_uid(int32_t index) {
-    return g_scene.getObjectUid(index);
+    return engine_h_get_object_uid(defaultEngine(), index);
 }
 
 const char* engine_get_object_text(int32_t id) {
-    return g_scene.getObjectText(id);
+    return engine_h_get_object_text(defaultEngine(), id);
 }
 
 void engine_set_object_text(int32_t id, const char* text) {
-    g_scene.updateObjectText(id, text);
+    engine_h_set_object_text(defaultEngine(), id, text);
 }
 
 float engine_get_object_font_size(int32_t id) {
-    return g_scene.getObjectFontSize(id);
+    return engine_h_get_object_font_size(defaultEngine(), id);
 }
 
 void engine_set_object_font_size(int32_t id, float size) {
-    g_scene.updateObjectFontSize(id, size);
+    engine_h_set_object_font_size(defaultEngine(), id, size);
 }
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Compile-time perfect hashing for small, fixed string tables.
+// The seed is searched at compile time so that every key lands in its own
+// slot; a lookup is then one hash, one probe and one string compare.
+
+constexpr uint32_t hashName(std::string_view s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed; // FNV-1a
+    for (char c : s) {
+        h ^= (uint8_t)c;
+        h *= 16777619u;
+    }
+    // Finalizer: slots are taken from the low bits, which FNV alone mixes poorly
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+template <typename V>
+struct NameEntry {
+    std::string_view name;
+    V value;
+};
+
+template <typename V, size_t Slots>
+class PerfectHashMap {
+    static_assert((Slots & (Slots - 1)) == 0, "slot count must be a power of two");
+
+public:
+    template <size_t N>
+    constexpr explicit PerfectHashMap(const NameEntry<V> (&entries)[N]) {
+        static_assert(N <= Slots, "more keys than slots");
+        for (uint32_t s = 1; s < 100000u; ++s) {
+            if (tryBuild(entries, N, s)) {
+                seed = s;
+                return;
+            }
+        }
+    }
+
+    constexpr bool isPerfect() const { return seed != 0; }
+
+    constexpr V find(std::string_view name, V fallback) const {
+        const NameEntry<V>& e = slots[hashName(name, seed) & (Slots - 1)];
+        return (!e.name.empty() && e.name == name) ? e.value : fallback;
+    }
+
+private:
+    NameEntry<V> slots[Slots] = {};
+    uint32_t seed = 0;
+
+    constexpr bool tryBuild(const NameEntry<V>* entries, size_t n, uint32_t s) {
+        for (size_t i = 0; i < Slots; ++i) slots[i] = NameEntry<V>{};
+        for (size_t i = 0; i < n; ++i) {
+            NameEntry<V>& slot = slots[hashName(entries[i].name, s) & (Slots - 1)];
+            if (!slot.name.empty()) return false;
+            slot = entries[i];
+        }
+        return true;
+    }
+};
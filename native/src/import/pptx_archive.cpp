@@ -0,0 +1,216 @@
+#include "pptx_archive.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "tinyxml2.h"
+
+using namespace tinyxml2;
+
+bool PptxArchive::open(const char* filepath) {
+    close();
+
+    if (!file.open(filepath)) return false;
+    if (!index.load(file.data(), file.size())) {
+        file.close();
+        return false;
+    }
+    reader.attach(file.data(), file.size());
+    return true;
+}
+
+void PptxArchive::close() {
+    reader.attach(nullptr, 0);
+    reader.releaseScratch();
+    index.clear();
+    file.close();
+}
+
+bool PptxArchive::contains(const std::string& name) const {
+    return index.find(name) != nullptr;
+}
+
+bool PptxArchive::read(const std::string& name, ByteView& out) {
+    const ZipEntry* entry = index.find(name);
+    return entry && reader.read(*entry, out);
+}
+
+void PptxArchive::readParallel(const std::vector<std::string>& names,
+                               const std::function<void(size_t, ByteView)>& fn) {
+    unsigned workers = maxWorkers ? maxWorkers : std::max(1u, std::thread::hardware_concurrency());
+    workers = (unsigned)std::min<size_t>(workers, names.size());
+    if (workers <= 1) {
+        ByteView data;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (read(names[i], data)) fn(i, data);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        ZipReader local(file.data(), file.size());
+        ByteView data;
+        for (size_t i = next++; i < names.size(); i = next++) {
+            const ZipEntry* entry = index.find(names[i]);
+            if (entry && local.read(*entry, data)) fn(i, data);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned t = 1; t < workers; ++t) pool.emplace_back(work);
+    work();
+    for (auto& th : pool) th.join();
+}
+
+std::map<std::string, Relationship> PptxArchive::readRelationships(const std::string& partName) {
+    std::map<std::string, Relationship> rels;
+
+    ByteView data;
+    if (!read(relationshipsPartFor(partName), data)) return rels;
+
+    XMLDocument doc;
+    if (doc.Parse((const char*)data.data, data.size) != XML_SUCCESS) return rels;
+
+    XMLElement* root = doc.FirstChildElement("Relationships");
+    if (!root) return rels;
+
+    std::string baseDir = partDirectory(partName);
+    for (XMLElement* rel = root->FirstChildElement("Relationship");
+         rel;
+         rel = rel->NextSiblingElement("Relationship")) {
+        const char* id = rel->Attribute("Id");
+        const char* target = rel->Attribute("Target");
+        const char* type = rel->Attribute("Type");
+        const char* mode = rel->Attribute("TargetMode");
+        if (!id || !target) continue;
+        if (mode && strcmp(mode, "External") == 0) continue;
+        rels[id] = Relationship{resolvePartTarget(baseDir, target), type ? type : ""};
+    }
+    return rels;
+}
+
+std::string PptxArchive::findOfficeDocument() {
+    for (const auto& rel : readRelationships("")) {
+        if (relationshipIs(rel.second, "officeDocument")) return rel.second.target;
+    }
+    return "ppt/presentation.xml";
+}
+
+std::vector<std::string> PptxArchive::slideParts() {
+    std::vector<std::string> slides;
+
+    std::string presentation = findOfficeDocument();
+    ByteView data;
+    XMLDocument doc;
+    if (read(presentation, data) &&
+        doc.Parse((const char*)data.data, data.size) == XML_SUCCESS) {
+        // Parsed before reading the rels; the view is reused by the next read
+        auto rels = readRelationships(presentation);
+
+        XMLElement* pres = doc.FirstChildElement("p:presentation");
+        XMLElement* sldIdLst = pres ? pres->FirstChildElement("p:sldIdLst") : nullptr;
+        for (XMLElement* sldId = sldIdLst ? sldIdLst->FirstChildElement("p:sldId") : nullptr;
+             sldId;
+             sldId = sldId->NextSiblingElement("p:sldId")) {
+            const char* rid = sldId->Attribute("r:id");
+            if (!rid) continue;
+            auto it = rels.find(rid);
+            if (it != rels.end() && relationshipIs(it->second, "slide") &&
+                contains(it->second.target)) {
+                slides.push_back(it->second.target);
+            }
+        }
+    }
+
+    if (!slides.empty()) return slides;
+
+    // Fallback for packages without a usable slide list: every slide part, by number
+    std::vector<std::pair<long, std::string>> numbered;
+    const std::string prefix = "ppt/slides/slide";
+    for (const ZipEntry& entry : index.all()) {
+        const std::string& name = entry.name;
+        if (name.compare(0, prefix.size(), prefix) != 0) continue;
+        if (name.find('/', prefix.size()) != std::string::npos) continue;
+        char* end = nullptr;
+        long num = strtol(name.c_str() + prefix.size(), &end, 10);
+        if (end && strcmp(end, ".xml") == 0) numbered.emplace_back(num, name);
+    }
+    std::sort(numbered.begin(), numbered.end());
+    for (auto& n : numbered) slides.push_back(n.second);
+    return slides;
+}
+
+bool PptxArchive::slideSize(long long& cx, long long& cy) {
+    ByteView data;
+    XMLDocument doc;
+    if (!read(findOfficeDocument(), data) ||
+        doc.Parse((const char*)data.data, data.size) != XML_SUCCESS) {
+        return false;
+    }
+
+    XMLElement* pres = doc.FirstChildElement("p:presentation");
+    XMLElement* sldSz = pres ? pres->FirstChildElement("p:sldSz") : nullptr;
+    if (!sldSz) return false;
+    cx = sldSz->Int64Attribute("cx", cx);
+    cy = sldSz->Int64Attribute("cy", cy);
+    return true;
+}
+
+std::string PptxArchive::themePart() {
+    for (const auto& rel : readRelationships(findOfficeDocument())) {
+        if (relationshipIs(rel.second, "theme")) return rel.second.target;
+    }
+    return "ppt/theme/theme1.xml";
+}
+
+std::string partDirectory(const std::string& partName) {
+    size_t slash = partName.rfind('/');
+    return slash == std::string::npos ? "" : partName.substr(0, slash);
+}
+
+std::string relationshipsPartFor(const std::string& partName) {
+    if (partName.empty()) return "_rels/.rels";
+    size_t slash = partName.rfind('/');
+    if (slash == std::string::npos) return "_rels/" + partName + ".rels";
+    return partName.substr(0, slash) + "/_rels/" + partName.substr(slash + 1) + ".rels";
+}
+
+std::string resolvePartTarget(const std::string& baseDir, const std::string& target) {
+    // Absolute targets are relative to the package root
+    std::string path = (!target.empty() && target[0] == '/')
+        ? target.substr(1)
+        : (baseDir.empty() ? target : baseDir + "/" + target);
+
+    std::vector<std::string> segments;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        std::string seg = path.substr(start, end - start);
+        if (seg == "..") {
+            if (!segments.empty()) segments.pop_back();
+        } else if (!seg.empty() && seg != ".") {
+            segments.push_back(seg);
+        }
+        start = end + 1;
+    }
+
+    std::string resolved;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (i) resolved += '/';
+        resolved += segments[i];
+    }
+    return resolved;
+}
+
+// Relationship types are URIs; compare the last path segment only
+bool relationshipIs(const Relationship& rel, const char* kind) {
+    size_t slash = rel.type.rfind('/');
+    const char* last = rel.type.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+    return strcmp(last, kind) == 0;
+}
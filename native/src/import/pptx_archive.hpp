@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "zip_index.hpp"
+#include "../core/mapped_file.hpp"
+
+struct Relationship {
+    std::string target; // absolute part name
+    std::string type;
+};
+
+// Read-only view of a PPTX package.
+// The file is memory mapped and its zip central directory indexed once on
+// open, so every part lookup is a hash probe and stored members (most
+// media) are never copied.
+class PptxArchive {
+public:
+    bool open(const char* path);
+    void close();
+
+    bool contains(const std::string& name) const;
+    // The view stays valid until the next read() on this archive
+    bool read(const std::string& name, ByteView& out);
+
+    // Reads several parts concurrently, each worker through its own reader.
+    // `fn` runs on the worker thread with the bytes of names[i]; the view is
+    // only valid for the duration of the call.
+    void readParallel(const std::vector<std::string>& names,
+                      const std::function<void(size_t, ByteView)>& fn);
+    // Caps the readParallel workers; 0 uses every core
+    void setMaxWorkers(unsigned workers) { maxWorkers = workers; }
+
+    // Relationships of a part (Id -> target)
+    std::map<std::string, Relationship> readRelationships(const std::string& partName);
+
+    // Slide part names in presentation order (from ppt/presentation.xml)
+    std::vector<std::string> slideParts();
+
+    // Slide size in EMU (p:sldSz of the presentation part)
+    bool slideSize(long long& cx, long long& cy);
+
+    // Theme of the presentation part
+    std::string themePart();
+
+private:
+    MappedFile file;
+    ZipIndex index;
+    ZipReader reader;
+    unsigned maxWorkers = 0;
+
+    std::string findOfficeDocument();
+};
+
+// Path helpers for OPC part names
+std::string partDirectory(const std::string& partName);
+std::string relationshipsPartFor(const std::string& partName);
+std::string resolvePartTarget(const std::string& baseDir, const std::string& target);
+bool relationshipIs(const Relationship& rel, const char* kind);
@@ -0,0 +1,358 @@
+#include "pptx_importer.hpp"
+#include "../core/document.hpp"
+#include "../objects/rect_object.hpp"
+#include "../objects/text_object.hpp"
+#include "../objects/image_object.hpp"
+#include "../objects/ellipse_object.hpp"
+#include "../objects/line_object.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <unordered_set>
+
+#include "slide_parser.hpp"
+
+// Read all pictures up front, inflating in parallel. They are kept
+// compressed and decoded when first drawn.
+void PptxImporter::readImages(const std::vector<std::string>& imagePaths) {
+    std::vector<std::shared_ptr<ImageData>> images(imagePaths.size());
+    archive.readParallel(imagePaths, [&](size_t i, ByteView data) {
+        images[i] = makeEncodedImage(std::vector<uint8_t>(data.data, data.data + data.size));
+    });
+
+    for (size_t i = 0; i < imagePaths.size(); ++i) {
+        if (images[i]) imageCache[imagePaths[i]] = shownImage(std::move(images[i]));
+    }
+}
+
+// What objects show of a picture read from the deck. Pictures that may be
+// capped while keeping their file are shown through a copy, so the cap
+// reduces the copy and the original keeps its full size.
+std::shared_ptr<ImageData> PptxImporter::shownImage(std::shared_ptr<ImageData> file) const {
+    if (maxImageDpi <= 0 || !keepImageOriginals) return file;
+    int width = file->width, height = file->height;
+    return makeReducedImage(std::move(file), width, height);
+}
+
+// Caps pictures stored larger than maxImageDpi allows, once every slide
+// has been read and their largest extents are known. Objects share the
+// pictures, so they see the new size.
+void PptxImporter::capImages() {
+    float scale = maxImageDpi / 96.0f;
+    size_t reduced = 0, before = 0, after = 0;
+    for (const auto& entry : imageUses) {
+        auto cached = imageCache.find(entry.first);
+        if (cached == imageCache.end()) continue;
+        ImageData& image = *cached->second;
+        const ImageUse& use = entry.second;
+        int w = std::min(image.width, std::max(1, (int)std::ceil(use.width * scale)));
+        int h = std::min(image.height, std::max(1, (int)std::ceil(use.height * scale)));
+        if (w == image.width && h == image.height) continue;
+
+        before += (size_t)image.width * image.height * sizeof(uint32_t);
+        after += (size_t)w * h * sizeof(uint32_t);
+        ++reduced;
+
+        if (keepImageOriginals) {
+            // The shown copy decodes at the capped size when first drawn
+            image.width = w;
+            image.height = h;
+            continue;
+        }
+        std::shared_ptr<ImageData> pixels = decodeImage(image.encoded.data(), image.encoded.size());
+        if (!pixels) continue; // stays lazy; drawing skips it
+        std::shared_ptr<ImageData> copy = downscaleImage(*pixels, w, h);
+        pixels.reset();
+        image.encoded = std::vector<uint8_t>();
+        image.takePixels(*copy);
+    }
+    if (reduced > 0) {
+        printf("Pictures capped at %.0f dpi: %zu, %.1f MB -> %.1f MB decoded\n", maxImageDpi, reduced,
+               before / 1048576.0, after / 1048576.0);
+    }
+}
+
+// Reads a picture part not read up front
+std::shared_ptr<const ImageData> PptxImporter::loadImage(const std::string& imagePath) {
+    // Check cache first
+    auto cached = imageCache.find(imagePath);
+    if (cached != imageCache.end()) {
+        return cached->second;
+    }
+
+    ByteView imgData;
+    if (!archive.read(imagePath, imgData)) {
+        return nullptr;
+    }
+
+    std::shared_ptr<ImageData> image =
+        makeEncodedImage(std::vector<uint8_t>(imgData.data, imgData.data + imgData.size));
+    if (!image) {
+        return nullptr;
+    }
+    image = shownImage(std::move(image));
+
+    // Cache for later use
+    imageCache[imagePath] = image;
+    return image;
+}
+
+// Placeholder types that fill the same slot on a master
+static std::string placeholderSlot(const std::string& type) {
+    if (type == "ctrTitle") return "title";
+    if (type.empty() || type == "obj" || type == "subTitle") return "body";
+    return type;
+}
+
+const ShapeRecord* MasterPart::findPlaceholder(const ShapeRecord& ph) const {
+    // Slides and layouts are linked by index first, then by type
+    if (ph.placeholderIdx >= 0) {
+        for (const auto& p : placeholders) {
+            if (p.placeholderIdx == ph.placeholderIdx) return &p;
+        }
+    }
+    for (const auto& p : placeholders) {
+        if (p.placeholderType == ph.placeholderType) return &p;
+    }
+    std::string slot = placeholderSlot(ph.placeholderType);
+    for (const auto& p : placeholders) {
+        if (placeholderSlot(p.placeholderType) == slot) return &p;
+    }
+    return nullptr;
+}
+
+// Fills what a placeholder leaves unset from the closest matching ancestor
+static void inheritPlaceholder(ShapeRecord& shape, const MasterPart* from) {
+    const ShapeRecord* src = nullptr;
+    for (; from && !src; from = from->parent) src = from->findPlaceholder(shape);
+    if (!src) return;
+
+    if (!shape.hasOffset && src->hasOffset) {
+        shape.hasOffset = true;
+        shape.x = src->x;
+        shape.y = src->y;
+    }
+    if (!shape.hasExtent && src->hasExtent) {
+        shape.hasExtent = true;
+        shape.w = src->w;
+        shape.h = src->h;
+    }
+    if (!shape.hasFill && src->hasFill) {
+        shape.hasFill = true;
+        shape.fill = src->fill;
+    }
+}
+
+bool PptxImporter::import(const char* filepath) {
+    if (!archive.open(filepath)) {
+        printf("Error: Could not open PPTX (ZIP) file: %s\n", filepath);
+        return false;
+    }
+
+    imageCache.clear();
+    imageUses.clear();
+    masterParts.clear();
+    masterRels.clear();
+
+    // Scheme colors resolve against the presentation theme, read once
+    colors = ColorScheme();
+    ByteView themeData;
+    if (archive.read(archive.themePart(), themeData)) {
+        parseTheme(themeData, colors);
+    }
+
+    long long cx = 12192000, cy = 6858000; // 16:9 default
+    archive.slideSize(cx, cy);
+    slideWidth = (int)emuToPixel(cx);
+    slideHeight = (int)emuToPixel(cy);
+
+    // Slide order comes from the presentation part, not from part names
+    std::vector<std::string> slideParts = archive.slideParts();
+    document.reset(slideParts.size());
+    document.setPageSize(slideWidth, slideHeight);
+
+    std::vector<RelationshipMap> slideRels(slideParts.size());
+    std::vector<std::string> slideLayouts(slideParts.size());
+    for (size_t i = 0; i < slideParts.size(); ++i) {
+        slideRels[i] = archive.readRelationships(slideParts[i]);
+        for (const auto& rel : slideRels[i]) {
+            if (relationshipIs(rel.second, "slideLayout")) {
+                slideLayouts[i] = rel.second.target;
+                collectMasterRels(rel.second.target, "slideMaster");
+            }
+        }
+    }
+
+    // Pictures of slides, layouts and masters are decoded in one batch
+    std::vector<std::string> imagePaths;
+    std::unordered_set<std::string> seen;
+    auto collectImages = [&](const RelationshipMap& rels) {
+        for (const auto& rel : rels) {
+            if (relationshipIs(rel.second, "image") && seen.insert(rel.second.target).second) {
+                imagePaths.push_back(rel.second.target);
+            }
+        }
+    };
+    for (const auto& rels : slideRels) collectImages(rels);
+    for (const auto& part : masterRels) collectImages(part.second);
+    readImages(imagePaths);
+
+    // Slides inflate one at a time into the archive's scratch buffer.
+    // A layout (and its master) is parsed the first time a slide uses it.
+    for (size_t i = 0; i < slideParts.size(); ++i) {
+        const MasterPart* layout = slideLayouts[i].empty() ? nullptr : loadMasterPart(slideLayouts[i]);
+        ByteView slideData;
+        if (archive.read(slideParts[i], slideData)) {
+            importSlide(document.page(i).scene, slideData, slideRels[i], layout);
+        }
+    }
+
+    archive.close();
+    if (maxImageDpi > 0) capImages();
+    imageCache.clear();
+    imageUses.clear();
+    size_t objectCount = 0;
+    for (size_t i = 0; i < document.pageCount(); ++i) objectCount += document.page(i).scene.objects.size();
+    printf("PPTX imported successfully: %zu slides, %zu objects created, %zu layouts and masters shared\n",
+           slideParts.size(), objectCount, masterParts.size());
+    masterParts.clear();
+    masterRels.clear();
+    return true;
+}
+
+// Reads the relationships of a layout or master once, following the chain up
+void PptxImporter::collectMasterRels(const std::string& partName, const char* parentKind) {
+    if (masterRels.count(partName)) return;
+    RelationshipMap& rels = masterRels[partName] = archive.readRelationships(partName);
+    for (const auto& rel : rels) {
+        if (parentKind && relationshipIs(rel.second, parentKind)) {
+            collectMasterRels(rel.second.target, nullptr);
+        }
+    }
+}
+
+const MasterPart* PptxImporter::loadMasterPart(const std::string& partName) {
+    auto cached = masterParts.find(partName);
+    if (cached != masterParts.end()) {
+        return &cached->second;
+    }
+
+    // Registered before the parent is loaded, so a cyclic package terminates
+    MasterPart& part = masterParts[partName];
+    part.content = std::make_shared<MasterContent>();
+    part.content->width = slideWidth;
+    part.content->height = slideHeight;
+
+    const RelationshipMap& rels = masterRels[partName];
+    for (const auto& rel : rels) {
+        if (relationshipIs(rel.second, "slideMaster")) {
+            part.parent = loadMasterPart(rel.second.target);
+            part.content->parent = part.parent->content;
+        }
+    }
+
+    ByteView data;
+    if (!archive.read(partName, data)) return &part;
+
+    SlideProperties props;
+    parseSlideShapes(data, colors, [&](const ShapeRecord& shape) {
+        if (shape.isPlaceholder) {
+            // Prompt shapes are not drawn; slides take their geometry
+            part.placeholders.push_back(shape);
+            inheritPlaceholder(part.placeholders.back(), part.parent);
+        } else {
+            addShape(shape, rels, part.content->objects);
+        }
+    }, &props);
+
+    part.content->showParentShapes = props.showMasterShapes;
+    part.content->hasBackground = props.hasBackground;
+    part.content->background = props.background;
+    return &part;
+}
+
+void PptxImporter::importSlide(Scene& scene, ByteView slideData, const RelationshipMap& rels,
+                               const MasterPart* layout) {
+    std::vector<std::shared_ptr<Object>> objects;
+    SlideProperties props;
+    parseSlideShapes(slideData, colors, [&](const ShapeRecord& shape) {
+        if (shape.isPlaceholder && layout) {
+            ShapeRecord resolved = shape;
+            inheritPlaceholder(resolved, layout);
+            addShape(resolved, rels, objects);
+        } else {
+            addShape(shape, rels, objects);
+        }
+    }, &props);
+
+    for (auto& obj : objects) scene.add(std::move(obj));
+
+    // The slide references the shared layout content; it only gets its own
+    // (empty) layer when it overrides the background or hides master shapes
+    if (props.hasBackground || !props.showMasterShapes) {
+        auto own = std::make_shared<MasterContent>();
+        own->parent = layout ? layout->content : nullptr;
+        own->showParentShapes = props.showMasterShapes;
+        own->hasBackground = props.hasBackground;
+        own->background = props.background;
+        own->width = slideWidth;
+        own->height = slideHeight;
+        scene.addMaster(own);
+    } else if (layout) {
+        scene.addMaster(layout->content);
+    }
+}
+
+// Ids are assigned when the objects are added to the scene
+void PptxImporter::addShape(const ShapeRecord& shape, const RelationshipMap& rels,
+                            std::vector<std::shared_ptr<Object>>& out) {
+    float x = shape.x, y = shape.y, w = shape.w, h = shape.h;
+
+    if (shape.kind == ShapeRecord::Picture) {
+        // Try to load the actual image
+        auto rel = shape.imageRelId.empty() ? rels.end() : rels.find(shape.imageRelId);
+        if (rel != rels.end()) {
+            std::shared_ptr<const ImageData> image = loadImage(rel->second.target);
+            if (image) {
+                if (maxImageDpi > 0) {
+                    ImageUse& use = imageUses[rel->second.target];
+                    use.width = std::max(use.width, w);
+                    use.height = std::max(use.height, h);
+                }
+                out.push_back(std::make_shared<ImageObject>(
+                    0, (int)x, (int)y, (int)w, (int)h, std::move(image)));
+                return;
+            }
+        }
+
+        // Fallback: placeholder rectangle
+        out.push_back(std::make_shared<RectangleObject>(
+            0, (int)x, (int)y, (int)w, (int)h, 0xFF888888));
+        return;
+    }
+
+    if (shape.geometry == ShapeGeometry::Ellipse) {
+        out.push_back(std::make_shared<EllipseObject>(
+            0, (int)x, (int)y, (int)w, (int)h, shape.fill));
+    } else if (shape.geometry == ShapeGeometry::Line) {
+        out.push_back(std::make_shared<LineObject>(
+            0, (int)x, (int)y, (int)(x + w), (int)(y + h), shape.fill, 3));
+    } else {
+        // Default to rectangle
+        out.push_back(std::make_shared<RectangleObject>(
+            0, (int)x, (int)y, (int)w, (int)h, shape.fill));
+    }
+
+    // Text body, if any
+    if (shape.hasText && !shape.text.empty()) {
+        out.push_back(std::make_shared<TextObject>(
+            0,
+            (int)(x + 10), (int)(y + 10),
+            shape.text,
+            shape.textColor,
+            shape.fontSize > 8 ? shape.fontSize : 24.0f
+        ));
+    }
+}
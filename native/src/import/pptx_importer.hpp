@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pptx_archive.hpp"
+#include "slide_parser.hpp"
+#include "../core/image_data.hpp"
+
+class Document;
+class Scene;
+class SceneObject;
+class MasterContent;
+
+using RelationshipMap = std::map<std::string, Relationship>;
+
+// A slide layout or master, parsed once per import.
+// Placeholders are kept as records for slides to inherit from; everything
+// else is built into the shared content.
+struct MasterPart {
+    const MasterPart* parent = nullptr; // layout -> master
+    std::shared_ptr<MasterContent> content;
+    std::vector<ShapeRecord> placeholders; // geometry already inherited from parent
+
+    const ShapeRecord* findPlaceholder(const ShapeRecord& ph) const;
+};
+
+// Converts the slides of a PPTX package into the pages of a document,
+// one page per slide in presentation order
+class PptxImporter {
+public:
+    explicit PptxImporter(Document& document) : document(document) {}
+
+    bool import(const char* filepath);
+
+    // Threads reading pictures; 0 uses every core
+    void setDecodeThreads(unsigned threads) { archive.setMaxWorkers(threads); }
+
+    // Caps each picture at `dpi` pixels per inch of the largest size it is
+    // shown at on a slide (slides are 96 pixels per inch); 0 keeps the full
+    // resolution. Pictures keep their file and are decoded at the capped
+    // size when first drawn, and exports embed JPEGs at full resolution.
+    // Without `keepOriginals`, capped pictures are decoded during import
+    // and only their reduced pixels are kept.
+    void setMaxImageDpi(float dpi, bool keepOriginals = true) {
+        maxImageDpi = dpi;
+        keepImageOriginals = keepOriginals;
+    }
+
+    // Valid after import()
+    int getSlideWidth() const { return slideWidth; }
+    int getSlideHeight() const { return slideHeight; }
+
+private:
+    Document& document;
+    PptxArchive archive;
+    ColorScheme colors;
+    int slideWidth = 960;  // pixels
+    int slideHeight = 540;
+
+    float maxImageDpi = 0;
+    bool keepImageOriginals = true;
+
+    // Pictures by part name; objects showing the same media part share one
+    std::map<std::string, std::shared_ptr<ImageData>> imageCache;
+
+    // Largest extent in pixels each picture is shown at, when capped
+    struct ImageUse {
+        float width = 0;
+        float height = 0;
+    };
+    std::map<std::string, ImageUse> imageUses;
+
+    // Layouts and masters by part name, with their relationships
+    std::map<std::string, MasterPart> masterParts;
+    std::map<std::string, RelationshipMap> masterRels;
+
+    void readImages(const std::vector<std::string>& imagePaths);
+    std::shared_ptr<ImageData> shownImage(std::shared_ptr<ImageData> file) const;
+    void capImages();
+    void collectMasterRels(const std::string& partName, const char* parentKind);
+    const MasterPart* loadMasterPart(const std::string& partName);
+    void importSlide(Scene& scene, ByteView slideData, const RelationshipMap& rels, const MasterPart* layout);
+    void addShape(const ShapeRecord& shape, const RelationshipMap& rels,
+                  std::vector<std::shared_ptr<SceneObject>>& out);
+    std::shared_ptr<const ImageData> loadImage(const std::string& imagePath);
+};
@@ -0,0 +1,182 @@
+#include "slide_parser.hpp"
+#include "perfect_hash.hpp"
+#include "xml_pull_parser.hpp"
+#include <vector>
+
+static constexpr NameEntry<ShapeGeometry> kPresetNames[] = {
+    {"rect", ShapeGeometry::Rect},
+    {"ellipse", ShapeGeometry::Ellipse},
+    {"oval", ShapeGeometry::Ellipse},
+    {"line", ShapeGeometry::Line},
+    {"straightConnector1", ShapeGeometry::Line},
+    {"roundRect", ShapeGeometry::RoundRect},
+    {"triangle", ShapeGeometry::Triangle},
+    {"rtTriangle", ShapeGeometry::Triangle},
+};
+
+static constexpr PerfectHashMap<ShapeGeometry, 32> kPresets(kPresetNames);
+static_assert(kPresets.isPerfect(), "no collision-free seed for the preset geometry table");
+
+ShapeGeometry lookupPresetGeometry(std::string_view prst) {
+    return kPresets.find(prst, ShapeGeometry::Other);
+}
+
+bool parseSlideShapes(ByteView xml, const ColorScheme& scheme,
+                      const std::function<void(const ShapeRecord&)>& emit,
+                      SlideProperties* props) {
+    XmlPullParser xp((const char*)xml.data, xml.size);
+
+    // Open elements; the parent of the current element is path[size - 2]
+    std::vector<XmlTag> path;
+    path.reserve(32);
+    auto ancestor = [&](size_t up) {
+        return path.size() > up ? path[path.size() - 1 - up] : XmlTag::Unknown;
+    };
+
+    int treeDepth = -1;      // depth of p:spTree once found
+    bool inShape = false;
+    bool inRunText = false;
+    bool fillDone = false;
+    ShapeRecord shape;
+
+    while (true) {
+        XmlPullParser::Event ev = xp.next();
+        if (ev == XmlPullParser::EndDocument) return true;
+        if (ev == XmlPullParser::Error) return false;
+
+        if (ev == XmlPullParser::Text) {
+            if (inRunText) XmlPullParser::appendDecoded(xp.text(), shape.text);
+            continue;
+        }
+
+        if (ev == XmlPullParser::EndElement) {
+            XmlTag tag = path.empty() ? XmlTag::Unknown : path.back();
+            if (!path.empty()) path.pop_back();
+
+            if (tag == XmlTag::A_t) {
+                inRunText = false;
+            } else if (tag == XmlTag::A_p && inShape && ancestor(0) == XmlTag::P_txBody) {
+                shape.text += '\n';
+            } else if (inShape && xp.depth() == treeDepth) {
+                // Closing tag of a top-level shape
+                if (shape.hasText && !shape.text.empty() && shape.text.back() == '\n') {
+                    shape.text.pop_back();
+                }
+                emit(shape);
+                inShape = false;
+            } else if (tag == XmlTag::P_spTree && xp.depth() == treeDepth - 1) {
+                return true;
+            }
+            continue;
+        }
+
+        // StartElement
+        XmlTag tag = xp.tag();
+        path.push_back(tag);
+
+        if (treeDepth < 0) {
+            if (tag == XmlTag::P_spTree && ancestor(1) == XmlTag::P_cSld) {
+                treeDepth = xp.depth();
+            } else if (props && path.size() == 1) {
+                props->showMasterShapes = xp.attribute("showMasterSp") != "0";
+            } else if (props && (tag == XmlTag::A_srgbClr || tag == XmlTag::A_schemeClr)) {
+                // p:bg/p:bgPr/a:solidFill/color, or the color of a p:bg/p:bgRef
+                bool solid = ancestor(1) == XmlTag::A_solidFill && ancestor(2) == XmlTag::P_bgPr &&
+                             ancestor(3) == XmlTag::P_bg;
+                bool ref = ancestor(1) == XmlTag::P_bgRef && ancestor(2) == XmlTag::P_bg;
+                std::string_view val = xp.attribute("val");
+                if ((solid || ref) && !val.empty()) {
+                    props->hasBackground = true;
+                    props->background = tag == XmlTag::A_srgbClr
+                        ? 0xFF000000 | xmlHexColor(val)
+                        : scheme.resolve(val, props->background);
+                }
+            }
+            continue;
+        }
+
+        if (!inShape) {
+            if (xp.depth() != treeDepth + 1) continue;
+            if (tag == XmlTag::P_sp || tag == XmlTag::P_pic) {
+                shape = ShapeRecord();
+                shape.kind = tag == XmlTag::P_pic ? ShapeRecord::Picture : ShapeRecord::Shape;
+                inShape = true;
+                fillDone = false;
+            } else {
+                // TODO: Recursively parse group shapes (p:grpSp)
+                // For now, skip groups and other frames
+                xp.skipElement();
+                path.pop_back();
+            }
+            continue;
+        }
+
+        XmlTag parent = ancestor(1);
+        switch (tag) {
+        case XmlTag::A_off:
+            if (parent == XmlTag::A_xfrm && ancestor(2) == XmlTag::P_spPr && !shape.hasOffset) {
+                shape.hasOffset = true;
+                if (xp.hasAttribute("x")) shape.x = emuToPixel(xmlToInt(xp.attribute("x")));
+                if (xp.hasAttribute("y")) shape.y = emuToPixel(xmlToInt(xp.attribute("y")));
+            }
+            break;
+        case XmlTag::A_ext:
+            if (parent == XmlTag::A_xfrm && ancestor(2) == XmlTag::P_spPr && !shape.hasExtent) {
+                shape.hasExtent = true;
+                if (xp.hasAttribute("cx")) shape.w = emuToPixel(xmlToInt(xp.attribute("cx")));
+                if (xp.hasAttribute("cy")) shape.h = emuToPixel(xmlToInt(xp.attribute("cy")));
+            }
+            break;
+        case XmlTag::A_prstGeom:
+            if (parent == XmlTag::P_spPr && xp.hasAttribute("prst")) {
+                shape.geometry = lookupPresetGeometry(xp.attribute("prst"));
+            }
+            break;
+        case XmlTag::A_solidFill:
+            // Shape fill: a solidFill without a known color child keeps the default
+            if (parent == XmlTag::P_spPr && !fillDone) shape.hasFill = true;
+            break;
+        case XmlTag::A_srgbClr:
+        case XmlTag::A_schemeClr: {
+            if (parent != XmlTag::A_solidFill) break;
+            std::string_view val = xp.attribute("val");
+            if (val.empty()) break;
+            XmlTag owner = ancestor(2);
+            if (owner == XmlTag::P_spPr && !fillDone) {
+                shape.fill = tag == XmlTag::A_srgbClr
+                    ? 0xFF000000 | xmlHexColor(val)
+                    : scheme.resolve(val, shape.fill);
+                fillDone = true;
+            } else if (owner == XmlTag::A_rPr) {
+                shape.textColor = tag == XmlTag::A_srgbClr
+                    ? 0xFF000000 | xmlHexColor(val)
+                    : scheme.resolve(val, 0xFF000000);
+            }
+            break;
+        }
+        case XmlTag::P_ph:
+            if (parent == XmlTag::P_nvPr) {
+                shape.isPlaceholder = true;
+                shape.placeholderType.assign(xp.attribute("type"));
+                if (xp.hasAttribute("idx")) shape.placeholderIdx = (int)xmlToInt(xp.attribute("idx"), -1);
+            }
+            break;
+        case XmlTag::P_txBody:
+            if (parent == XmlTag::P_sp) shape.hasText = true;
+            break;
+        case XmlTag::A_rPr:
+            if (parent == XmlTag::A_r && xp.hasAttribute("sz")) {
+                shape.fontSize = (float)xmlToInt(xp.attribute("sz")) / 100.0f; // Size in hundredths of a point
+            }
+            break;
+        case XmlTag::A_t:
+            if (parent == XmlTag::A_r) inRunText = true;
+            break;
+        case XmlTag::A_blip:
+            if (parent == XmlTag::P_blipFill) shape.imageRelId.assign(xp.attribute("r:embed"));
+            break;
+        default:
+            break;
+        }
+    }
+}
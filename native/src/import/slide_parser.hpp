@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "theme.hpp"
+#include "zip_index.hpp"
+
+// Preset geometries the engine distinguishes; everything else draws as a rectangle
+enum class ShapeGeometry : unsigned char {
+    Rect, Ellipse, Line, RoundRect, Triangle, Other
+};
+
+ShapeGeometry lookupPresetGeometry(std::string_view prst);
+
+// Flattened description of one top-level shape of a slide's p:spTree
+struct ShapeRecord {
+    enum Kind { Shape, Picture } kind = Shape;
+
+    bool hasOffset = false;
+    bool hasExtent = false;
+    float x = 0, y = 0, w = 100, h = 100; // pixels
+
+    ShapeGeometry geometry = ShapeGeometry::Rect; // a:prstGeom/@prst
+    bool hasFill = false;
+    uint32_t fill = 0xFFCCCCCC;
+
+    bool hasText = false;                 // p:txBody present
+    std::string text;                     // paragraphs joined with '\n'
+    float fontSize = 24.0f;               // last a:rPr/@sz seen, in points
+    uint32_t textColor = 0xFF000000;
+
+    std::string imageRelId;               // a:blip/@r:embed
+
+    bool isPlaceholder = false;           // p:nvPr/p:ph present
+    std::string placeholderType;          // p:ph/@type, empty if absent
+    int placeholderIdx = -1;              // p:ph/@idx
+};
+
+// Properties of the slide, layout or master part itself
+struct SlideProperties {
+    bool showMasterShapes = true;         // @showMasterSp on the root element
+    bool hasBackground = false;           // p:cSld/p:bg with a solid color
+    uint32_t background = 0xFFFFFFFF;
+};
+
+// Streams the shape tree of a slide, layout or master part and calls `emit`
+// once per shape, as soon as its closing tag is read. No DOM is built.
+bool parseSlideShapes(ByteView xml, const ColorScheme& scheme,
+                      const std::function<void(const ShapeRecord&)>& emit,
+                      SlideProperties* props = nullptr);
+
+// Helper to convert EMU (English Metric Units) to pixels
+// 1 inch = 914400 EMUs.
+// Assuming 96 DPI for simplicity: 1 pixel = 914400 / 96 = 9525 EMUs
+inline float emuToPixel(long long emu) {
+    return (float)emu / 9525.0f;
+}
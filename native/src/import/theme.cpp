@@ -0,0 +1,92 @@
+#include "theme.hpp"
+#include "perfect_hash.hpp"
+#include "xml_pull_parser.hpp"
+
+// Text/background names use the default color map (tx1 = dk1, bg1 = lt1, ...)
+static constexpr NameEntry<SchemeSlot> kSchemeNames[] = {
+    {"dk1", SchemeSlot::Dk1},
+    {"lt1", SchemeSlot::Lt1},
+    {"dk2", SchemeSlot::Dk2},
+    {"lt2", SchemeSlot::Lt2},
+    {"tx1", SchemeSlot::Dk1},
+    {"bg1", SchemeSlot::Lt1},
+    {"tx2", SchemeSlot::Dk2},
+    {"bg2", SchemeSlot::Lt2},
+    {"accent1", SchemeSlot::Accent1},
+    {"accent2", SchemeSlot::Accent2},
+    {"accent3", SchemeSlot::Accent3},
+    {"accent4", SchemeSlot::Accent4},
+    {"accent5", SchemeSlot::Accent5},
+    {"accent6", SchemeSlot::Accent6},
+    {"hlink", SchemeSlot::Hlink},
+    {"folHlink", SchemeSlot::FolHlink},
+};
+
+static constexpr PerfectHashMap<SchemeSlot, 64> kSchemeSlots(kSchemeNames);
+static_assert(kSchemeSlots.isPerfect(), "no collision-free seed for the scheme color table");
+
+SchemeSlot lookupSchemeSlot(std::string_view name) {
+    return kSchemeSlots.find(name, SchemeSlot::None);
+}
+
+ColorScheme::ColorScheme() {
+    colors[(size_t)SchemeSlot::None] = 0;
+    colors[(size_t)SchemeSlot::Dk1] = 0xFF000000;
+    colors[(size_t)SchemeSlot::Lt1] = 0xFFFFFFFF;
+    colors[(size_t)SchemeSlot::Dk2] = 0xFF444444;
+    colors[(size_t)SchemeSlot::Lt2] = 0xFFEEEEEE;
+    colors[(size_t)SchemeSlot::Accent1] = 0xFF4472C4;
+    colors[(size_t)SchemeSlot::Accent2] = 0xFFED7D31;
+    colors[(size_t)SchemeSlot::Accent3] = 0xFFA5A5A5;
+    colors[(size_t)SchemeSlot::Accent4] = 0xFFFFC000;
+    colors[(size_t)SchemeSlot::Accent5] = 0xFF5B9BD5;
+    colors[(size_t)SchemeSlot::Accent6] = 0xFF70AD47;
+    colors[(size_t)SchemeSlot::Hlink] = 0xFF0563C1;
+    colors[(size_t)SchemeSlot::FolHlink] = 0xFF954F72;
+}
+
+uint32_t ColorScheme::resolve(std::string_view name, uint32_t fallback) const {
+    SchemeSlot slot = lookupSchemeSlot(name);
+    return slot == SchemeSlot::None ? fallback : colors[(size_t)slot];
+}
+
+bool parseTheme(ByteView xml, ColorScheme& scheme) {
+    XmlPullParser xp((const char*)xml.data, xml.size);
+
+    bool inScheme = false;
+    int schemeDepth = 0;
+    SchemeSlot slot = SchemeSlot::None;
+
+    while (true) {
+        XmlPullParser::Event ev = xp.next();
+        if (ev == XmlPullParser::Error) return false;
+        if (ev == XmlPullParser::EndDocument) return true;
+
+        if (ev == XmlPullParser::EndElement) {
+            if (inScheme && xp.depth() == schemeDepth) slot = SchemeSlot::None;
+            if (inScheme && xp.tag() == XmlTag::A_clrScheme) return true;
+            continue;
+        }
+        if (ev != XmlPullParser::StartElement) continue;
+
+        if (!inScheme) {
+            if (xp.tag() == XmlTag::A_clrScheme) {
+                inScheme = true;
+                schemeDepth = xp.depth();
+            }
+            continue;
+        }
+
+        if (xp.depth() == schemeDepth + 1) {
+            // a:dk1, a:accent1, ...: slot name without the prefix
+            std::string_view name = xp.name();
+            size_t colon = name.find(':');
+            slot = lookupSchemeSlot(colon == std::string_view::npos ? name : name.substr(colon + 1));
+        } else if (slot != SchemeSlot::None && xp.depth() == schemeDepth + 2) {
+            std::string_view val;
+            if (xp.tag() == XmlTag::A_srgbClr) val = xp.attribute("val");
+            else if (xp.tag() == XmlTag::A_sysClr) val = xp.attribute("lastClr");
+            if (!val.empty()) scheme.colors[(size_t)slot] = 0xFF000000 | xmlHexColor(val);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "zip_index.hpp"
+
+// Theme color slots of a:clrScheme
+enum class SchemeSlot : unsigned char {
+    None,
+    Dk1, Lt1, Dk2, Lt2,
+    Accent1, Accent2, Accent3, Accent4, Accent5, Accent6,
+    Hlink, FolHlink,
+    Count
+};
+
+// Resolved colors of a presentation theme.
+// Defaults match the Office theme until a theme part has been read.
+struct ColorScheme {
+    uint32_t colors[(size_t)SchemeSlot::Count];
+
+    ColorScheme();
+
+    // Resolves an a:schemeClr/@val (tx1, bg2, accent3, ...)
+    uint32_t resolve(std::string_view name, uint32_t fallback) const;
+};
+
+SchemeSlot lookupSchemeSlot(std::string_view name);
+
+// Reads the a:clrScheme of a theme part into `scheme`
+bool parseTheme(ByteView xml, ColorScheme& scheme);
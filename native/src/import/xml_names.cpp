@@ -0,0 +1,48 @@
+#include "xml_names.hpp"
+#include "perfect_hash.hpp"
+
+static constexpr NameEntry<XmlTag> kTagNames[] = {
+    {"p:sld", XmlTag::P_sld},
+    {"p:sldLayout", XmlTag::P_sldLayout},
+    {"p:sldMaster", XmlTag::P_sldMaster},
+    {"p:cSld", XmlTag::P_cSld},
+    {"p:bg", XmlTag::P_bg},
+    {"p:bgPr", XmlTag::P_bgPr},
+    {"p:bgRef", XmlTag::P_bgRef},
+    {"p:spTree", XmlTag::P_spTree},
+    {"p:sp", XmlTag::P_sp},
+    {"p:pic", XmlTag::P_pic},
+    {"p:grpSp", XmlTag::P_grpSp},
+    {"p:cxnSp", XmlTag::P_cxnSp},
+    {"p:nvSpPr", XmlTag::P_nvSpPr},
+    {"p:nvPicPr", XmlTag::P_nvPicPr},
+    {"p:nvPr", XmlTag::P_nvPr},
+    {"p:ph", XmlTag::P_ph},
+    {"p:spPr", XmlTag::P_spPr},
+    {"p:txBody", XmlTag::P_txBody},
+    {"p:blipFill", XmlTag::P_blipFill},
+    {"a:xfrm", XmlTag::A_xfrm},
+    {"a:off", XmlTag::A_off},
+    {"a:ext", XmlTag::A_ext},
+    {"a:prstGeom", XmlTag::A_prstGeom},
+    {"a:solidFill", XmlTag::A_solidFill},
+    {"a:srgbClr", XmlTag::A_srgbClr},
+    {"a:schemeClr", XmlTag::A_schemeClr},
+    {"a:sysClr", XmlTag::A_sysClr},
+    {"a:p", XmlTag::A_p},
+    {"a:r", XmlTag::A_r},
+    {"a:rPr", XmlTag::A_rPr},
+    {"a:t", XmlTag::A_t},
+    {"a:blip", XmlTag::A_blip},
+    {"a:ln", XmlTag::A_ln},
+    {"a:theme", XmlTag::A_theme},
+    {"a:themeElements", XmlTag::A_themeElements},
+    {"a:clrScheme", XmlTag::A_clrScheme},
+};
+
+static constexpr PerfectHashMap<XmlTag, 256> kTags(kTagNames);
+static_assert(kTags.isPerfect(), "no collision-free seed for the element name table");
+
+XmlTag lookupXmlTag(std::string_view name) {
+    return kTags.find(name, XmlTag::Unknown);
+}
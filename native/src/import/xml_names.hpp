@@ -0,0 +1,47 @@
+#pragma once
+#include <string_view>
+
+// Element names the PresentationML / DrawingML readers dispatch on.
+// Names are interned once by the parser so handlers switch on an id
+// instead of comparing strings.
+enum class XmlTag : unsigned char {
+    Unknown,
+    P_sld,
+    P_sldLayout,
+    P_sldMaster,
+    P_cSld,
+    P_bg,
+    P_bgPr,
+    P_bgRef,
+    P_spTree,
+    P_sp,
+    P_pic,
+    P_grpSp,
+    P_cxnSp,
+    P_nvSpPr,
+    P_nvPicPr,
+    P_nvPr,
+    P_ph,
+    P_spPr,
+    P_txBody,
+    P_blipFill,
+    A_xfrm,
+    A_off,
+    A_ext,
+    A_prstGeom,
+    A_solidFill,
+    A_srgbClr,
+    A_schemeClr,
+    A_sysClr,
+    A_p,
+    A_r,
+    A_rPr,
+    A_t,
+    A_blip,
+    A_ln,
+    A_theme,
+    A_themeElements,
+    A_clrScheme,
+};
+
+XmlTag lookupXmlTag(std::string_view name);
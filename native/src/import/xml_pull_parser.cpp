@@ -0,0 +1,231 @@
+#include "xml_pull_parser.hpp"
+#include <cstring>
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool isNameEnd(char c) {
+    return isSpace(c) || c == '>' || c == '/' || c == '=';
+}
+
+XmlPullParser::XmlPullParser(const char* data, size_t size)
+    : cur(data), end(data + size) {
+    attrs.reserve(8);
+}
+
+bool XmlPullParser::skipPast(const char* terminator) {
+    size_t n = strlen(terminator);
+    while (cur + n <= end) {
+        if (memcmp(cur, terminator, n) == 0) {
+            cur += n;
+            return true;
+        }
+        ++cur;
+    }
+    cur = end;
+    return false;
+}
+
+std::string_view XmlPullParser::readName() {
+    const char* start = cur;
+    while (cur < end && !isNameEnd(*cur)) ++cur;
+    return std::string_view(start, (size_t)(cur - start));
+}
+
+XmlPullParser::Event XmlPullParser::next() {
+    if (pendingEnd) {
+        pendingEnd = false;
+        --level;
+        return EndElement;
+    }
+
+    while (cur < end) {
+        if (*cur != '<') {
+            // Text run up to the next tag
+            const char* start = cur;
+            while (cur < end && *cur != '<') ++cur;
+            textRun = std::string_view(start, (size_t)(cur - start));
+            cdata = false;
+            return Text;
+        }
+
+        if (cur + 1 >= end) return Error;
+        char c = cur[1];
+
+        if (c == '/') {
+            cur += 2;
+            elementName = readName();
+            elementTag = lookupXmlTag(elementName);
+            if (!skipPast(">")) return Error;
+            --level;
+            return EndElement;
+        }
+
+        if (c == '?') {
+            if (!skipPast("?>")) return Error;
+            continue;
+        }
+
+        if (c == '!') {
+            if (end - cur >= 4 && memcmp(cur, "<!--", 4) == 0) {
+                if (!skipPast("-->")) return Error;
+                continue;
+            }
+            if (end - cur >= 9 && memcmp(cur, "<![CDATA[", 9) == 0) {
+                const char* start = cur + 9;
+                cur = start;
+                if (!skipPast("]]>")) return Error;
+                textRun = std::string_view(start, (size_t)(cur - 3 - start));
+                cdata = true;
+                return Text;
+            }
+            if (!skipPast(">")) return Error; // DOCTYPE and friends
+            continue;
+        }
+
+        // Start tag
+        ++cur;
+        elementName = readName();
+        elementTag = lookupXmlTag(elementName);
+        attrs.clear();
+
+        while (true) {
+            while (cur < end && isSpace(*cur)) ++cur;
+            if (cur >= end) return Error;
+            if (*cur == '>') {
+                ++cur;
+                break;
+            }
+            if (*cur == '/') {
+                if (cur + 1 >= end || cur[1] != '>') return Error;
+                cur += 2;
+                pendingEnd = true;
+                break;
+            }
+
+            std::string_view attrName = readName();
+            while (cur < end && isSpace(*cur)) ++cur;
+            if (cur >= end || *cur != '=') return Error;
+            ++cur;
+            while (cur < end && isSpace(*cur)) ++cur;
+            if (cur >= end || (*cur != '"' && *cur != '\'')) return Error;
+            char quote = *cur++;
+            const char* valueStart = cur;
+            while (cur < end && *cur != quote) ++cur;
+            if (cur >= end) return Error;
+            attrs.emplace_back(attrName, std::string_view(valueStart, (size_t)(cur - valueStart)));
+            ++cur;
+        }
+
+        ++level;
+        return StartElement;
+    }
+
+    return EndDocument;
+}
+
+std::string_view XmlPullParser::attribute(std::string_view attrName) const {
+    for (const auto& a : attrs) {
+        if (a.first == attrName) return a.second;
+    }
+    return std::string_view();
+}
+
+bool XmlPullParser::hasAttribute(std::string_view attrName) const {
+    for (const auto& a : attrs) {
+        if (a.first == attrName) return true;
+    }
+    return false;
+}
+
+void XmlPullParser::skipElement() {
+    int target = level - 1;
+    while (level > target) {
+        Event e = next();
+        if (e == EndDocument || e == Error) return;
+    }
+}
+
+static void appendUtf8(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+void XmlPullParser::appendDecoded(std::string_view raw, std::string& out) {
+    size_t i = 0;
+    while (i < raw.size()) {
+        size_t amp = raw.find('&', i);
+        if (amp == std::string_view::npos) {
+            out.append(raw.data() + i, raw.size() - i);
+            return;
+        }
+        out.append(raw.data() + i, amp - i);
+
+        size_t semi = raw.find(';', amp);
+        if (semi == std::string_view::npos) {
+            out.append(raw.data() + amp, raw.size() - amp);
+            return;
+        }
+
+        std::string_view ent = raw.substr(amp + 1, semi - amp - 1);
+        if (ent == "amp") out += '&';
+        else if (ent == "lt") out += '<';
+        else if (ent == "gt") out += '>';
+        else if (ent == "quot") out += '"';
+        else if (ent == "apos") out += '\'';
+        else if (!ent.empty() && ent[0] == '#') {
+            uint32_t cp = 0;
+            bool hex = ent.size() > 1 && (ent[1] == 'x' || ent[1] == 'X');
+            for (size_t k = hex ? 2 : 1; k < ent.size(); ++k) {
+                char ch = ent[k];
+                if (hex) {
+                    cp = cp * 16 + (uint32_t)(ch >= 'a' ? ch - 'a' + 10 : ch >= 'A' ? ch - 'A' + 10 : ch - '0');
+                } else {
+                    cp = cp * 10 + (uint32_t)(ch - '0');
+                }
+            }
+            appendUtf8(cp, out);
+        } else {
+            out.append(raw.data() + amp, semi - amp + 1); // Unknown entity, keep as is
+        }
+        i = semi + 1;
+    }
+}
+
+long long xmlToInt(std::string_view v, long long fallback) {
+    size_t i = 0;
+    while (i < v.size() && isSpace(v[i])) ++i;
+    bool neg = false;
+    if (i < v.size() && (v[i] == '-' || v[i] == '+')) neg = v[i++] == '-';
+    if (i >= v.size() || v[i] < '0' || v[i] > '9') return fallback;
+    long long n = 0;
+    for (; i < v.size() && v[i] >= '0' && v[i] <= '9'; ++i) n = n * 10 + (v[i] - '0');
+    return neg ? -n : n;
+}
+
+uint32_t xmlHexColor(std::string_view v) {
+    uint32_t rgb = 0;
+    for (char ch : v) {
+        uint32_t d;
+        if (ch >= '0' && ch <= '9') d = (uint32_t)(ch - '0');
+        else if (ch >= 'a' && ch <= 'f') d = (uint32_t)(ch - 'a' + 10);
+        else if (ch >= 'A' && ch <= 'F') d = (uint32_t)(ch - 'A' + 10);
+        else break;
+        rgb = (rgb << 4) | d;
+    }
+    return rgb & 0xFFFFFF;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "xml_names.hpp"
+
+// Forward-only XML reader over an in-memory buffer.
+// No tree is built: each call to next() reports one start tag, end tag or
+// text run, with names and values as views into the input. Self-closing
+// elements report a StartElement followed by a matching EndElement.
+class XmlPullParser {
+public:
+    enum Event { StartElement, EndElement, Text, EndDocument, Error };
+
+    XmlPullParser(const char* data, size_t size);
+
+    Event next();
+
+    // Current element (StartElement / EndElement)
+    std::string_view name() const { return elementName; }
+    XmlTag tag() const { return elementTag; }
+    int depth() const { return level; }
+
+    // Raw attribute value of the current start tag, empty if absent
+    std::string_view attribute(std::string_view attrName) const;
+    bool hasAttribute(std::string_view attrName) const;
+
+    // Current text run (Text); entities are not decoded
+    std::string_view text() const { return textRun; }
+    bool textIsCData() const { return cdata; }
+
+    // Skips to the end tag of the current start element
+    void skipElement();
+
+    // Appends `raw` to `out`, decoding the predefined and numeric entities
+    static void appendDecoded(std::string_view raw, std::string& out);
+
+private:
+    const char* cur;
+    const char* end;
+    int level = 0;
+    bool pendingEnd = false;
+    bool cdata = false;
+
+    std::string_view elementName;
+    XmlTag elementTag = XmlTag::Unknown;
+    std::string_view textRun;
+    std::vector<std::pair<std::string_view, std::string_view>> attrs;
+
+    bool skipPast(const char* terminator);
+    std::string_view readName();
+};
+
+// Attribute value helpers (values are views, not NUL-terminated)
+long long xmlToInt(std::string_view v, long long fallback = 0);
+uint32_t xmlHexColor(std::string_view v);
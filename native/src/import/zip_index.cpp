@@ -0,0 +1,153 @@
+#include "zip_index.hpp"
+#include <algorithm>
+#include <cstring>
+
+#define MINIZ_HEADER_FILE_ONLY
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "miniz.h"
+
+static const uint32_t kLocalHeaderSig = 0x04034b50;
+static const uint32_t kCentralHeaderSig = 0x02014b50;
+static const uint32_t kEndOfDirSig = 0x06054b50;
+static const uint32_t kZip64LocatorSig = 0x07064b50;
+static const uint32_t kZip64EndOfDirSig = 0x06064b50;
+static const size_t kCentralHeaderSize = 46;
+// Deflate expands at most about 1032:1; a member claiming more is corrupt
+static const uint64_t kMaxDeflateRatio = 1032;
+static const uint64_t kMaxEntrySize = 1ull << 30;
+
+static uint16_t readU16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t readU32(const uint8_t* p) { return (uint32_t)readU16(p) | ((uint32_t)readU16(p + 2) << 16); }
+static uint64_t readU64(const uint8_t* p) { return (uint64_t)readU32(p) | ((uint64_t)readU32(p + 4) << 32); }
+
+bool ZipIndex::load(const uint8_t* archive, size_t size) {
+    clear();
+
+    if (!archive || size < 22) return false;
+
+    // End of central directory: 22 bytes plus an optional comment of up to 64 KiB
+    size_t tailLen = std::min<size_t>(size, 22 + 0xFFFF);
+    const uint8_t* tail = archive + (size - tailLen);
+
+    long eocd = -1;
+    for (long i = (long)tailLen - 22; i >= 0; --i) {
+        if (readU32(&tail[i]) == kEndOfDirSig) { eocd = i; break; }
+    }
+    if (eocd < 0) return false;
+
+    uint64_t count = readU16(&tail[eocd + 10]);
+    uint64_t dirSize = readU32(&tail[eocd + 12]);
+    uint64_t dirOffset = readU32(&tail[eocd + 16]);
+
+    // Zip64 archives keep the real values in a separate record
+    if (eocd >= 20 && readU32(&tail[eocd - 20]) == kZip64LocatorSig) {
+        uint64_t z64Offset = readU64(&tail[eocd - 20 + 8]);
+        const uint8_t* z64 = archive + (z64Offset < size ? z64Offset : 0);
+        if (size >= 56 && z64Offset <= size - 56 && readU32(z64) == kZip64EndOfDirSig) {
+            count = readU64(z64 + 32);
+            dirSize = readU64(z64 + 40);
+            dirOffset = readU64(z64 + 48);
+        }
+    }
+
+    if (dirOffset > size || dirSize > size - dirOffset) return false;
+
+    const uint8_t* dir = archive + dirOffset;
+
+    // The count is only a hint: no more records fit than the directory holds
+    count = std::min<uint64_t>(count, dirSize / kCentralHeaderSize);
+    entries.reserve((size_t)count);
+    byName.reserve((size_t)count);
+
+    size_t pos = 0;
+    while (pos + kCentralHeaderSize <= dirSize && readU32(&dir[pos]) == kCentralHeaderSig) {
+        const uint8_t* rec = &dir[pos];
+        uint16_t nameLen = readU16(rec + 28);
+        uint16_t extraLen = readU16(rec + 30);
+        uint16_t commentLen = readU16(rec + 32);
+        if (pos + 46 + nameLen + extraLen + commentLen > dirSize) break;
+
+        ZipEntry e;
+        e.method = readU16(rec + 10);
+        e.crc32 = readU32(rec + 16);
+        e.compressedSize = readU32(rec + 20);
+        e.size = readU32(rec + 24);
+        e.headerOffset = readU32(rec + 42);
+        e.name.assign((const char*)rec + 46, nameLen);
+
+        // Zip64 extended information replaces saturated 32-bit fields, in order
+        const uint8_t* extra = rec + 46 + nameLen;
+        size_t ep = 0;
+        while (ep + 4 <= extraLen) {
+            uint16_t id = readU16(extra + ep);
+            uint16_t len = readU16(extra + ep + 2);
+            if (ep + 4 + len > extraLen) break;
+            if (id == 0x0001) {
+                const uint8_t* f = extra + ep + 4;
+                const uint8_t* fEnd = f + len;
+                if (e.size == 0xFFFFFFFF && f + 8 <= fEnd) { e.size = readU64(f); f += 8; }
+                if (e.compressedSize == 0xFFFFFFFF && f + 8 <= fEnd) { e.compressedSize = readU64(f); f += 8; }
+                if (e.headerOffset == 0xFFFFFFFF && f + 8 <= fEnd) { e.headerOffset = readU64(f); }
+            }
+            ep += 4 + len;
+        }
+
+        bool isDir = !e.name.empty() && e.name.back() == '/';
+        if (!isDir) {
+            byName.emplace(e.name, entries.size());
+            entries.push_back(std::move(e));
+        }
+        pos += 46 + nameLen + extraLen + commentLen;
+    }
+
+    return true;
+}
+
+void ZipIndex::clear() {
+    entries.clear();
+    byName.clear();
+}
+
+const ZipEntry* ZipIndex::find(const std::string& name) const {
+    auto it = byName.find(name);
+    return it == byName.end() ? nullptr : &entries[it->second];
+}
+
+void ZipReader::attach(const uint8_t* archive, size_t archiveSize) {
+    base = archive;
+    length = archiveSize;
+}
+
+bool ZipReader::read(const ZipEntry& entry, ByteView& out) {
+    if (!base || entry.headerOffset > length || length - entry.headerOffset < 30) return false;
+
+    const uint8_t* header = base + entry.headerOffset;
+    if (readU32(header) != kLocalHeaderSig) return false;
+
+    // The local extra field may differ from the central one
+    uint64_t dataOffset = entry.headerOffset + 30 + readU16(header + 26) + readU16(header + 28);
+    if (dataOffset > length || entry.compressedSize > length - dataOffset) return false;
+    const uint8_t* data = base + dataOffset;
+
+    if (entry.method == 0) {
+        if (entry.compressedSize != entry.size) return false;
+        out.data = data;
+        out.size = (size_t)entry.size;
+    } else if (entry.method == 8) {
+        if (entry.size > kMaxEntrySize || entry.size > entry.compressedSize * kMaxDeflateRatio + 64) return false;
+        if (scratch.size() < entry.size) scratch.resize((size_t)entry.size);
+        size_t n = tinfl_decompress_mem_to_mem(scratch.data(), (size_t)entry.size,
+                                               data, (size_t)entry.compressedSize, 0);
+        if (n != entry.size) return false;
+        out.data = scratch.data();
+        out.size = n;
+    } else {
+        return false; // Unsupported compression
+    }
+
+    return mz_crc32(MZ_CRC32_INIT, out.data, out.size) == entry.crc32;
+}
+
+void ZipReader::releaseScratch() {
+    std::vector<uint8_t>().swap(scratch);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Non-owning byte range
+struct ByteView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Central directory record of one archive member
+struct ZipEntry {
+    std::string name;
+    uint64_t headerOffset = 0;   // local file header
+    uint64_t compressedSize = 0;
+    uint64_t size = 0;
+    uint32_t crc32 = 0;
+    uint16_t method = 0;         // 0 = stored, 8 = deflate
+};
+
+// Central directory of a zip archive, hashed by entry name.
+// Built once per archive and shared read-only between readers.
+class ZipIndex {
+public:
+    bool load(const uint8_t* archive, size_t archiveSize);
+    void clear();
+
+    const ZipEntry* find(const std::string& name) const;
+    const std::vector<ZipEntry>& all() const { return entries; }
+
+private:
+    std::vector<ZipEntry> entries;
+    std::unordered_map<std::string, size_t> byName;
+};
+
+// Resolves members of an archive held in memory (usually a MappedFile).
+// Stored members are returned in place without copying; deflated members
+// inflate into a scratch buffer reused across reads. Use one reader per
+// worker thread; they can all share the same mapping.
+class ZipReader {
+public:
+    ZipReader() = default;
+    ZipReader(const uint8_t* archive, size_t archiveSize) : base(archive), length(archiveSize) {}
+
+    void attach(const uint8_t* archive, size_t archiveSize);
+
+    // The view stays valid until the next read on this reader
+    bool read(const ZipEntry& entry, ByteView& out);
+
+    void releaseScratch();
+
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+    std::vector<uint8_t> scratch;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Bounds-checked reads of packed little-endian fields from a byte buffer
+struct ByteReader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    size_t remaining() const { return (size_t)(end - p); }
+
+    template <typename T>
+    bool get(T& v) {
+        if (remaining() < sizeof(T)) return false;
+        memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool getBytes(std::string& out, size_t size) {
+        if (remaining() < size) return false;
+        out.assign((const char*)p, size);
+        p += size;
+        return true;
+    }
+};
@@ -0,0 +1,178 @@
+#include "command_batch.hpp"
+#include "byte_reader.hpp"
+#include "../core/scene.hpp"
+#include "../objects/rect_object.hpp"
+#include "../objects/text_object.hpp"
+#include "../objects/image_object.hpp"
+#include "../objects/ellipse_object.hpp"
+#include "../objects/line_object.hpp"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BatchCommand {
+    uint8_t op;
+    int32_t id = 0;
+    int32_t index = 0;
+    float f[4] = {};
+    uint32_t color = 0;
+    bool flag = false;
+    std::string text;
+    std::shared_ptr<Object> object; // built while decoding adds
+};
+
+static bool getFloats(ByteReader& in, float* f, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (!in.get(f[i])) return false;
+    }
+    return true;
+}
+
+static bool getString(ByteReader& in, std::string& out) {
+    uint32_t size;
+    return in.get(size) && in.getBytes(out, size);
+}
+
+// Reads an object id; batch-relative ids must name an add already decoded
+static bool getId(ByteReader& in, int32_t& id, int added) {
+    if (!in.get(id)) return false;
+    return id >= 0 || -(int64_t)id <= added;
+}
+
+static bool decodeCommand(ByteReader& in, BatchCommand& cmd, int added) {
+    if (!in.get(cmd.op)) return false;
+    float* f = cmd.f;
+
+    switch (cmd.op) {
+    case BatchAddRect:
+    case BatchAddEllipse:
+        if (!getFloats(in, f, 4) || !in.get(cmd.color)) return false;
+        if (cmd.op == BatchAddRect) {
+            cmd.object = std::make_shared<RectangleObject>(0, f[0], f[1], f[2], f[3], cmd.color);
+        } else {
+            cmd.object = std::make_shared<EllipseObject>(0, f[0], f[1], f[2], f[3], cmd.color);
+        }
+        return true;
+    case BatchAddLine: {
+        float thickness;
+        if (!getFloats(in, f, 4) || !in.get(cmd.color) || !in.get(thickness)) return false;
+        cmd.object = std::make_shared<LineObject>(0, f[0], f[1], f[2], f[3], cmd.color, thickness);
+        return true;
+    }
+    case BatchAddText:
+        if (!getFloats(in, f, 2) || !in.get(cmd.color) || !in.get(f[2]) ||
+            !getString(in, cmd.text)) {
+            return false;
+        }
+        cmd.object = std::make_shared<TextObject>(0, f[0], f[1], cmd.text, cmd.color, f[2]);
+        return true;
+    case BatchAddImage: {
+        int32_t imgW, imgH;
+        if (!getFloats(in, f, 4) || !in.get(imgW) || !in.get(imgH) || imgW <= 0 || imgH <= 0 ||
+            (uint64_t)in.remaining() < (uint64_t)imgW * imgH * sizeof(uint32_t)) {
+            return false;
+        }
+        // The stream is not pixel aligned
+        std::vector<uint32_t> pixels((size_t)imgW * imgH);
+        memcpy(pixels.data(), in.p, pixels.size() * sizeof(uint32_t));
+        in.p += pixels.size() * sizeof(uint32_t);
+        cmd.object = std::make_shared<ImageObject>(0, f[0], f[1], f[2], f[3],
+                                                   makeImageData(std::move(pixels), imgW, imgH));
+        return true;
+    }
+    case BatchMoveObject:
+        return getId(in, cmd.id, added) && getFloats(in, f, 2);
+    case BatchMoveSelection:
+        return getFloats(in, f, 2);
+    case BatchSetObjectRect:
+        return getId(in, cmd.id, added) && getFloats(in, f, 4);
+    case BatchSetObjectColor:
+        return getId(in, cmd.id, added) && in.get(cmd.color);
+    case BatchSetObjectText:
+        return getId(in, cmd.id, added) && getString(in, cmd.text);
+    case BatchSetObjectFontSize:
+        return getId(in, cmd.id, added) && in.get(f[0]);
+    case BatchRemoveObject:
+        return getId(in, cmd.id, added);
+    case BatchSelectObject: {
+        uint8_t add;
+        if (!getId(in, cmd.id, added) || !in.get(add)) return false;
+        cmd.flag = add != 0;
+        return true;
+    }
+    case BatchClearSelection:
+        return true;
+    case BatchReorderObject:
+        return getId(in, cmd.id, added) && in.get(cmd.index);
+    default:
+        return false;
+    }
+}
+
+int executeBatch(Scene& scene, const uint8_t* cmds, size_t len, int32_t* ids, int cap) {
+    std::vector<BatchCommand> batch;
+    ByteReader in{cmds, cmds + len};
+    int added = 0;
+    while (in.remaining() > 0) {
+        BatchCommand cmd;
+        if (!decodeCommand(in, cmd, added)) {
+            printf("Error: Malformed command batch at byte %zu\n", len - in.remaining());
+            return -1;
+        }
+        if (cmd.object) ++added;
+        batch.push_back(std::move(cmd));
+    }
+
+    std::vector<int32_t> uids;
+    uids.reserve(added);
+    for (BatchCommand& cmd : batch) {
+        int uid = cmd.id >= 0 ? cmd.id : uids[-cmd.id - 1];
+        const float* f = cmd.f;
+
+        switch (cmd.op) {
+        case BatchAddRect:
+        case BatchAddEllipse:
+        case BatchAddLine:
+        case BatchAddText:
+        case BatchAddImage:
+            uids.push_back(scene.add(std::move(cmd.object)));
+            break;
+        case BatchMoveObject:
+            scene.moveObject(uid, f[0], f[1]);
+            break;
+        case BatchMoveSelection:
+            scene.moveSelection(f[0], f[1]);
+            break;
+        case BatchSetObjectRect:
+            scene.updateObjectRect(uid, f[0], f[1], f[2], f[3]);
+            break;
+        case BatchSetObjectColor:
+            scene.updateObjectColor(uid, cmd.color);
+            break;
+        case BatchSetObjectText:
+            scene.updateObjectText(uid, cmd.text.c_str());
+            break;
+        case BatchSetObjectFontSize:
+            scene.updateObjectFontSize(uid, f[0]);
+            break;
+        case BatchRemoveObject:
+            scene.removeObject(uid);
+            break;
+        case BatchSelectObject:
+            scene.select(uid, cmd.flag);
+            break;
+        case BatchClearSelection:
+            scene.clearSelection();
+            break;
+        case BatchReorderObject:
+            scene.reorderObject(uid, cmd.index);
+            break;
+        }
+    }
+
+    if (ids) {
+        for (int i = 0; i < added && i < cap; ++i) ids[i] = uids[i];
+    }
+    return added;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class Scene;
+
+// Binary command stream for engine_execute_batch.
+//
+// Each command is a one-byte opcode followed by its arguments, packed and
+// little-endian, in the order of the matching engine_* call (f32 for
+// coordinates and sizes, u32 for colors, i32 for ids). Strings are a u32
+// byte count then the UTF-8 bytes; image pixels are imgW * imgH BGRA words.
+//
+// An id below zero refers to an object added earlier in the same batch:
+// -1 is the first one, -2 the second, and so on. This lets a paste set up
+// the objects it creates without a round trip.
+enum BatchOp : uint8_t {
+    BatchAddRect = 1,          // x, y, w, h, color
+    BatchAddEllipse = 2,       // x, y, w, h, color
+    BatchAddLine = 3,          // x1, y1, x2, y2, color, thickness
+    BatchAddText = 4,          // x, y, color, size, text
+    BatchAddImage = 5,         // x, y, w, h, i32 imgW, i32 imgH, pixels
+    BatchMoveObject = 6,       // id, dx, dy
+    BatchMoveSelection = 7,    // dx, dy
+    BatchSetObjectRect = 8,    // id, x, y, w, h
+    BatchSetObjectColor = 9,   // id, color
+    BatchSetObjectText = 10,   // id, text
+    BatchSetObjectFontSize = 11, // id, size
+    BatchRemoveObject = 12,    // id
+    BatchSelectObject = 13,    // id, u8 addToSelection
+    BatchClearSelection = 14,  // (none)
+    BatchReorderObject = 15,   // id, i32 index
+};
+
+// Decodes the whole stream before touching the scene, so a malformed
+// stream changes nothing. Returns the number of objects added, writing the
+// first `cap` of their uids to `ids`, or -1 if the stream is malformed.
+int executeBatch(Scene& scene, const uint8_t* cmds, size_t len, int32_t* ids, int cap);
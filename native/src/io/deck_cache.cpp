@@ -0,0 +1,115 @@
+#include "deck_cache.hpp"
+#include "document_file.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const char* kEntryExtension = ".krl";
+// Part of every key; bumped when imports change shape, so entries written
+// by older builds (slides flattened into one page, pictures stored decoded)
+// age out unused
+static const uint32_t kImportVersion = 3;
+
+static uint64_t fnv1a64(const void* data, size_t size, uint64_t h = 14695981039346656037ull) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void DeckCache::configure(const char* dir, uint64_t cap) {
+    directory = dir ? dir : "";
+    maxBytes = cap;
+    if (directory.empty()) return;
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        printf("Error: Could not create cache directory: %s\n", directory.c_str());
+        directory.clear();
+        return;
+    }
+    evict();
+}
+
+std::string DeckCache::entryFor(const char* pptxPath) const {
+    std::error_code ec;
+    fs::path path = fs::canonical(pptxPath, ec);
+    if (ec) return "";
+
+    uint64_t size = fs::file_size(path, ec);
+    if (ec) return "";
+    auto mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) return "";
+
+    std::string name = path.string();
+    uint64_t h = fnv1a64(name.data(), name.size());
+    h = fnv1a64(&size, sizeof(size), h);
+    h = fnv1a64(&mtime, sizeof(mtime), h);
+    h = fnv1a64(&kImportVersion, sizeof(kImportVersion), h);
+    if (importSettings) h = fnv1a64(&importSettings, sizeof(importSettings), h);
+
+    char file[32];
+    snprintf(file, sizeof(file), "%016llx%s", (unsigned long long)h, kEntryExtension);
+    return (fs::path(directory) / file).string();
+}
+
+bool DeckCache::load(Document& document, const char* pptxPath) {
+    if (!enabled()) return false;
+
+    std::string entry = entryFor(pptxPath);
+    std::error_code ec;
+    if (entry.empty() || !fs::exists(entry, ec)) return false;
+
+    if (!openDocument(document, entry.c_str())) {
+        fs::remove(entry, ec); // Stale format or damaged entry
+        return false;
+    }
+
+    // The modification time is the LRU clock
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+void DeckCache::store(const Document& document, const char* pptxPath) {
+    if (!enabled()) return;
+
+    std::string entry = entryFor(pptxPath);
+    if (entry.empty() || !saveDocument(document, entry.c_str())) return;
+    evict();
+}
+
+void DeckCache::evict() {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t size;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(directory, ec)) {
+        if (item.path().extension() != kEntryExtension) continue;
+        std::error_code itemEc;
+        Entry e{item.path(), item.last_write_time(itemEc), item.file_size(itemEc)};
+        if (itemEc) continue;
+        total += e.size;
+        entries.push_back(std::move(e));
+    }
+    if (total <= maxBytes) return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.used < b.used; });
+
+    // Entries still mapped elsewhere may refuse removal (Windows); skip them
+    for (const Entry& e : entries) {
+        if (total <= maxBytes) break;
+        if (fs::remove(e.path, ec)) total -= e.size;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+class Document;
+
+// On-disk cache of imported decks.
+//
+// Each entry is a native document (see document_file.hpp) named after a
+// hash of the PPTX path, size and modification time, so a warm open maps
+// the entry instead of parsing the package. Pictures are stored as the
+// files the import kept, so writing an entry decodes nothing and warm opens
+// decode as lazily as cold ones. Entries are
+// touched on every hit and the least recently used ones are evicted once
+// the directory grows past its size cap. Edited packages get a new key;
+// their stale entries simply age out.
+class DeckCache {
+public:
+    void configure(const char* directory, uint64_t maxBytes);
+    bool enabled() const { return !directory.empty(); }
+    // Import options that change what an import produces (e.g. the picture
+    // resolution cap) are part of the key, so entries never mix settings
+    void setImportSettings(uint64_t settings) { importSettings = settings; }
+
+    bool load(Document& document, const char* pptxPath);
+    void store(const Document& document, const char* pptxPath);
+
+private:
+    std::string directory;
+    uint64_t maxBytes = 0;
+    uint64_t importSettings = 0;
+
+    std::string entryFor(const char* pptxPath) const;
+    void evict();
+};
@@ -0,0 +1,487 @@
+#include "document_file.hpp"
+#include "../core/document.hpp"
+#include "../core/mapped_file.hpp"
+#include "object_record.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// All records are stored in native (little-endian) byte order
+static const char kMagic[8] = {'K', 'R', 'L', 'D', 'O', 'C', '\r', '\n'};
+static const uint32_t kVersion = 3;
+static const uint64_t kPixelAlign = 64;
+// Pages cost memory but no file bytes, so their count is bounded on its own
+static const uint32_t kMaxPages = 1u << 16;
+
+struct DocHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t layerCount;
+    uint32_t objectCount;
+    uint32_t imageCount;
+    uint32_t checkpoint;  // id shared with the journal over this document, or 0
+    uint64_t layersOffset;
+    uint64_t objectsOffset;
+    uint64_t imagesOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t fileSize;
+    // Version 2
+    uint32_t pageCount;
+    uint32_t pageLayerCount;
+    uint64_t pageLayersOffset;
+    // Version 3
+    uint64_t imageFilesOffset;
+};
+
+static const uint32_t kHeaderSizeV1 = 80;
+static const uint32_t kHeaderSizeV2 = 96;
+
+// MasterContent; parents always precede their children
+struct LayerRecord {
+    int32_t parent;       // -1 for none
+    uint32_t flags;
+    uint32_t background;
+    int32_t width;
+    int32_t height;
+    uint32_t reserved;
+};
+
+static const uint32_t kLayerInScene = 1;       // version 1: drawn by the (only) page
+static const uint32_t kLayerShowParent = 2;
+static const uint32_t kLayerHasBackground = 4;
+
+struct ImageRecord {
+    int32_t width;
+    int32_t height;
+    uint64_t pixelOffset; // kPixelAlign aligned
+};
+
+// Version 3: how each image is stored, in image record order. Pictures
+// not decoded yet are stored as their file, so saving does not decode them
+// and they open as undecoded as they were saved.
+struct ImageFileRecord {
+    uint64_t size;      // bytes of the file at pixelOffset; 0 for BGRA pixels
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+// The file is the original of a copy reduced to the record's size
+static const uint32_t kImageReduced = 1;
+
+// A layer a page draws directly, in drawing order
+struct PageLayerRecord {
+    int32_t page;
+    int32_t layer;
+};
+
+static_assert(sizeof(DocHeader) == 104, "document header layout");
+static_assert(sizeof(ImageFileRecord) == 16, "image file record layout");
+static_assert(sizeof(PageLayerRecord) == 8, "page layer record layout");
+static_assert(sizeof(LayerRecord) == 24, "layer record layout");
+static_assert(sizeof(ImageRecord) == 16, "image record layout");
+
+// Pictures opened in place, by the document they map. A mapped file cannot
+// be replaced on Windows, so saving over a document first gives its
+// pictures pixels of their own. Elsewhere the rename replaces the name
+// only and the mapping keeps reading the old file.
+#ifdef _WIN32
+static const bool kMappingBlocksReplace = true;
+#else
+static const bool kMappingBlocksReplace = false;
+#endif
+static std::mutex openedMutex;
+static std::map<std::string, std::vector<std::weak_ptr<const ImageData>>> openedImages;
+
+static std::string documentKey(const char* path) {
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+    return ec ? std::string(path) : canonical.string();
+}
+
+static void releaseMapping(const char* path) {
+    std::lock_guard<std::mutex> lock(openedMutex);
+    auto it = openedImages.find(documentKey(path));
+    if (it == openedImages.end()) return;
+    for (const auto& weak : it->second) {
+        if (auto image = weak.lock()) image->ownPixels();
+    }
+    openedImages.erase(it);
+}
+
+static uint64_t alignUp(uint64_t v, uint64_t a) {
+    return (v + a - 1) / a * a;
+}
+
+static bool writePadding(FILE* f, uint64_t from, uint64_t to) {
+    static const char zeros[kPixelAlign] = {};
+    while (from < to) {
+        size_t n = (size_t)std::min<uint64_t>(to - from, sizeof(zeros));
+        if (fwrite(zeros, 1, n, f) != n) return false;
+        from += n;
+    }
+    return true;
+}
+
+// Collects the records of a scene before anything is written
+struct DocWriter {
+    std::vector<LayerRecord> layers;
+    std::vector<ObjectRecord> objects;
+    std::vector<ImageRecord> images;
+    std::vector<ImageFileRecord> imageFiles;
+    std::vector<PageLayerRecord> pageLayers;
+    std::vector<const ImageData*> imagePixels;
+    std::string strings;
+
+    std::map<const MasterContent*, int> layerIndex;
+    std::map<const ImageData*, int> imageIndex;
+
+    int addLayer(const MasterContent* layer) {
+        auto it = layerIndex.find(layer);
+        if (it != layerIndex.end()) return it->second;
+
+        LayerRecord rec = {};
+        rec.parent = layer->parent ? addLayer(layer->parent.get()) : -1;
+        rec.flags = (layer->showParentShapes ? kLayerShowParent : 0) |
+                    (layer->hasBackground ? kLayerHasBackground : 0);
+        rec.background = layer->background;
+        rec.width = layer->width;
+        rec.height = layer->height;
+
+        int index = (int)layers.size();
+        layers.push_back(rec);
+        layerIndex[layer] = index;
+        for (const auto& obj : layer->objects) addObject(*obj, index);
+        return index;
+    }
+
+    int addImage(const ImageData* image) {
+        auto it = imageIndex.find(image);
+        if (it != imageIndex.end()) return it->second;
+
+        ImageRecord rec = {};
+        rec.width = image->width;
+        rec.height = image->height;
+        ImageFileRecord file = {};
+        if (image->isLazy()) {
+            file.size = image->source().encoded.size();
+            file.flags = image->original ? kImageReduced : 0;
+        }
+        int index = (int)images.size();
+        images.push_back(rec);
+        imageFiles.push_back(file);
+        imagePixels.push_back(image);
+        imageIndex[image] = index;
+        return index;
+    }
+
+    // `layer` is a layer record, or -1 - page for objects of a page
+    void addObject(Object& obj, int layer) {
+        ObjectRecord rec;
+        const ImageData* image = encodeObject(obj, rec, strings);
+        rec.layer = layer;
+        if (image) rec.image = addImage(image);
+        objects.push_back(rec);
+    }
+};
+
+bool saveDocument(const Document& document, const char* path, uint32_t checkpoint) {
+    if (document.pageCount() > kMaxPages) {
+        printf("Error: Too many pages to save: %s\n", path);
+        return false;
+    }
+
+    DocWriter doc;
+    for (size_t p = 0; p < document.pageCount(); ++p) {
+        const Scene& scene = document.page(p).scene;
+        for (const auto& master : scene.masters) {
+            doc.pageLayers.push_back(PageLayerRecord{(int32_t)p, doc.addLayer(master.get())});
+        }
+        for (const auto& obj : scene.objects) doc.addObject(*obj, -1 - (int)p);
+    }
+
+    DocHeader header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(DocHeader);
+    header.layerCount = (uint32_t)doc.layers.size();
+    header.objectCount = (uint32_t)doc.objects.size();
+    header.imageCount = (uint32_t)doc.images.size();
+    header.checkpoint = checkpoint;
+    header.layersOffset = sizeof(DocHeader);
+    header.objectsOffset = header.layersOffset + doc.layers.size() * sizeof(LayerRecord);
+    header.imagesOffset = header.objectsOffset + doc.objects.size() * sizeof(ObjectRecord);
+    header.pageCount = (uint32_t)document.pageCount();
+    header.pageLayerCount = (uint32_t)doc.pageLayers.size();
+    header.pageLayersOffset = header.imagesOffset + doc.images.size() * sizeof(ImageRecord);
+    header.imageFilesOffset = header.pageLayersOffset + doc.pageLayers.size() * sizeof(PageLayerRecord);
+    header.stringsOffset = header.imageFilesOffset + doc.imageFiles.size() * sizeof(ImageFileRecord);
+    header.stringsSize = doc.strings.size();
+
+    uint64_t offset = header.stringsOffset + header.stringsSize;
+    for (size_t i = 0; i < doc.images.size(); ++i) {
+        ImageRecord& img = doc.images[i];
+        offset = alignUp(offset, kPixelAlign);
+        img.pixelOffset = offset;
+        uint64_t fileSize = doc.imageFiles[i].size;
+        offset += fileSize ? fileSize : (uint64_t)img.width * img.height * sizeof(uint32_t);
+    }
+    header.fileSize = offset;
+
+    // Unique per save: engine instances may write the same path concurrently
+    static std::atomic<unsigned> saveCount{0};
+    std::string tmpPath = std::string(path) + "." + std::to_string(saveCount++) + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f) {
+        printf("Error: Could not write document: %s\n", path);
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    if (ok && !doc.layers.empty())
+        ok = fwrite(doc.layers.data(), sizeof(LayerRecord), doc.layers.size(), f) == doc.layers.size();
+    if (ok && !doc.objects.empty())
+        ok = fwrite(doc.objects.data(), sizeof(ObjectRecord), doc.objects.size(), f) == doc.objects.size();
+    if (ok && !doc.images.empty())
+        ok = fwrite(doc.images.data(), sizeof(ImageRecord), doc.images.size(), f) == doc.images.size();
+    if (ok && !doc.pageLayers.empty())
+        ok = fwrite(doc.pageLayers.data(), sizeof(PageLayerRecord), doc.pageLayers.size(), f) ==
+             doc.pageLayers.size();
+    if (ok && !doc.imageFiles.empty())
+        ok = fwrite(doc.imageFiles.data(), sizeof(ImageFileRecord), doc.imageFiles.size(), f) ==
+             doc.imageFiles.size();
+    if (ok && !doc.strings.empty())
+        ok = fwrite(doc.strings.data(), 1, doc.strings.size(), f) == doc.strings.size();
+
+    // Pixels go straight from the shared image buffers to the file;
+    // pictures not decoded yet are written as their file
+    uint64_t pos = header.stringsOffset + header.stringsSize;
+    for (size_t i = 0; ok && i < doc.images.size(); ++i) {
+        const ImageRecord& img = doc.images[i];
+        ok = writePadding(f, pos, img.pixelOffset);
+        if (uint64_t fileSize = doc.imageFiles[i].size) {
+            const std::vector<uint8_t>& encoded = doc.imagePixels[i]->source().encoded;
+            ok = ok && fwrite(encoded.data(), 1, encoded.size(), f) == encoded.size();
+            pos = img.pixelOffset + fileSize;
+            continue;
+        }
+        size_t count = (size_t)img.width * img.height;
+        std::shared_ptr<const ImageData> pixels = doc.imagePixels[i]->decoded();
+        if (pixels->width != img.width || pixels->height != img.height) {
+            // A picture that failed to decode is saved transparent
+            ok = ok && writePadding(f, img.pixelOffset, img.pixelOffset + count * sizeof(uint32_t));
+        } else if (pixels->format == PixelFormat::BGRA) {
+            ok = ok && fwrite(pixels->pixels, sizeof(uint32_t), count, f) == count;
+        } else {
+            // The file holds BGRA only
+            std::vector<uint32_t> row(img.width);
+            for (int y = 0; ok && y < img.height; ++y) {
+                pixels->readRow(y, row.data());
+                ok = fwrite(row.data(), sizeof(uint32_t), row.size(), f) == row.size();
+            }
+        }
+        pos = img.pixelOffset + count * sizeof(uint32_t);
+    }
+
+    ok = (fclose(f) == 0) && ok;
+
+    if (ok && kMappingBlocksReplace) releaseMapping(path);
+    std::error_code ec;
+    if (ok) std::filesystem::rename(tmpPath, path, ec);
+    if (!ok || ec) {
+        std::filesystem::remove(tmpPath, ec);
+        printf("Error: Could not write document: %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// Bounds check for a table of `count` records of `size` bytes
+static bool fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t fileSize) {
+    return offset <= fileSize && count <= (fileSize - offset) / size;
+}
+
+static bool readString(const char* strings, uint64_t stringsSize, uint32_t offset, uint32_t size,
+                       std::string& out) {
+    if ((uint64_t)offset + size > stringsSize) return false;
+    out.assign(strings + offset, size);
+    return true;
+}
+
+bool openDocument(Document& document, const char* path, uint32_t* checkpoint) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+        printf("Error: Could not open document: %s\n", path);
+        return false;
+    }
+
+    const uint8_t* base = file->data();
+    uint64_t size = file->size();
+
+    // Version 1 headers end before the page fields
+    DocHeader header = {};
+    if (size < kHeaderSizeV1) {
+        printf("Error: Not a document: %s\n", path);
+        return false;
+    }
+    memcpy(&header, base, kHeaderSizeV1);
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        printf("Error: Not a document: %s\n", path);
+        return false;
+    }
+    if (header.version < 1 || header.version > kVersion) {
+        printf("Error: Unsupported document version %u: %s\n", header.version, path);
+        return false;
+    }
+    uint32_t headerSize = header.version == 1 ? kHeaderSizeV1
+                        : header.version == 2 ? kHeaderSizeV2
+                                              : (uint32_t)sizeof(DocHeader);
+    if (header.headerSize < headerSize || size < headerSize) {
+        printf("Error: Not a document: %s\n", path);
+        return false;
+    }
+    memcpy(&header, base, headerSize);
+    if (header.version == 1) header.pageCount = 1;
+    if (header.pageCount == 0 || header.pageCount > kMaxPages) {
+        printf("Error: Corrupt page count in document: %s\n", path);
+        return false;
+    }
+    if (header.fileSize > size ||
+        !fits(header.pageLayersOffset, header.pageLayerCount, sizeof(PageLayerRecord), size) ||
+        !fits(header.layersOffset, header.layerCount, sizeof(LayerRecord), size) ||
+        !fits(header.objectsOffset, header.objectCount, sizeof(ObjectRecord), size) ||
+        !fits(header.imagesOffset, header.imageCount, sizeof(ImageRecord), size) ||
+        (header.version >= 3 && !fits(header.imageFilesOffset, header.imageCount, sizeof(ImageFileRecord), size)) ||
+        !fits(header.stringsOffset, header.stringsSize, 1, size)) {
+        printf("Error: Truncated document: %s\n", path);
+        return false;
+    }
+
+    // Pixels point into the mapping, which they keep alive; files are
+    // copied out and decoded when first drawn
+    std::vector<std::shared_ptr<const ImageData>> images(header.imageCount);
+    for (uint32_t i = 0; i < header.imageCount; ++i) {
+        ImageRecord rec;
+        memcpy(&rec, base + header.imagesOffset + i * sizeof(ImageRecord), sizeof(rec));
+        ImageFileRecord stored = {};
+        if (header.version >= 3) {
+            memcpy(&stored, base + header.imageFilesOffset + i * sizeof(ImageFileRecord), sizeof(stored));
+        }
+        if (stored.size) {
+            std::shared_ptr<ImageData> encoded;
+            if (rec.width > 0 && rec.height > 0 && fits(rec.pixelOffset, stored.size, 1, size)) {
+                const uint8_t* bytes = base + rec.pixelOffset;
+                encoded = makeEncodedImage(std::vector<uint8_t>(bytes, bytes + stored.size));
+            }
+            if (!encoded) {
+                printf("Error: Corrupt image in document: %s\n", path);
+                return false;
+            }
+            if (stored.flags & kImageReduced) {
+                images[i] = makeReducedImage(std::move(encoded), rec.width, rec.height);
+            } else {
+                encoded->width = rec.width;
+                encoded->height = rec.height;
+                images[i] = std::move(encoded);
+            }
+            continue;
+        }
+        if (rec.width <= 0 || rec.height <= 0 || rec.pixelOffset % kPixelAlign != 0 ||
+            !fits(rec.pixelOffset, (uint64_t)rec.width * rec.height, sizeof(uint32_t), size)) {
+            printf("Error: Corrupt image in document: %s\n", path);
+            return false;
+        }
+        images[i] = makeImageView((const uint32_t*)(base + rec.pixelOffset),
+                                  rec.width, rec.height, file);
+    }
+    if (!images.empty()) {
+        std::lock_guard<std::mutex> lock(openedMutex);
+        auto& opened = openedImages[documentKey(path)];
+        opened.erase(std::remove_if(opened.begin(), opened.end(),
+                                    [](const std::weak_ptr<const ImageData>& w) { return w.expired(); }),
+                     opened.end());
+        opened.insert(opened.end(), images.begin(), images.end());
+    }
+
+    std::vector<std::shared_ptr<MasterContent>> layers(header.layerCount);
+    std::vector<std::vector<std::shared_ptr<MasterContent>>> pageLayers(header.pageCount);
+    std::vector<std::vector<std::shared_ptr<Object>>> pageObjects(header.pageCount);
+    for (uint32_t i = 0; i < header.layerCount; ++i) {
+        LayerRecord rec;
+        memcpy(&rec, base + header.layersOffset + i * sizeof(LayerRecord), sizeof(rec));
+        if (rec.parent >= (int32_t)i) {
+            printf("Error: Corrupt layer in document: %s\n", path);
+            return false;
+        }
+        auto layer = std::make_shared<MasterContent>();
+        layer->parent = rec.parent >= 0 ? layers[rec.parent] : nullptr;
+        layer->showParentShapes = (rec.flags & kLayerShowParent) != 0;
+        layer->hasBackground = (rec.flags & kLayerHasBackground) != 0;
+        layer->background = rec.background;
+        layer->width = rec.width;
+        layer->height = rec.height;
+        layers[i] = layer;
+        if (header.version == 1 && (rec.flags & kLayerInScene)) pageLayers[0].push_back(layer);
+    }
+
+    for (uint32_t i = 0; i < header.pageLayerCount; ++i) {
+        PageLayerRecord rec;
+        memcpy(&rec, base + header.pageLayersOffset + i * sizeof(PageLayerRecord), sizeof(rec));
+        if (rec.page < 0 || rec.page >= (int32_t)header.pageCount ||
+            rec.layer < 0 || rec.layer >= (int32_t)header.layerCount) {
+            printf("Error: Corrupt page in document: %s\n", path);
+            return false;
+        }
+        pageLayers[rec.page].push_back(layers[rec.layer]);
+    }
+
+    const char* strings = (const char*)base + header.stringsOffset;
+    for (uint32_t i = 0; i < header.objectCount; ++i) {
+        ObjectRecord rec;
+        memcpy(&rec, base + header.objectsOffset + i * sizeof(ObjectRecord), sizeof(rec));
+
+        std::string name, text;
+        if (!readString(strings, header.stringsSize, rec.nameOffset, rec.nameSize, name) ||
+            !readString(strings, header.stringsSize, rec.textOffset, rec.textSize, text) ||
+            rec.layer < -(int64_t)header.pageCount || rec.layer >= (int32_t)header.layerCount ||
+            rec.image < -1 || rec.image >= (int32_t)header.imageCount) {
+            printf("Error: Corrupt object in document: %s\n", path);
+            return false;
+        }
+
+        std::shared_ptr<Object> obj = decodeObject(rec, name, text,
+                                                   rec.image >= 0 ? images[rec.image] : nullptr);
+
+        if (rec.layer >= 0) {
+            layers[rec.layer]->objects.push_back(std::move(obj));
+        } else {
+            pageObjects[-1 - rec.layer].push_back(std::move(obj));
+        }
+    }
+
+    // Only replace the pages once the whole document has been read
+    document.reset(header.pageCount);
+    for (uint32_t p = 0; p < header.pageCount; ++p) {
+        Scene& scene = document.page(p).scene;
+        for (auto& obj : pageObjects[p]) scene.restore(std::move(obj));
+        for (auto& layer : pageLayers[p]) scene.addMaster(std::move(layer));
+        // Loading is not an undoable edit
+        document.page(p).history.clear();
+    }
+    // The page size is not stored; slides carry theirs in their layers
+    for (const auto& layer : layers) {
+        if (layer->width > 0 && layer->height > 0) {
+            document.setPageSize(layer->width, layer->height);
+            break;
+        }
+    }
+    if (checkpoint) *checkpoint = header.checkpoint;
+    return true;
+}
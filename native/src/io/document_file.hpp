@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+
+class Document;
+
+// Native document format.
+//
+// A versioned header, fixed-size little-endian records for layers, objects,
+// images and the layers each page draws, a string table, then the decoded
+// BGRA pixels of every image, each block aligned to 64 bytes. Pictures not
+// decoded yet (imported, see ImageCache) are stored as their file instead
+// and open just as lazily. Pages share
+// layers and images; an object record names its page or its layer. Opening maps the file and points images
+// at their pixels in place, so nothing is inflated, parsed or decoded.
+//
+// Pixels opened in place keep the mapping alive for as long as an object
+// uses them. Saving writes a temporary file and renames it over `path`, so
+// a failed save leaves the previous document intact. Where a mapped file
+// cannot be replaced (Windows), pictures opened from `path` first copy
+// their pixels, so a document can always be saved where it was opened.
+//
+// `checkpoint` tags a document written as a journal checkpoint, so a
+// journal is only replayed over the checkpoint it was started from.
+//
+// Version 1 documents, from before pages, open as a single page; version 2
+// documents store every picture decoded.
+bool saveDocument(const Document& document, const char* path, uint32_t checkpoint = 0);
+bool openDocument(Document& document, const char* path, uint32_t* checkpoint = nullptr);
@@ -0,0 +1,162 @@
+#include "font_subset.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+
+static uint16_t readU16(const uint8_t* p) { return (uint16_t)(p[0] << 8 | p[1]); }
+static uint32_t readU32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static void putU16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+static void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    putU16(out, (uint16_t)(v >> 16));
+    putU16(out, (uint16_t)v);
+}
+static void setU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t tableChecksum(const uint8_t* data, size_t size) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < size; i += 4) {
+        uint8_t word[4] = {0, 0, 0, 0};
+        memcpy(word, data + i, std::min<size_t>(4, size - i));
+        sum += readU32(word);
+    }
+    return sum;
+}
+
+struct Table {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Composite glyphs: the glyph ids of their components
+static void addComponents(const uint8_t* glyph, size_t size, std::vector<int>& out) {
+    const uint16_t ARG_1_AND_2_ARE_WORDS = 0x0001, WE_HAVE_A_SCALE = 0x0008,
+                   MORE_COMPONENTS = 0x0020, WE_HAVE_AN_X_AND_Y_SCALE = 0x0040,
+                   WE_HAVE_A_TWO_BY_TWO = 0x0080;
+    if (size < 10 || (int16_t)readU16(glyph) >= 0) return;
+    size_t pos = 10;
+    for (;;) {
+        if (pos + 4 > size) return;
+        uint16_t flags = readU16(glyph + pos);
+        out.push_back(readU16(glyph + pos + 2));
+        pos += 4;
+        pos += (flags & ARG_1_AND_2_ARE_WORDS) ? 4 : 2;
+        if (flags & WE_HAVE_A_SCALE) pos += 2;
+        else if (flags & WE_HAVE_AN_X_AND_Y_SCALE) pos += 4;
+        else if (flags & WE_HAVE_A_TWO_BY_TWO) pos += 8;
+        if (!(flags & MORE_COMPONENTS)) return;
+    }
+}
+
+std::vector<uint8_t> subsetTrueType(const uint8_t* font, size_t size, const std::vector<bool>& used) {
+    if (size < 12) return {};
+    uint16_t numTables = readU16(font + 4);
+    if (12 + (size_t)numTables * 16 > size) return {};
+
+    std::map<std::string, Table> tables;
+    for (uint16_t i = 0; i < numTables; ++i) {
+        const uint8_t* entry = font + 12 + (size_t)i * 16;
+        uint32_t offset = readU32(entry + 8);
+        uint32_t length = readU32(entry + 12);
+        if ((size_t)offset + length > size) return {};
+        tables[std::string((const char*)entry, 4)] = Table{font + offset, length};
+    }
+    for (const char* required : {"head", "hhea", "maxp", "hmtx", "loca", "glyf"}) {
+        if (!tables.count(required)) return {};
+    }
+    const Table& head = tables["head"];
+    const Table& loca = tables["loca"];
+    const Table& glyf = tables["glyf"];
+    if (head.size < 54 || tables["maxp"].size < 6) return {};
+
+    int numGlyphs = readU16(tables["maxp"].data + 4);
+    bool longOffsets = readU16(head.data + 50) != 0;
+    if (loca.size < (size_t)(numGlyphs + 1) * (longOffsets ? 4 : 2)) return {};
+
+    std::vector<uint32_t> offsets(numGlyphs + 1);
+    for (int i = 0; i <= numGlyphs; ++i) {
+        offsets[i] = longOffsets ? readU32(loca.data + i * 4) : readU16(loca.data + i * 2) * 2u;
+        if (offsets[i] > glyf.size) return {};
+    }
+    auto glyphSize = [&](int g) { return offsets[g + 1] > offsets[g] ? offsets[g + 1] - offsets[g] : 0; };
+
+    // Used glyphs, .notdef and everything composites refer to
+    std::vector<bool> keep(numGlyphs, false);
+    std::vector<int> pending = {0};
+    for (int g = 0; g < numGlyphs && g < (int)used.size(); ++g) {
+        if (used[g]) pending.push_back(g);
+    }
+    while (!pending.empty()) {
+        int g = pending.back();
+        pending.pop_back();
+        if (g >= numGlyphs || keep[g]) continue;
+        keep[g] = true;
+        addComponents(glyf.data + offsets[g], glyphSize(g), pending);
+    }
+
+    // New glyf and long-format loca
+    std::vector<uint8_t> newGlyf, newLoca;
+    for (int g = 0; g < numGlyphs; ++g) {
+        putU32(newLoca, (uint32_t)newGlyf.size());
+        if (!keep[g]) continue;
+        newGlyf.insert(newGlyf.end(), glyf.data + offsets[g], glyf.data + offsets[g] + glyphSize(g));
+        while (newGlyf.size() % 4) newGlyf.push_back(0);
+    }
+    putU32(newLoca, (uint32_t)newGlyf.size());
+
+    std::vector<uint8_t> newHead(head.data, head.data + head.size);
+    setU32(&newHead[8], 0);     // checkSumAdjustment, set below
+    newHead[50] = 0;
+    newHead[51] = 1;            // indexToLocFormat: long
+
+    std::map<std::string, Table> out;
+    for (const char* tag : {"cvt ", "fpgm", "prep", "hhea", "maxp", "hmtx"}) {
+        auto it = tables.find(tag);
+        if (it != tables.end()) out[tag] = it->second;
+    }
+    out["head"] = Table{newHead.data(), newHead.size()};
+    out["loca"] = Table{newLoca.data(), newLoca.size()};
+    out["glyf"] = Table{newGlyf.data(), newGlyf.size()};
+
+    // Table directory, then the tables in tag order, each 4-byte aligned
+    uint16_t count = (uint16_t)out.size();
+    uint16_t entrySelector = 0;
+    while ((2u << entrySelector) <= count) ++entrySelector;
+    uint16_t searchRange = (uint16_t)(16u << entrySelector);
+
+    std::vector<uint8_t> result;
+    putU32(result, 0x00010000);
+    putU16(result, count);
+    putU16(result, searchRange);
+    putU16(result, entrySelector);
+    putU16(result, (uint16_t)(count * 16 - searchRange));
+
+    size_t offset = 12 + (size_t)count * 16;
+    size_t headOffset = 0;
+    for (const auto& t : out) {
+        result.insert(result.end(), t.first.begin(), t.first.end());
+        putU32(result, tableChecksum(t.second.data, t.second.size));
+        putU32(result, (uint32_t)offset);
+        putU32(result, (uint32_t)t.second.size);
+        if (t.first == "head") headOffset = offset;
+        offset += (t.second.size + 3) & ~(size_t)3;
+    }
+    for (const auto& t : out) {
+        result.insert(result.end(), t.second.data, t.second.data + t.second.size);
+        while (result.size() % 4) result.push_back(0);
+    }
+
+    setU32(&result[headOffset + 8], 0xB1B0AFBA - tableChecksum(result.data(), result.size()));
+    return result;
+}
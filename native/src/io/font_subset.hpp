@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Builds a TrueType font that keeps only the outlines of the glyphs marked
+// in `used` (indexed by glyph id), plus .notdef and the components of kept
+// composite glyphs. Every other glyph stays in the font with an empty
+// outline, so glyph ids need no remapping. The tables a PDF viewer needs
+// for a CID-keyed font are kept (head, hhea, maxp, hmtx, loca, glyf and the
+// hinting programs); cmap, names and the rest are dropped.
+//
+// Returns an empty vector if the font has no glyf outlines (CFF flavoured
+// OpenType) or is malformed.
+std::vector<uint8_t> subsetTrueType(const uint8_t* font, size_t size, const std::vector<bool>& used);
@@ -0,0 +1,47 @@
+#include "image_export.hpp"
+#include "png_writer.hpp"
+#include "../core/scene_snapshot.hpp"
+#include "../core/surface.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Pixels per strip (16 MB); big enough that every core gets encoder blocks
+static const size_t kStripPixels = 4u << 20;
+
+int exportStripRows(int width, int height) {
+    size_t rows = std::max<size_t>(1, kStripPixels / (size_t)std::max(1, width));
+    return (int)std::min<size_t>(rows, (size_t)std::max(1, height));
+}
+
+// Renders the strip as horizontal bands, one per thread
+static void renderStrip(const SceneSnapshot& snapshot, const Surface& strip, unsigned threads) {
+    unsigned bands = std::max(1u, std::min<unsigned>(threads, (unsigned)strip.rows));
+    int bandRows = (strip.rows + (int)bands - 1) / (int)bands;
+    std::vector<std::thread> pool;
+    for (unsigned b = 1; b < bands; ++b) {
+        int top = (int)b * bandRows;
+        if (top >= strip.rows) break;
+        Surface band(strip.row(strip.top + top), strip.width, strip.height,
+                     strip.top + top, std::min(bandRows, strip.rows - top));
+        pool.emplace_back([&snapshot, band] { snapshot.render(band); });
+    }
+    snapshot.render(Surface(strip.pixels, strip.width, strip.height, strip.top,
+                            std::min(bandRows, strip.rows)));
+    for (auto& t : pool) t.join();
+}
+
+bool exportPng(const SceneSnapshot& snapshot, const char* path, int width, int height, int level) {
+    PngWriter writer;
+    if (!writer.open(path, width, height, level)) return false;
+
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int stripRows = exportStripRows(width, height);
+    std::vector<uint32_t> pixels((size_t)width * stripRows);
+    for (int top = 0; top < height; top += stripRows) {
+        int rows = std::min(stripRows, height - top);
+        renderStrip(snapshot, Surface(pixels.data(), width, height, top, rows), threads);
+        if (!writer.writeRows(pixels.data(), rows, (size_t)width)) break;
+    }
+    return writer.close();
+}
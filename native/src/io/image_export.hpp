@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+struct SceneSnapshot;
+
+// Writes `snapshot` rendered at width x height as a PNG. The canvas is
+// rendered a strip of rows at a time (each strip split across threads) and
+// every strip is encoded before the next one is drawn, so peak memory is
+// one strip plus the encoder's blocks, whatever the size of the canvas.
+bool exportPng(const SceneSnapshot& snapshot, const char* path, int width, int height, int level);
+
+// Rows of the canvas in one strip of an export
+int exportStripRows(int width, int height);
@@ -0,0 +1,363 @@
+#include "journal.hpp"
+#include "document_file.hpp"
+#include "object_record.hpp"
+#include "byte_reader.hpp"
+#include "../core/document.hpp"
+#include "../core/mapped_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+#define MINIZ_HEADER_FILE_ONLY
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "miniz.h"
+
+static const char kMagic[8] = {'K', 'R', 'L', 'J', 'R', 'N', 'L', '\n'};
+static const uint32_t kVersion = 2;
+static const uint64_t kMinCompactBytes = 4u << 20;
+
+enum RecordType : uint8_t {
+    RecordAdd = 1,     // int32 index, ObjectRecord, name, text, [int32 w, int32 h, pixels]
+    RecordRemove = 2,  // int32 uid
+    RecordChange = 3,  // int32 uid, uint32 mask, then the fields in `mask`
+    RecordReorder = 4, // int32 uid, int32 new index
+    RecordPage = 5,    // int32 page: the records that follow apply to it
+};
+
+struct RecordHeader {
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t size;     // payload bytes
+    uint32_t crc;      // of the payload; a torn final write fails it
+};
+
+static_assert(sizeof(RecordHeader) == 12, "journal record layout");
+
+static void putBytes(std::vector<uint8_t>& out, const void* data, size_t size) {
+    size_t at = out.size();
+    out.resize(at + size);
+    if (size) memcpy(out.data() + at, data, size);
+}
+
+template <typename T>
+static void put(std::vector<uint8_t>& out, const T& v) {
+    putBytes(out, &v, sizeof(T));
+}
+
+Journal::~Journal() {
+    close();
+}
+
+Journal::PageLog::PageLog(Journal& journal, Scene& scene) : scene(scene), journal(journal) {
+    scene.addObserver(this);
+}
+
+Journal::PageLog::~PageLog() {
+    scene.removeObserver(this);
+}
+
+bool Journal::open(Document& target, const char* filepath) {
+    close();
+    document = &target;
+    path = filepath;
+    logPath = path + ".journal";
+    document->addObserver(this);
+    for (size_t i = 0; i < document->pageCount(); ++i) {
+        pageLogs.push_back(std::make_unique<PageLog>(*this, document->page(i).scene));
+    }
+    if (!checkpoint()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void Journal::close() {
+    if (!document) return;
+    flush();
+    pageLogs.clear();
+    document->removeObserver(this);
+    if (log) fclose(log);
+    log = nullptr;
+    document = nullptr;
+    pending.clear();
+}
+
+void Journal::pageAdded(Page& page) {
+    pageLogs.push_back(std::make_unique<PageLog>(*this, page.scene));
+    rewriteAll();
+}
+
+void Journal::pageRemoved(Page& page) {
+    pageLogs.erase(std::remove_if(pageLogs.begin(), pageLogs.end(),
+                                  [&](const std::unique_ptr<PageLog>& p) { return &p->scene == &page.scene; }),
+                   pageLogs.end());
+    rewriteAll();
+}
+
+void Journal::pagesReordered() {
+    rewriteAll();
+}
+
+// Page structure or a whole page changed; the next flush writes a checkpoint
+void Journal::rewriteAll() {
+    needCheckpoint = true;
+    pending.clear();
+}
+
+bool Journal::checkpoint() {
+    if (!document) return false;
+
+    // A fresh id, so the previous journal cannot be replayed over the new
+    // checkpoint if the journal is not replaced below
+    uint32_t id;
+    do {
+        id = std::random_device{}();
+    } while (id == 0 || id == checkpointId);
+
+    // The current journal stays open until the new checkpoint is written,
+    // so edits keep being recorded if the save fails. Pictures recovered
+    // from `path` stop mapping it first where that blocks the rename.
+    if (!saveDocument(*document, path.c_str(), id)) return false;
+    checkpointId = id;
+    std::error_code ec;
+    checkpointBytes = std::filesystem::file_size(path, ec);
+
+    if (log) fclose(log);
+    log = nullptr;
+    pending.clear();
+    logBytes = 0;
+    needCheckpoint = false;
+    // Replay starts on the first page
+    lastScene = &document->page(0).scene;
+
+    // The new checkpoint already holds every edit; start an empty journal
+    log = fopen(logPath.c_str(), "wb");
+    if (!log) {
+        printf("Error: Could not write journal: %s\n", logPath.c_str());
+        return false;
+    }
+    uint32_t header[2] = {kVersion, checkpointId};
+    return fwrite(kMagic, sizeof(kMagic), 1, log) == 1 &&
+           fwrite(header, sizeof(header), 1, log) == 1 &&
+           fflush(log) == 0;
+}
+
+bool Journal::flush() {
+    if (!document) return false;
+    if (needCheckpoint) return checkpoint();
+    if (pending.empty()) return true;
+    if (!log) return false;
+
+    bool ok = fwrite(pending.data(), 1, pending.size(), log) == pending.size() &&
+              fflush(log) == 0;
+    logBytes += pending.size();
+    pending.clear();
+    if (!ok) {
+        printf("Error: Could not write journal: %s\n", logPath.c_str());
+        return false;
+    }
+
+    // Compaction is proportional to the deck, so it only runs once the
+    // journal has grown past the checkpoint it would replace
+    if (logBytes > std::max(kMinCompactBytes, checkpointBytes)) return checkpoint();
+    return true;
+}
+
+void Journal::append(const Scene& scene, uint8_t type, const std::vector<uint8_t>& payload) {
+    if (&scene != lastScene) {
+        lastScene = &scene;
+        std::vector<uint8_t> page;
+        put(page, (int32_t)document->indexOf(scene));
+        append(scene, RecordPage, page);
+    }
+
+    RecordHeader h = {};
+    h.type = type;
+    h.size = (uint32_t)payload.size();
+    h.crc = (uint32_t)mz_crc32(MZ_CRC32_INIT, payload.data(), payload.size());
+    put(pending, h);
+    pending.insert(pending.end(), payload.begin(), payload.end());
+}
+
+void Journal::PageLog::objectAdded(const std::shared_ptr<Object>& obj, int index) {
+    if (journal.needCheckpoint) return;
+
+    ObjectRecord rec;
+    std::string strings;
+    const ImageData* image = encodeObject(*obj, rec, strings);
+    rec.image = image ? 0 : -1;
+
+    std::vector<uint8_t> payload;
+    put(payload, (int32_t)index);
+    put(payload, rec);
+    putBytes(payload, strings.data(), strings.size());
+    if (image) {
+        std::shared_ptr<const ImageData> pixels = image->decoded();
+        put(payload, (int32_t)pixels->width);
+        put(payload, (int32_t)pixels->height);
+        std::vector<uint32_t> row(pixels->width);
+        for (int y = 0; y < pixels->height; ++y) {
+            pixels->readRow(y, row.data());
+            putBytes(payload, row.data(), row.size() * sizeof(uint32_t));
+        }
+    }
+    journal.append(scene, RecordAdd, payload);
+}
+
+void Journal::PageLog::objectRemoved(const std::shared_ptr<Object>& obj, int) {
+    if (journal.needCheckpoint) return;
+    std::vector<uint8_t> payload;
+    put(payload, (int32_t)obj->id);
+    journal.append(scene, RecordRemove, payload);
+}
+
+void Journal::PageLog::objectChanged(Object& obj, uint32_t mask) {
+    if (journal.needCheckpoint) return;
+    ObjectState s = captureState(obj, mask);
+
+    std::vector<uint8_t> payload;
+    put(payload, (int32_t)obj.id);
+    put(payload, mask);
+    if (mask & FieldGeometry) {
+        float g[8] = {s.x, s.y, s.w, s.h, s.x1, s.y1, s.x2, s.y2};
+        put(payload, g);
+    }
+    if (mask & FieldColor) put(payload, s.color);
+    if (mask & FieldText) {
+        put(payload, (uint32_t)s.text.size());
+        putBytes(payload, s.text.data(), s.text.size());
+    }
+    if (mask & FieldFontSize) put(payload, s.fontSize);
+    journal.append(scene, RecordChange, payload);
+}
+
+void Journal::PageLog::objectReordered(const std::shared_ptr<Object>& obj, int, int to) {
+    if (journal.needCheckpoint) return;
+    std::vector<uint8_t> payload;
+    put(payload, (int32_t)obj->id);
+    put(payload, (int32_t)to);
+    journal.append(scene, RecordReorder, payload);
+}
+
+void Journal::PageLog::sceneCleared() {
+    journal.rewriteAll();
+}
+
+static bool replayRecord(Document& document, Scene*& target, uint8_t type, ByteReader in) {
+    Scene& scene = *target;
+    switch (type) {
+    case RecordAdd: {
+        int32_t index;
+        ObjectRecord rec;
+        std::string name, text;
+        if (!in.get(index) || !in.get(rec) ||
+            !in.getBytes(name, rec.nameSize) || !in.getBytes(text, rec.textSize)) {
+            return false;
+        }
+        std::shared_ptr<const ImageData> image;
+        if (rec.image >= 0) {
+            int32_t w, h;
+            if (!in.get(w) || !in.get(h) || w <= 0 || h <= 0 ||
+                (uint64_t)(in.end - in.p) < (uint64_t)w * h * sizeof(uint32_t)) {
+                return false;
+            }
+            // Payload offsets are not pixel aligned
+            std::vector<uint32_t> pixels((size_t)w * h);
+            memcpy(pixels.data(), in.p, pixels.size() * sizeof(uint32_t));
+            image = makeImageData(std::move(pixels), w, h);
+        }
+        if (scene.getObject(rec.uid)) return true;
+        scene.restore(decodeObject(rec, name, text, image), index);
+        return true;
+    }
+    case RecordRemove: {
+        int32_t uid;
+        if (!in.get(uid)) return false;
+        scene.removeObject(uid);
+        return true;
+    }
+    case RecordChange: {
+        int32_t uid;
+        ObjectState s;
+        if (!in.get(uid) || !in.get(s.mask)) return false;
+        if (s.mask & FieldGeometry) {
+            float g[8];
+            if (!in.get(g)) return false;
+            s.x = g[0]; s.y = g[1]; s.w = g[2]; s.h = g[3];
+            s.x1 = g[4]; s.y1 = g[5]; s.x2 = g[6]; s.y2 = g[7];
+        }
+        if ((s.mask & FieldColor) && !in.get(s.color)) return false;
+        if (s.mask & FieldText) {
+            uint32_t len;
+            if (!in.get(len) || !in.getBytes(s.text, len)) return false;
+        }
+        if ((s.mask & FieldFontSize) && !in.get(s.fontSize)) return false;
+        scene.applyObjectState(uid, s);
+        return true;
+    }
+    case RecordReorder: {
+        int32_t uid, index;
+        if (!in.get(uid) || !in.get(index)) return false;
+        scene.reorderObject(uid, index);
+        return true;
+    }
+    case RecordPage: {
+        int32_t page;
+        if (!in.get(page) || page < 0 || page >= (int32_t)document.pageCount()) return false;
+        target = &document.page(page).scene;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool Journal::recover(Document& document, const char* filepath) {
+    uint32_t checkpoint = 0;
+    if (!openDocument(document, filepath, &checkpoint)) return false;
+
+    std::string logPath = std::string(filepath) + ".journal";
+    MappedFile log;
+    if (!log.open(logPath.c_str())) return true; // Nothing edited since the checkpoint
+
+    const uint8_t* p = log.data();
+    const uint8_t* end = p + log.size();
+    if (log.size() < 16 || memcmp(p, kMagic, sizeof(kMagic)) != 0) {
+        printf("Error: Not a journal: %s\n", logPath.c_str());
+        return true;
+    }
+    uint32_t header[2];
+    memcpy(header, p + sizeof(kMagic), sizeof(header));
+    if (header[0] != kVersion) {
+        printf("Error: Unsupported journal version %u: %s\n", header[0], logPath.c_str());
+        return true;
+    }
+    if (header[1] != checkpoint) {
+        // Left over from the previous checkpoint, which the document
+        // already includes
+        printf("Warning: Journal does not match its checkpoint: %s\n", logPath.c_str());
+        return true;
+    }
+    p += 16;
+
+    size_t replayed = 0;
+    Scene* target = &document.page(0).scene;
+    while ((size_t)(end - p) >= sizeof(RecordHeader)) {
+        RecordHeader h;
+        memcpy(&h, p, sizeof(h));
+        p += sizeof(h);
+        if ((size_t)(end - p) < h.size ||
+            (uint32_t)mz_crc32(MZ_CRC32_INIT, p, h.size) != h.crc ||
+            !replayRecord(document, target, h.type, ByteReader{p, p + h.size})) {
+            printf("Warning: Journal truncated after %zu records: %s\n", replayed, logPath.c_str());
+            break;
+        }
+        p += h.size;
+        ++replayed;
+    }
+    // Edits of the previous session are not undoable in this one
+    for (size_t i = 0; i < document.pageCount(); ++i) document.page(i).history.clear();
+    return true;
+}
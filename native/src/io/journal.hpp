@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../core/document.hpp"
+
+// Append-only edit journal with checkpoints.
+//
+// The checkpoint is a native document at `path`; every mutation made
+// through the Scene of any page afterwards is appended to `path`.journal as
+// a small record (add, remove, or the new values of the changed fields),
+// preceded by a page record whenever the page differs from the previous
+// record's. Adding, removing or reordering pages writes a new checkpoint
+// at the next flush instead. Records
+// are buffered in memory and written by flush(), so an autosave costs what
+// was edited, not the size of the deck. Once the journal outgrows the
+// checkpoint it is compacted into a new one.
+//
+// Each checkpoint gets a new id, written in its header and in the header
+// of the journal started from it. A journal left over from an older
+// checkpoint (a crash between the two writes of a compaction) is not
+// replayed: its page indices and uids may no longer match.
+class Journal : public DocumentObserver {
+public:
+    ~Journal() override;
+
+    bool open(Document& document, const char* path);
+    void close();
+    bool isOpen() const { return document != nullptr; }
+
+    bool flush();
+    bool checkpoint();
+
+    // Loads the checkpoint at `path` and replays its journal
+    static bool recover(Document& document, const char* path);
+
+    void pageAdded(Page& page) override;
+    void pageRemoved(Page& page) override;
+    void pagesReordered() override;
+
+private:
+    // Records the mutations of one page's scene
+    class PageLog : public SceneObserver {
+    public:
+        PageLog(Journal& journal, Scene& scene);
+        ~PageLog() override;
+
+        Scene& scene;
+
+        void objectAdded(const std::shared_ptr<Object>& obj, int index) override;
+        void objectRemoved(const std::shared_ptr<Object>& obj, int index) override;
+        void objectChanged(Object& obj, uint32_t mask) override;
+        void objectReordered(const std::shared_ptr<Object>& obj, int from, int to) override;
+        void sceneCleared() override;
+
+    private:
+        Journal& journal;
+    };
+
+    Document* document = nullptr;
+    std::vector<std::unique_ptr<PageLog>> pageLogs;
+    const Scene* lastScene = nullptr;   // page the records now apply to
+    std::string path;
+    std::string logPath;
+    FILE* log = nullptr;
+
+    std::vector<uint8_t> pending;
+    uint64_t logBytes = 0;
+    uint64_t checkpointBytes = 0;
+    uint32_t checkpointId = 0;
+    bool needCheckpoint = false;   // a page was replaced, added, removed or moved
+
+    void append(const Scene& scene, uint8_t type, const std::vector<uint8_t>& payload);
+    void rewriteAll();
+};
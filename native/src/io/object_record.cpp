@@ -0,0 +1,67 @@
+#include "object_record.hpp"
+#include "../objects/rect_object.hpp"
+#include "../objects/text_object.hpp"
+#include "../objects/image_object.hpp"
+#include "../objects/ellipse_object.hpp"
+#include "../objects/line_object.hpp"
+
+static uint32_t appendString(std::string& strings, const std::string& s, uint32_t& size) {
+    uint32_t offset = (uint32_t)strings.size();
+    strings += s;
+    size = (uint32_t)s.size();
+    return offset;
+}
+
+const ImageData* encodeObject(Object& obj, ObjectRecord& rec, std::string& strings) {
+    rec = ObjectRecord{};
+    rec.type = (uint32_t)obj.getType();
+    rec.uid = obj.id;
+    rec.layer = -1;
+    rec.color = obj.getColor();
+    rec.x = obj.x;
+    rec.y = obj.y;
+    rec.w = obj.w;
+    rec.h = obj.h;
+    rec.fontSize = obj.getFontSize();
+    rec.image = -1;
+    rec.nameOffset = appendString(strings, obj.name, rec.nameSize);
+    rec.textOffset = appendString(strings, obj.getText(), rec.textSize);
+
+    if (auto* line = dynamic_cast<LineObject*>(&obj)) {
+        line->getEndpoints(rec.x1, rec.y1, rec.x2, rec.y2);
+        rec.thickness = line->thickness;
+    } else if (auto* img = dynamic_cast<ImageObject*>(&obj)) {
+        if (img->image && (img->image->hasPixels() || img->image->isLazy() || img->image->isView())) return img->image.get();
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Object> decodeObject(const ObjectRecord& rec, const std::string& name,
+                                     const std::string& text, std::shared_ptr<const ImageData> image) {
+    std::shared_ptr<Object> obj;
+    switch (rec.type) {
+    case 1:
+        obj = std::make_shared<TextObject>(rec.uid, rec.x, rec.y, text, rec.color, rec.fontSize);
+        break;
+    case 2:
+        obj = std::make_shared<ImageObject>(rec.uid, rec.x, rec.y, rec.w, rec.h, std::move(image));
+        break;
+    case 3:
+        obj = std::make_shared<EllipseObject>(rec.uid, rec.x, rec.y, rec.w, rec.h, rec.color);
+        break;
+    case 4:
+        obj = std::make_shared<LineObject>(rec.uid, rec.x1, rec.y1, rec.x2, rec.y2, rec.color, rec.thickness);
+        break;
+    default:
+        obj = std::make_shared<RectangleObject>(rec.uid, rec.x, rec.y, rec.w, rec.h, rec.color);
+        break;
+    }
+
+    // Restore the stored bounds exactly (text measures itself on construction)
+    obj->name = name;
+    obj->x = rec.x;
+    obj->y = rec.y;
+    obj->w = rec.w;
+    obj->h = rec.h;
+    return obj;
+}
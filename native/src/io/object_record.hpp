@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../core/object.hpp"
+#include "../core/image_data.hpp"
+
+// Fixed-size description of one object, shared by the native document and
+// the edit journal. Stored in native (little-endian) byte order.
+struct ObjectRecord {
+    uint32_t type;        // 0=rect, 1=text, 2=image, 3=ellipse, 4=line
+    int32_t uid;
+    int32_t layer;        // document: -1 - page for page objects, else a layer record
+    uint32_t color;
+    float x, y, w, h;
+    float x1, y1, x2, y2; // line endpoints
+    float fontSize;
+    int32_t thickness;
+    int32_t image;        // -1 for none; otherwise set by the container
+    uint32_t nameOffset;
+    uint32_t nameSize;
+    uint32_t textOffset;
+    uint32_t textSize;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ObjectRecord) == 80, "object record layout");
+
+// Fills `rec` from `obj`, appending its name and text to `strings`.
+// Returns the pixels of image objects (the caller stores them), else null.
+const ImageData* encodeObject(Object& obj, ObjectRecord& rec, std::string& strings);
+
+// Rebuilds the object described by `rec`, keeping its uid
+std::shared_ptr<Object> decodeObject(const ObjectRecord& rec, const std::string& name,
+                                     const std::string& text, std::shared_ptr<const ImageData> image);
@@ -0,0 +1,526 @@
+#include "pdf_writer.hpp"
+#include "font_subset.hpp"
+#include "../core/scene_snapshot.hpp"
+#include "../core/font.hpp"
+#include "../objects/rect_object.hpp"
+#include "../objects/ellipse_object.hpp"
+#include "../objects/line_object.hpp"
+#include "../objects/text_object.hpp"
+#include "../objects/image_object.hpp"
+#include "stb_image.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#define MINIZ_HEADER_FILE_ONLY
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "miniz.h"
+
+// Canvas pixels are 96 per inch, PDF units 72
+static const double POINTS_PER_PIXEL = 0.75;
+
+// Same as the raster editor background
+static const uint32_t CANVAS_BACKGROUND = 0xFF252526;
+
+// Shortest decimal form, e.g. "12" or "0.502", followed by a space
+static void put(std::string& out, double v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", v);
+    char* end = buf + strlen(buf);
+    while (end[-1] == '0') --end;
+    if (end[-1] == '.') --end;
+    *end = 0;
+    out += strcmp(buf, "-0") == 0 ? "0" : buf;
+    out += ' ';
+}
+
+static void putColor(std::string& out, uint32_t color) {
+    put(out, ((color >> 16) & 0xFF) / 255.0);
+    put(out, ((color >> 8) & 0xFF) / 255.0);
+    put(out, (color & 0xFF) / 255.0);
+}
+
+PdfWriter::~PdfWriter() {
+    if (file) {
+        failed = true;
+        close();
+    }
+}
+
+bool PdfWriter::open(const char* filePath) {
+    file = fopen(filePath, "wb");
+    if (!file) {
+        printf("Error: Could not open %s for writing\n", filePath);
+        return false;
+    }
+    path = filePath;
+    offsets.assign(3, 0);   // 0 is the free list head, 1 the catalog, 2 the page tree
+    pages.clear();
+    images.clear();
+    fonts.clear();
+    failed = false;
+    written = 0;
+    write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+    return true;
+}
+
+void PdfWriter::write(const void* data, size_t size) {
+    if (size && fwrite(data, 1, size, file) != size) failed = true;
+    written += size;
+}
+
+void PdfWriter::write(const std::string& text) {
+    write(text.data(), text.size());
+}
+
+int PdfWriter::reserveObject() {
+    offsets.push_back(0);
+    return (int)offsets.size() - 1;
+}
+
+void PdfWriter::beginObject(int id) {
+    offsets[id] = written;
+    write(std::to_string(id) + " 0 obj\n");
+}
+
+void PdfWriter::writeStream(int id, const std::string& dict, const uint8_t* data, size_t size) {
+    beginObject(id);
+    write("<< " + dict + " /Length " + std::to_string(size) + " >>\nstream\n");
+    write(data, size);
+    write("\nendstream\nendobj\n");
+}
+
+void PdfWriter::writeDeflated(int id, const std::string& dict, const uint8_t* data, size_t size) {
+    int flags = (int)tdefl_create_comp_flags_from_zip_params(6, MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    size_t deflatedSize = 0;
+    void* deflated = tdefl_compress_mem_to_heap(data, size, &deflatedSize, flags);
+    if (!deflated) {
+        failed = true;
+        return;
+    }
+    writeStream(id, dict + " /Filter /FlateDecode", static_cast<const uint8_t*>(deflated), deflatedSize);
+    free(deflated);
+}
+
+void PdfWriter::setFill(PageState& page, uint32_t color) {
+    setAlpha(page, color >> 24);
+    putColor(page.content, color);
+    page.content += "rg\n";
+}
+
+void PdfWriter::setStroke(PageState& page, uint32_t color) {
+    setAlpha(page, color >> 24);
+    putColor(page.content, color);
+    page.content += "RG\n";
+}
+
+// Fill and stroke opacity share one graphics state per alpha
+void PdfWriter::setAlpha(PageState& page, int alpha) {
+    if (alpha == 255) return;
+    std::string& name = page.alphas[alpha];
+    if (name.empty()) name = "A" + std::to_string(alpha);
+    page.content += "/" + name + " gs\n";
+}
+
+bool PdfWriter::writePage(const SceneSnapshot& snapshot, int width, int height) {
+    if (!file || width <= 0 || height <= 0) return false;
+
+    PageState page;
+    std::string& c = page.content;
+
+    // Canvas coordinates from here on: y down, one unit per pixel
+    put(c, POINTS_PER_PIXEL);
+    c += "0 0 ";
+    put(c, -POINTS_PER_PIXEL);
+    c += "0 ";
+    put(c, height * POINTS_PER_PIXEL);
+    c += "cm\n0 0 ";
+    put(c, width);
+    put(c, height);
+    c += "re W n\n";
+
+    setFill(page, CANVAS_BACKGROUND);
+    c += "0 0 ";
+    put(c, width);
+    put(c, height);
+    c += "re f\n";
+
+    for (const auto& master : snapshot.masters) {
+        writeMaster(page, *master, true, width, height);
+    }
+    for (const auto& obj : snapshot.objects) {
+        writeObject(page, *obj);
+    }
+
+    int contentId = reserveObject();
+    writeDeflated(contentId, "", reinterpret_cast<const uint8_t*>(c.data()), c.size());
+
+    std::string dict = "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 ";
+    put(dict, width * POINTS_PER_PIXEL);
+    put(dict, height * POINTS_PER_PIXEL);
+    dict += "] /Resources <<";
+    if (!page.images.empty()) {
+        dict += " /XObject <<";
+        for (const auto& image : page.images) {
+            dict += " /" + image.first + " " + std::to_string(image.second) + " 0 R";
+        }
+        dict += " >>";
+    }
+    if (!page.fonts.empty()) {
+        dict += " /Font <<";
+        for (const auto& font : page.fonts) {
+            dict += " /F" + std::to_string(font.second) + " " + std::to_string(font.second) + " 0 R";
+        }
+        dict += " >>";
+    }
+    if (!page.alphas.empty()) {
+        dict += " /ExtGState <<";
+        for (const auto& alpha : page.alphas) {
+            dict += " /" + alpha.second + " << /ca ";
+            put(dict, alpha.first / 255.0);
+            dict += "/CA ";
+            put(dict, alpha.first / 255.0);
+            dict += ">>";
+        }
+        dict += " >>";
+    }
+    dict += " >> /Contents " + std::to_string(contentId) + " 0 R >>\nendobj\n";
+
+    int pageId = reserveObject();
+    beginObject(pageId);
+    write(dict);
+    pages.push_back(pageId);
+    return !failed;
+}
+
+void PdfWriter::writeMaster(PageState& page, const MasterContent& master, bool background,
+                            int width, int height) {
+    if (background) {
+        const MasterContent* bg = &master;
+        while (bg && !bg->hasBackground) bg = bg->parent.get();
+        if (bg) {
+            page.content += "q\n";
+            setFill(page, bg->background);
+            page.content += "0 0 ";
+            put(page.content, std::min(width, master.width));
+            put(page.content, std::min(height, master.height));
+            page.content += "re f\nQ\n";
+        }
+    }
+    if (master.parent && master.showParentShapes) {
+        writeMaster(page, *master.parent, false, width, height);
+    }
+    for (const auto& obj : master.objects) {
+        writeObject(page, *obj);
+    }
+}
+
+void PdfWriter::writeObject(PageState& page, const SceneObject& obj) {
+    std::string& c = page.content;
+
+    if (auto* rect = dynamic_cast<const RectangleObject*>(&obj)) {
+        if (rect->w <= 0 || rect->h <= 0 || !(rect->color >> 24)) return;
+        c += "q\n";
+        setFill(page, rect->color);
+        put(c, rect->x);
+        put(c, rect->y);
+        put(c, rect->w);
+        put(c, rect->h);
+        c += "re f\nQ\n";
+    } else if (auto* ellipse = dynamic_cast<const EllipseObject*>(&obj)) {
+        if (ellipse->w <= 0 || ellipse->h <= 0 || !(ellipse->color >> 24)) return;
+        // Four cubic arcs
+        const double k = 0.5522847498;
+        double rx = ellipse->w / 2, ry = ellipse->h / 2;
+        double cx = ellipse->x + rx, cy = ellipse->y + ry;
+        double kx = k * rx, ky = k * ry;
+        c += "q\n";
+        setFill(page, ellipse->color);
+        put(c, cx + rx); put(c, cy); c += "m\n";
+        put(c, cx + rx); put(c, cy + ky); put(c, cx + kx); put(c, cy + ry); put(c, cx); put(c, cy + ry); c += "c\n";
+        put(c, cx - kx); put(c, cy + ry); put(c, cx - rx); put(c, cy + ky); put(c, cx - rx); put(c, cy); c += "c\n";
+        put(c, cx - rx); put(c, cy - ky); put(c, cx - kx); put(c, cy - ry); put(c, cx); put(c, cy - ry); c += "c\n";
+        put(c, cx + kx); put(c, cy - ry); put(c, cx + rx); put(c, cy - ky); put(c, cx + rx); put(c, cy); c += "c\n";
+        c += "f\nQ\n";
+    } else if (auto* line = dynamic_cast<const LineObject*>(&obj)) {
+        if (!(line->color >> 24)) return;
+        float x1, y1, x2, y2;
+        line->getEndpoints(x1, y1, x2, y2);
+        // The raster stamps a square of this side at every step
+        c += "q\n";
+        setStroke(page, line->color);
+        put(c, line->thickness / 2 * 2 + 1);
+        c += "w 2 J\n";
+        put(c, x1); put(c, y1); c += "m\n";
+        put(c, x2); put(c, y2); c += "l S\nQ\n";
+    } else if (auto* text = dynamic_cast<const TextObject*>(&obj)) {
+        writeText(page, *text);
+    } else if (auto* image = dynamic_cast<const ImageObject*>(&obj)) {
+        const ImageData* data = image->image.get();
+        if (!data || data->width <= 0 || data->height <= 0) return;
+        if (image->w <= 0 || image->h <= 0) return;
+        int id = imageObject(image->image);
+        std::string name = "Im" + std::to_string(id);
+        page.images[name] = id;
+        // Row 0 of the picture is at the top of the unit square
+        c += "q ";
+        put(c, image->w);
+        c += "0 0 ";
+        put(c, -image->h);
+        put(c, image->x);
+        put(c, image->y + image->h);
+        c += "cm /" + name + " Do Q\n";
+    }
+}
+
+// Glyph runs placed exactly where the raster puts each glyph: the widths
+// in the font are the true advances, and the raster's whole-pixel advances
+// are restored with TJ adjustments
+void PdfWriter::writeText(PageState& page, const TextObject& text) {
+    if (!text.font || text.text.empty() || !(text.color >> 24)) return;
+    const Font* font = text.font.get();
+    const stbtt_fontinfo& info = font->info;
+
+    FontEntry& entry = fonts[font];
+    if (!entry.id) {
+        entry.id = reserveObject();
+        entry.font = text.font;
+        entry.glyphs.assign(info.numGlyphs, false);
+        entry.codepoints.assign(info.numGlyphs, 0);
+    }
+    page.fonts[font] = entry.id;
+
+    float sc = stbtt_ScaleForPixelHeight(&info, text.fontSize);
+    double unitScale = 1000.0 * stbtt_ScaleForMappingEmToPixels(&info, 1.0f); // as in writeFont
+    double size = sc * 1000.0 / unitScale;
+    if (size <= 0) return;
+    int asc, desc, lg;
+    stbtt_GetFontVMetrics(&info, &asc, &desc, &lg);
+    int baseline = (int)text.y + (int)(asc * sc);
+
+    std::string& c = page.content;
+    c += "q\n";
+    setFill(page, text.color);
+    c += "BT /F" + std::to_string(entry.id) + " ";
+    put(c, size);
+    c += "Tf 1 0 0 -1 ";
+    put(c, (int)text.x);
+    put(c, baseline);
+    c += "Tm [<";
+
+    char hex[16];
+    for (char ch : text.text) {
+        int glyph = stbtt_FindGlyphIndex(&info, ch);
+        if (glyph < 0 || glyph >= info.numGlyphs) glyph = 0;
+        entry.glyphs[glyph] = true;
+        if (ch > 0) entry.codepoints[glyph] = ch;
+        snprintf(hex, sizeof(hex), "%04X", glyph);
+        c += hex;
+
+        int adv, lsb;
+        stbtt_GetGlyphHMetrics(&info, glyph, &adv, &lsb);
+        double adjust = std::lround(adv * unitScale) - (int)(adv * sc) * 1000.0 / size;
+        if (std::fabs(adjust) >= 0.05) {
+            c += "> ";
+            put(c, adjust);
+            c += "<";
+        }
+    }
+    c += ">] TJ ET\nQ\n";
+}
+
+int PdfWriter::imageObject(const std::shared_ptr<const ImageData>& data) {
+    const ImageData& image = *data;
+    auto cached = images.find(&image);
+    if (cached != images.end() && !cached->second.image.expired()) return cached->second.id;
+
+    int id = reserveObject();
+    images[&image] = ImageEntry{data, id};
+    std::string size;
+
+    // The JPEG the pixels came from, unless its layout is one PDF can't take
+    // as is. It may be larger than the pixels when the import reduced them.
+    const ImageData& file = image.source();
+    if (file.isJpeg()) {
+        int w, h, comp;
+        if (stbi_info_from_memory(file.encoded.data(), (int)file.encoded.size(), &w, &h, &comp) &&
+            (comp == 1 || comp == 3)) {
+            size = "/Width " + std::to_string(w) + " /Height " + std::to_string(h);
+            writeStream(id, "/Type /XObject /Subtype /Image " + size + " /ColorSpace " +
+                            (comp == 1 ? "/DeviceGray" : "/DeviceRGB") +
+                            " /BitsPerComponent 8 /Filter /DCTDecode",
+                        file.encoded.data(), file.encoded.size());
+            return id;
+        }
+    }
+
+    // Sized by the pixels: a picture that failed to decode has just one
+    std::shared_ptr<const ImageData> pixels = image.decoded();
+    size = "/Width " + std::to_string(pixels->width) + " /Height " + std::to_string(pixels->height);
+    size_t count = (size_t)pixels->width * pixels->height;
+    std::vector<uint8_t> rgb(count * 3), alpha(count);
+    std::vector<uint32_t> row(pixels->width);
+    bool opaque = true;
+    for (int y = 0; y < pixels->height; ++y) {
+        pixels->readRow(y, row.data());
+        for (int x = 0; x < pixels->width; ++x) {
+            size_t i = (size_t)y * pixels->width + x;
+            uint32_t p = row[x];
+            rgb[i * 3] = (uint8_t)(p >> 16);
+            rgb[i * 3 + 1] = (uint8_t)(p >> 8);
+            rgb[i * 3 + 2] = (uint8_t)p;
+            alpha[i] = (uint8_t)(p >> 24);
+            opaque &= alpha[i] == 255;
+        }
+    }
+
+    std::string dict = "/Type /XObject /Subtype /Image " + size + " /ColorSpace /DeviceRGB /BitsPerComponent 8";
+    if (!opaque) {
+        int maskId = reserveObject();
+        writeDeflated(maskId, "/Type /XObject /Subtype /Image " + size + " /ColorSpace /DeviceGray /BitsPerComponent 8",
+                      alpha.data(), alpha.size());
+        dict += " /SMask " + std::to_string(maskId) + " 0 R";
+    }
+    writeDeflated(id, dict, rgb.data(), rgb.size());
+    return id;
+}
+
+// PostScript name of the font, reduced to characters allowed in a PDF name
+static std::string postScriptName(const stbtt_fontinfo& info) {
+    int length = 0;
+    const char* utf16 = stbtt_GetFontNameString(&info, &length, STBTT_PLATFORM_ID_MICROSOFT,
+                                                STBTT_MS_EID_UNICODE_BMP, STBTT_MS_LANG_ENGLISH, 6);
+    std::string name;
+    for (int i = 0; utf16 && i + 1 < length; i += 2) {
+        char ch = utf16[i + 1];
+        if (utf16[i] == 0 && ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') ||
+                              (ch >= '0' && ch <= '9') || ch == '-')) {
+            name += ch;
+        }
+    }
+    return name.empty() ? "Font" : name;
+}
+
+void PdfWriter::writeFont(const Font* font, const FontEntry& entry) {
+    const stbtt_fontinfo& info = font->info;
+    double scale = 1000.0 * stbtt_ScaleForMappingEmToPixels(&info, 1.0f); // font units -> 1/1000 em
+
+    // Subsets of different glyph sets need different names: tag from the set
+    uint32_t hash = 2166136261u;
+    for (size_t g = 0; g < entry.glyphs.size(); ++g) {
+        if (entry.glyphs[g]) hash = (hash ^ (uint32_t)g) * 16777619u;
+    }
+    std::string baseFont;
+    for (int i = 0; i < 6; ++i, hash /= 26) baseFont += (char)('A' + hash % 26);
+    baseFont += "+" + postScriptName(info);
+
+    // CFF outlines are embedded whole, TrueType ones as a subset
+    bool cff = info.glyf == 0;
+    std::vector<uint8_t> subset;
+    if (!cff) subset = subsetTrueType(font->buffer.data(), font->buffer.size(), entry.glyphs);
+    const std::vector<uint8_t>& program = subset.empty() ? font->buffer : subset;
+
+    int cidId = reserveObject(), descriptorId = reserveObject();
+    int fileId = reserveObject(), unicodeId = reserveObject();
+
+    beginObject(entry.id);
+    write("<< /Type /Font /Subtype /Type0 /BaseFont /" + baseFont +
+          " /Encoding /Identity-H /DescendantFonts [" + std::to_string(cidId) +
+          " 0 R] /ToUnicode " + std::to_string(unicodeId) + " 0 R >>\nendobj\n");
+
+    std::string widths;
+    int runEnd = -2;
+    for (int g = 0; g < (int)entry.glyphs.size(); ++g) {
+        if (!entry.glyphs[g]) continue;
+        if (g != runEnd + 1) {
+            if (runEnd >= 0) widths += "] ";
+            widths += std::to_string(g) + " [";
+        }
+        int adv, lsb;
+        stbtt_GetGlyphHMetrics(&info, g, &adv, &lsb);
+        widths += std::to_string(std::lround(adv * scale)) + " ";
+        runEnd = g;
+    }
+    if (runEnd >= 0) widths += "]";
+
+    beginObject(cidId);
+    write(std::string("<< /Type /Font /Subtype ") + (cff ? "/CIDFontType0" : "/CIDFontType2") +
+          " /BaseFont /" + baseFont +
+          " /CIDSystemInfo << /Registry (Adobe) /Ordering (Identity) /Supplement 0 >> /FontDescriptor " +
+          std::to_string(descriptorId) + " 0 R /W [" + widths + "]" +
+          (cff ? "" : " /CIDToGIDMap /Identity") + " >>\nendobj\n");
+
+    int x0, y0, x1, y1;
+    stbtt_GetFontBoundingBox(&info, &x0, &y0, &x1, &y1);
+    std::string descriptor = "<< /Type /FontDescriptor /FontName /" + baseFont + " /Flags 4 /FontBBox [";
+    for (int v : {x0, y0, x1, y1}) descriptor += " " + std::to_string(std::lround(v * scale));
+    descriptor += " ] /ItalicAngle 0 /Ascent " + std::to_string(std::lround(font->ascent * scale)) +
+                  " /Descent " + std::to_string(std::lround(font->descent * scale)) +
+                  " /CapHeight " + std::to_string(std::lround(font->ascent * scale)) + " /StemV 80 " +
+                  (cff ? "/FontFile3 " : "/FontFile2 ") + std::to_string(fileId) + " 0 R >>\nendobj\n";
+    beginObject(descriptorId);
+    write(descriptor);
+
+    writeDeflated(fileId, cff ? "/Subtype /OpenType" : "/Length1 " + std::to_string(program.size()),
+                  program.data(), program.size());
+
+    // Glyph ids back to text, for search and copy
+    std::vector<std::string> chars;
+    char line[24];
+    for (size_t g = 1; g < entry.codepoints.size(); ++g) {
+        if (!entry.glyphs[g] || entry.codepoints[g] <= 0) continue;
+        snprintf(line, sizeof(line), "<%04X> <%04X>\n", (unsigned)g, (unsigned)entry.codepoints[g]);
+        chars.push_back(line);
+    }
+    std::string cmap =
+        "/CIDInit /ProcSet findresource begin\n12 dict begin\nbegincmap\n"
+        "/CIDSystemInfo << /Registry (Adobe) /Ordering (UCS) /Supplement 0 >> def\n"
+        "/CMapName /Adobe-Identity-UCS def\n/CMapType 2 def\n"
+        "1 begincodespacerange\n<0000> <FFFF>\nendcodespacerange\n";
+    for (size_t i = 0; i < chars.size(); i += 100) {
+        size_t n = std::min<size_t>(100, chars.size() - i);
+        cmap += std::to_string(n) + " beginbfchar\n";
+        for (size_t j = i; j < i + n; ++j) cmap += chars[j];
+        cmap += "endbfchar\n";
+    }
+    cmap += "endcmap\nCMapName currentdict /CMap defineresource pop\nend\nend\n";
+    writeDeflated(unicodeId, "", reinterpret_cast<const uint8_t*>(cmap.data()), cmap.size());
+}
+
+bool PdfWriter::close() {
+    if (!file) return false;
+
+    if (!failed) {
+        for (const auto& font : fonts) writeFont(font.first, font.second);
+
+        std::string kids;
+        for (int id : pages) kids += std::to_string(id) + " 0 R ";
+        beginObject(2);
+        write("<< /Type /Pages /Kids [" + kids + "] /Count " + std::to_string(pages.size()) +
+              " >>\nendobj\n");
+        beginObject(1);
+        write("<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+
+        uint64_t xref = written;
+        write("xref\n0 " + std::to_string(offsets.size()) + "\n0000000000 65535 f \n");
+        char entry[24];
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            if (!offsets[i]) failed = true;
+            snprintf(entry, sizeof(entry), "%010llu 00000 n \n", (unsigned long long)offsets[i]);
+            write(entry, 20);
+        }
+        write("trailer\n<< /Size " + std::to_string(offsets.size()) +
+              " /Root 1 0 R >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n");
+    }
+
+    bool ok = fclose(file) == 0 && !failed;
+    file = nullptr;
+    fonts.clear();
+    images.clear();
+    if (!ok) {
+        printf("Error: Could not write %s\n", path.c_str());
+        remove(path.c_str());
+    }
+    return ok;
+}
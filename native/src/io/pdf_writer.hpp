@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct SceneSnapshot;
+struct ImageData;
+class Font;
+class MasterContent;
+class SceneObject;
+class TextObject;
+
+// Streaming vector PDF writer for scene snapshots, one page at a time.
+//
+// Rectangles, ellipses and lines become paths, text becomes glyph runs in
+// an embedded subset of its font, and pictures become image XObjects: the
+// original JPEG stream when the picture was decoded from one, otherwise
+// deflated pixels with a soft mask for transparency. Each page's content
+// and pictures are written as soon as the page is added; pictures shared
+// by several objects or pages are written once. Only the fonts wait for
+// close(), since their subsets depend on every page.
+//
+// Page sizes are in canvas pixels at 96 per inch.
+class PdfWriter {
+public:
+    ~PdfWriter();
+
+    bool open(const char* path);
+    // Appends a page showing the `width` x `height` canvas area of `page`
+    bool writePage(const SceneSnapshot& page, int width, int height);
+    // Fails if any write failed; a failed or unfinished file is deleted
+    bool close();
+
+private:
+    struct FontEntry {
+        std::shared_ptr<const Font> font;
+        int id = 0;                     // Type0 font object
+        std::vector<bool> glyphs;       // used glyph ids
+        std::vector<int> codepoints;    // by glyph id, for ToUnicode
+    };
+
+    // Resources and content of the page being written
+    struct PageState {
+        std::string content;
+        std::map<std::string, int> images;  // resource name -> object
+        std::map<const Font*, int> fonts;
+        std::map<int, std::string> alphas;  // alpha -> ExtGState name
+    };
+
+    // Pictures are not kept alive between pages; an entry whose picture is
+    // gone may not match a new picture at the same address
+    struct ImageEntry {
+        std::weak_ptr<const ImageData> image;
+        int id = 0;
+    };
+
+    FILE* file = nullptr;
+    std::string path;
+    uint64_t written = 0;
+    std::vector<uint64_t> offsets;      // by object number; 0 = not written yet
+    std::vector<int> pages;
+    std::map<const ImageData*, ImageEntry> images;
+    std::map<const Font*, FontEntry> fonts;
+    bool failed = false;
+
+    void write(const void* data, size_t size);
+    void write(const std::string& text);
+    int reserveObject();
+    void beginObject(int id);
+    void writeStream(int id, const std::string& dict, const uint8_t* data, size_t size);
+    void writeDeflated(int id, const std::string& dict, const uint8_t* data, size_t size);
+
+    void writeObject(PageState& page, const SceneObject& obj);
+    void writeMaster(PageState& page, const MasterContent& master, bool background, int width, int height);
+    void writeText(PageState& page, const TextObject& text);
+    void setFill(PageState& page, uint32_t color);
+    void setStroke(PageState& page, uint32_t color);
+    void setAlpha(PageState& page, int alpha);
+    int imageObject(const std::shared_ptr<const ImageData>& image);
+    void writeFont(const Font* font, const FontEntry& entry);
+};
@@ -0,0 +1,320 @@
+#include "png_writer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#define MINIZ_HEADER_FILE_ONLY
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "miniz.h"
+
+static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+// Uncompressed bytes per block; enough for deflate to find its matches
+static const size_t kBlockBytes = 512u << 10;
+
+static void putBE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+// Adler-32 of A followed by B, from adler(A), adler(B) and len(B) (zlib)
+static uint32_t adler32Combine(uint32_t a1, uint32_t a2, size_t len2) {
+    const uint64_t base = 65521;
+    uint64_t rem = len2 % base;
+    uint64_t sum1 = a1 & 0xFFFF;
+    uint64_t sum2 = (rem * sum1) % base;
+    sum1 += (a2 & 0xFFFF) + base - 1;
+    sum2 += ((a1 >> 16) & 0xFFFF) + ((a2 >> 16) & 0xFFFF) + base - rem;
+    if (sum1 >= base) sum1 -= base;
+    if (sum1 >= base) sum1 -= base;
+    if (sum2 >= base << 1) sum2 -= base << 1;
+    if (sum2 >= base) sum2 -= base;
+    return (uint32_t)(sum1 | (sum2 << 16));
+}
+
+static void toRgba(const uint32_t* src, int width, uint8_t* dst) {
+    for (int x = 0; x < width; ++x) {
+        uint32_t p = src[x];
+        dst[0] = (uint8_t)(p >> 16);
+        dst[1] = (uint8_t)(p >> 8);
+        dst[2] = (uint8_t)p;
+        dst[3] = (uint8_t)(p >> 24);
+        dst += 4;
+    }
+}
+
+static uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    return (uint8_t)(pb <= pc ? b : c);
+}
+
+// Filters one row into `dst`, returning the sum of the absolute (signed)
+// values of the result, the usual estimate of how well it will compress
+template <typename Predict>
+static uint64_t applyFilter(const uint8_t* row, size_t n, uint8_t* dst, Predict predict) {
+    uint64_t cost = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t v = (uint8_t)(row[i] - predict(i));
+        dst[i] = v;
+        cost += (uint64_t)std::abs((int)(int8_t)v);
+    }
+    return cost;
+}
+
+// Writes the filter byte and filtered row to `out`, picking the filter
+// with the lowest cost as libpng does. Level 0 stores rows unfiltered
+// since nothing will compress them anyway.
+static void filterRow(const uint8_t* row, const uint8_t* prev, size_t n, bool adaptive,
+                      uint8_t* out, uint8_t* scratch) {
+    out[0] = 0;
+    if (!adaptive) {
+        memcpy(out + 1, row, n);
+        return;
+    }
+
+    static const uint8_t zeros[4] = {0, 0, 0, 0};
+    const uint8_t* up = prev;
+    uint8_t* best = out + 1;
+    uint64_t bestCost = applyFilter(row, n, best, [](size_t) { return 0; });
+    auto tryFilter = [&](uint8_t type, uint64_t cost) {
+        if (cost < bestCost) {
+            bestCost = cost;
+            out[0] = type;
+            memcpy(out + 1, scratch, n);
+        }
+    };
+    // Bytes left of the first pixel and above the first row count as zero
+    auto left = [&](size_t i) { return i >= 4 ? row[i - 4] : zeros[i]; };
+    tryFilter(1, applyFilter(row, n, scratch, left));
+    if (!up) {
+        tryFilter(3, applyFilter(row, n, scratch, [&](size_t i) { return left(i) >> 1; }));
+        return;  // Up is None and Paeth is Sub without a row above
+    }
+    tryFilter(2, applyFilter(row, n, scratch, [&](size_t i) { return up[i]; }));
+    tryFilter(3, applyFilter(row, n, scratch, [&](size_t i) { return (left(i) + up[i]) >> 1; }));
+    tryFilter(4, applyFilter(row, n, scratch, [&](size_t i) {
+        return i >= 4 ? paeth(row[i - 4], up[i], up[i - 4]) : up[i];
+    }));
+}
+
+// Level 0: stored deflate blocks, which tdefl produces slowly
+static void storeBlocks(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    while (size > 0) {
+        size_t n = std::min<size_t>(size, 0xFFFF);
+        uint8_t head[5] = {0x00, (uint8_t)n, (uint8_t)(n >> 8), (uint8_t)~n, (uint8_t)(~n >> 8)};
+        out.insert(out.end(), head, head + 5);
+        out.insert(out.end(), data, data + n);
+        data += n;
+        size -= n;
+    }
+}
+
+static mz_bool appendOutput(const void* buf, int len, void* user) {
+    auto* out = static_cast<std::vector<uint8_t>*>(user);
+    const uint8_t* p = static_cast<const uint8_t*>(buf);
+    out->insert(out->end(), p, p + len);
+    return MZ_TRUE;
+}
+
+// One block of rows, encoded as a complete IDAT chunk
+struct PngBlock {
+    int firstRow = 0;
+    int rowCount = 0;
+    std::vector<uint8_t> chunk;   // length, type, data, crc
+    uint32_t adler = 1;
+    size_t rawSize = 0;
+    bool ok = false;
+};
+
+static void encodeBlock(PngBlock& block, const uint32_t* pixels, size_t stride, int width,
+                        const uint8_t* previousRow, unsigned flags, bool adaptive) {
+    size_t rowBytes = (size_t)width * 4;
+    std::vector<uint8_t> rgba(rowBytes * 2);
+    std::vector<uint8_t> scratch(rowBytes);
+    std::vector<uint8_t> filtered((rowBytes + 1) * block.rowCount);
+
+    // The row above the block, converted again rather than shared
+    uint8_t* prev = nullptr;
+    uint8_t* cur = rgba.data();
+    uint8_t* spare = rgba.data() + rowBytes;
+    if (block.firstRow > 0) {
+        toRgba(pixels + (size_t)(block.firstRow - 1) * stride, width, spare);
+        prev = spare;
+    } else if (previousRow) {
+        memcpy(spare, previousRow, rowBytes);
+        prev = spare;
+    }
+    for (int r = 0; r < block.rowCount; ++r) {
+        toRgba(pixels + (size_t)(block.firstRow + r) * stride, width, cur);
+        filterRow(cur, prev, rowBytes, adaptive, &filtered[(rowBytes + 1) * r], scratch.data());
+        prev = cur;
+        std::swap(cur, spare);
+    }
+
+    block.rawSize = filtered.size();
+    block.adler = (uint32_t)mz_adler32(MZ_ADLER32_INIT, filtered.data(), filtered.size());
+
+    block.chunk.assign(8, 0);
+    memcpy(&block.chunk[4], "IDAT", 4);
+    if (!adaptive) {
+        storeBlocks(filtered.data(), filtered.size(), block.chunk);
+    } else {
+        std::unique_ptr<tdefl_compressor, void (*)(void*)> comp(
+            static_cast<tdefl_compressor*>(malloc(sizeof(tdefl_compressor))), free);
+        if (!comp ||
+            tdefl_init(comp.get(), appendOutput, &block.chunk, (int)flags) != TDEFL_STATUS_OKAY ||
+            tdefl_compress_buffer(comp.get(), filtered.data(), filtered.size(), TDEFL_SYNC_FLUSH) !=
+                TDEFL_STATUS_OKAY) {
+            return;
+        }
+    }
+
+    size_t dataSize = block.chunk.size() - 8;
+    putBE32(&block.chunk[0], (uint32_t)dataSize);
+    uint32_t crc = (uint32_t)mz_crc32(MZ_CRC32_INIT, &block.chunk[4], dataSize + 4);
+    block.chunk.resize(block.chunk.size() + 4);
+    putBE32(&block.chunk[8 + dataSize], crc);
+    block.ok = true;
+}
+
+PngWriter::~PngWriter() {
+    if (file) {
+        fclose(file);
+        remove(path.c_str());
+    }
+}
+
+bool PngWriter::writeChunk(const char type[4], const uint8_t* data, size_t size) {
+    uint8_t head[8];
+    putBE32(head, (uint32_t)size);
+    memcpy(head + 4, type, 4);
+    uint32_t crc = (uint32_t)mz_crc32(MZ_CRC32_INIT, head + 4, 4);
+    crc = (uint32_t)mz_crc32(crc, data, size);
+    uint8_t tail[4];
+    putBE32(tail, crc);
+    return fwrite(head, 1, 8, file) == 8 && (size == 0 || fwrite(data, 1, size, file) == size) &&
+           fwrite(tail, 1, 4, file) == 4;
+}
+
+bool PngWriter::open(const char* filePath, int w, int h, int compression, unsigned threadCount) {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+    if (w <= 0 || h <= 0 || (uint64_t)w * 4 + 1 > UINT32_MAX) {
+        printf("Error: Invalid PNG size %dx%d\n", w, h);
+        return false;
+    }
+    path = filePath;
+    file = fopen(filePath, "wb");
+    if (!file) {
+        printf("Error: Could not create %s\n", filePath);
+        return false;
+    }
+
+    width = w;
+    height = h;
+    rowsWritten = 0;
+    threads = threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    level = std::min(9, std::max(0, compression));
+    // Negative window bits: raw deflate, the zlib framing is written here
+    flags = tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    adler = MZ_ADLER32_INIT;
+    previous.clear();
+    failed = false;
+
+    uint8_t ihdr[13];
+    putBE32(ihdr, (uint32_t)w);
+    putBE32(ihdr + 4, (uint32_t)h);
+    ihdr[8] = 8;    // bit depth
+    ihdr[9] = 6;    // RGBA
+    ihdr[10] = 0;   // deflate
+    ihdr[11] = 0;   // adaptive filtering
+    ihdr[12] = 0;   // no interlace
+    static const uint8_t zlibHeader[2] = {0x78, 0x01};
+    failed = fwrite(kSignature, 1, 8, file) != 8 || !writeChunk("IHDR", ihdr, sizeof(ihdr)) ||
+             !writeChunk("IDAT", zlibHeader, sizeof(zlibHeader));
+    if (failed) printf("Error: Could not write %s\n", filePath);
+    return !failed;
+}
+
+bool PngWriter::writeRows(const uint32_t* pixels, int count, size_t stride) {
+    if (!file || failed) return false;
+    if (count <= 0) return true;
+    if (count > height - rowsWritten) {
+        printf("Error: PNG has only %d rows left\n", height - rowsWritten);
+        failed = true;
+        return false;
+    }
+
+    size_t rowBytes = (size_t)width * 4;
+    int rowsPerBlock = (int)std::max<size_t>(1, kBlockBytes / (rowBytes + 1));
+    std::vector<PngBlock> blocks((count + rowsPerBlock - 1) / rowsPerBlock);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i].firstRow = (int)i * rowsPerBlock;
+        blocks[i].rowCount = std::min(rowsPerBlock, count - blocks[i].firstRow);
+    }
+
+    const uint8_t* previousRow = previous.empty() ? nullptr : previous.data();
+    bool adaptive = level > 0;
+    unsigned workers = (unsigned)std::min<size_t>(threads, blocks.size());
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        size_t i;
+        while ((i = next.fetch_add(1)) < blocks.size()) {
+            encodeBlock(blocks[i], pixels, stride, width, previousRow, flags, adaptive);
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned t = 1; t < workers; ++t) pool.emplace_back(work);
+    work();
+    for (auto& th : pool) th.join();
+
+    for (const PngBlock& block : blocks) {
+        if (!block.ok || fwrite(block.chunk.data(), 1, block.chunk.size(), file) != block.chunk.size()) {
+            printf("Error: Could not write PNG data\n");
+            failed = true;
+            return false;
+        }
+        adler = adler32Combine(adler, block.adler, block.rawSize);
+    }
+
+    previous.resize(rowBytes);
+    toRgba(pixels + (size_t)(count - 1) * stride, width, previous.data());
+    rowsWritten += count;
+    return true;
+}
+
+bool PngWriter::close() {
+    if (!file) return false;
+    bool ok = !failed && rowsWritten == height;
+    if (ok) {
+        // Empty final fixed-Huffman block, then the zlib trailer
+        uint8_t tail[6] = {0x03, 0x00};
+        putBE32(tail + 2, adler);
+        ok = writeChunk("IDAT", tail, sizeof(tail)) && writeChunk("IEND", nullptr, 0);
+    } else if (!failed) {
+        printf("Error: PNG closed after %d of %d rows\n", rowsWritten, height);
+    }
+    ok = (fclose(file) == 0) && ok;
+    file = nullptr;
+    // No half-written images left behind
+    if (!ok) remove(path.c_str());
+    return ok;
+}
+
+bool writePng(const char* path, const uint32_t* pixels, int width, int height, int level,
+              unsigned threads) {
+    PngWriter writer;
+    if (!writer.open(path, width, height, level, threads)) return false;
+    bool ok = writer.writeRows(pixels, height, (size_t)width);
+    return writer.close() && ok;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "../core/object.hpp"
+#include "../core/surface.hpp"
 #include "../core/utils.hpp"
 #include <algorithm>
 #include <cmath>
@@ -11,6 +12,8 @@ public:
     EllipseObject(int id, float x, float y, float w, float h, uint32_t color)
         : SceneObject(id, "Ellipse", x, y, w, h), color(color) {}
 
+    std::shared_ptr<Object> clone() const override { return std::make_shared<EllipseObject>(*this); }
+
     int getType() override { return 3; } // 0=rect, 1=text, 2=image, 3=ellipse
 
     void setColor(uint32_t c) override { color = c; }
@@ -36,7 +39,7 @@ public:
         return (dx * dx + dy * dy) <= (rxPad * ryPad);
     }
 
-    void draw(uint32_t* buffer, int bufW, int bufH) override {
+    void draw(const Surface& surface) const override {
         float cx = x + w / 2.0f;
         float cy = y + h / 2.0f;
         float rx = w / 2.0f;
@@ -45,12 +48,12 @@ public:
         if (rx <= 0 || ry <= 0) return;
 
         int x0 = std::max(0, (int)x);
-        int y0 = std::max(0, (int)y);
-        int x1 = std::min(bufW, (int)(x + w));
-        int y1 = std::min(bufH, (int)(y + h));
+        int y0 = std::max(surface.top, (int)y);
+        int x1 = std::min(surface.width, (int)(x + w));
+        int y1 = std::min(surface.bottom(), (int)(y + h));
 
         for (int py = y0; py < y1; ++py) {
-            uint32_t* row = buffer + (py * bufW);
+            uint32_t* row = surface.row(py);
             for (int px = x0; px < x1; ++px) {
                 // Check if point is inside ellipse
                 float dx = (px - cx) / rx;
@@ -1,5 +1,6 @@
 #pragma once
 #include "../core/object.hpp"
+#include "../core/surface.hpp"
 #include "../core/utils.hpp"
 #include <algorithm>
 #include <cmath>
@@ -16,6 +17,8 @@ public:
           color(color), thickness(thickness),
           _x1(x1), _y1(y1), _x2(x2), _y2(y2) {}
 
+    std::shared_ptr<Object> clone() const override { return std::make_shared<LineObject>(*this); }
+
     int getType() override { return 4; } // 0=rect, 1=text, 2=image, 3=ellipse, 4=line
 
     void setColor(uint32_t c) override { color = c; }
@@ -29,6 +32,14 @@ public:
         _y2 += dy;
     }
 
+    void getEndpoints(float& x1, float& y1, float& x2, float& y2) const {
+        x1 = _x1; y1 = _y1; x2 = _x2; y2 = _y2;
+    }
+
+    void setEndpoints(float x1, float y1, float x2, float y2) {
+        _x1 = x1; _y1 = y1; _x2 = x2; _y2 = y2;
+    }
+
     // TODO: implement setRect to stretch line endpoints properly
 
     bool contains(int px, int py) override {
@@ -51,7 +62,7 @@ public:
         return dist <= thickness + 5; // 5px padding for easier selection
     }
 
-    void draw(uint32_t* buffer, int bufW, int bufH) override {
+    void draw(const Surface& surface) const override {
         // Bresenham's line algorithm with thickness
         int x1 = (int)_x1, y1 = (int)_y1, x2 = (int)_x2, y2 = (int)_y2;
         
@@ -60,6 +71,11 @@ public:
         int sx = x1 < x2 ? 1 : -1;
         int sy = y1 < y2 ? 1 : -1;
         int err = dx - dy;
+
+        // Only the rows of the surface; the walk itself is cheap
+        int top = surface.top - thickness / 2;
+        int bottom = surface.bottom() + thickness / 2;
+        if (std::max(y1, y2) < top || std::min(y1, y2) >= bottom) return;
         
         while (true) {
             // Draw thick point
@@ -67,8 +83,9 @@ public:
                 for (int tx = -thickness/2; tx <= thickness/2; ++tx) {
                     int px = x1 + tx;
                     int py = y1 + ty;
-                    if (px >= 0 && px < bufW && py >= 0 && py < bufH) {
-                        buffer[py * bufW + px] = blendColor(buffer[py * bufW + px], color);
+                    if (px >= 0 && px < surface.width && py >= surface.top && py < surface.bottom()) {
+                        uint32_t* p = surface.row(py) + px;
+                        *p = blendColor(*p, color);
                     }
                 }
             }
@@ -1,5 +1,6 @@
 #pragma once
 #include "../core/object.hpp"
+#include "../core/surface.hpp"
 #include "../core/utils.hpp"
 #include <algorithm>
 
@@ -10,6 +11,8 @@ public:
     RectangleObject(int id, float x, float y, float w, float h, uint32_t color)
         : SceneObject(id, "Rectangle", x, y, w, h), color(color) {}
 
+    std::shared_ptr<Object> clone() const override { return std::make_shared<RectangleObject>(*this); }
+
     void setColor(uint32_t c) override { color = c; }
     uint32_t getColor() override { return color; }
 
@@ -19,21 +22,21 @@ public:
                 py >= (int)y - padding && py < (int)y + (int)h + padding);
     }
 
-    void draw(uint32_t* buffer, int bufW, int bufH) override {
+    void draw(const Surface& surface) const override {
         int ix = (int)x;
         int iy = (int)y;
         int iw = (int)w;
         int ih = (int)h;
 
         int x0 = std::max(0, ix);
-        int y0 = std::max(0, iy);
-        int x1 = std::min(bufW, ix + iw);
-        int y1 = std::min(bufH, iy + ih);
+        int y0 = std::max(surface.top, iy);
+        int x1 = std::min(surface.width, ix + iw);
+        int y1 = std::min(surface.bottom(), iy + ih);
 
         if (x0 >= x1 || y0 >= y1) return;
 
         for (int py = y0; py < y1; ++py) {
-            uint32_t* row = buffer + (py * bufW);
+            uint32_t* row = surface.row(py);
             for (int px = x0; px < x1; ++px) {
                 row[px] = blendColor(row[px], color);
             }
@@ -1,7 +1,9 @@
 #pragma once
 #include "../core/object.hpp"
+#include "../core/surface.hpp"
 #include "../core/utils.hpp"
 #include "../core/font.hpp"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -10,12 +12,17 @@ public:
     std::string text;
     uint32_t color;
     float fontSize;
+    std::shared_ptr<const Font> font;
 
     TextObject(int id, float x, float y, std::string txt, uint32_t color, float fontSize = 24.0f)
         : Object(id, "Text", x, y, 100.0f, 30.0f), text(std::move(txt)), color(color), fontSize(fontSize) {
         recalculateBounds();
     }
 
+    std::shared_ptr<Object> clone() const override { return std::make_shared<TextObject>(*this); }
+
+    int getType() override { return 1; }
+
     void setColor(uint32_t c) override { color = c; }
     uint32_t getColor() override { return color; }
     
@@ -31,6 +38,12 @@ public:
     }
     std::string getText() override { return text; }
 
+    void setFont(const std::shared_ptr<const Font>& f) override {
+        if (font == f) return;
+        font = f;
+        recalculateBounds();
+    }
+
     bool contains(int px, int py) override {
         int padding = 20;
         return (px >= (int)x - padding && px < (int)x + (int)w + padding && 
@@ -38,16 +51,16 @@ public:
     }
 
     void recalculateBounds() {
-        Font& font = Font::GetDefault();
-        if (!font.buffer.empty()) {
-            float sc = stbtt_ScaleForPixelHeight(&font.info, fontSize);
+        if (font) {
+            const Font& face = *font;
+            float sc = stbtt_ScaleForPixelHeight(&face.info, fontSize);
             int asc, desc, lg;
-            stbtt_GetFontVMetrics(&font.info, &asc, &desc, &lg);
+            stbtt_GetFontVMetrics(&face.info, &asc, &desc, &lg);
             
             int cursorX = 0;
             for (char c : text) {
                 int adv, lsb;
-                stbtt_GetCodepointHMetrics(&font.info, c, &adv, &lsb);
+                stbtt_GetCodepointHMetrics(&face.info, c, &adv, &lsb);
                 cursorX += (int)(adv * sc);
             }
             
@@ -56,53 +69,52 @@ public:
         }
     }
 
-    void draw(uint32_t* buffer, int bufW, int bufH) override {
-        Font& font = Font::GetDefault();
-        if (font.buffer.empty()) return;
+    void draw(const Surface& surface) const override {
+        if (!this->font) return;
+        if (y + h <= surface.top || y >= surface.bottom()) return;
+        const Font& face = *font;
 
-        float sc = stbtt_ScaleForPixelHeight(&font.info, fontSize);
+        float sc = stbtt_ScaleForPixelHeight(&face.info, fontSize);
         int asc, desc, lg;
-        stbtt_GetFontVMetrics(&font.info, &asc, &desc, &lg);
+        stbtt_GetFontVMetrics(&face.info, &asc, &desc, &lg);
         
         int baseline = (int)y + (int)(asc * sc);
         int cursorX = (int)x;
 
         for (char c : text) {
             int adv, lsb;
-            stbtt_GetCodepointHMetrics(&font.info, c, &adv, &lsb);
+            stbtt_GetCodepointHMetrics(&face.info, c, &adv, &lsb);
             
             int c_x1, c_y1, c_x2, c_y2;
-            stbtt_GetCodepointBitmapBox(&font.info, c, sc, sc, &c_x1, &c_y1, &c_x2, &c_y2);
+            stbtt_GetCodepointBitmapBox(&face.info, c, sc, sc, &c_x1, &c_y1, &c_x2, &c_y2);
             
             int y_off = c_y1 + baseline;
             int x_off = c_x1 + cursorX;
             
             int bw = c_x2 - c_x1;
             int bh = c_y2 - c_y1;
-            if (bw > 0 && bh > 0) {
+            if (bw > 0 && bh > 0 && y_off < surface.bottom() && y_off + bh > surface.top) {
                 std::vector<uint8_t> bitmap(bw * bh);
-                stbtt_MakeCodepointBitmap(&font.info, bitmap.data(), bw, bh, bw, sc, sc, c);
+                stbtt_MakeCodepointBitmap(&face.info, bitmap.data(), bw, bh, bw, sc, sc, c);
                 
                 for (int iy = 0; iy < bh; ++iy) {
                     int screenY = y_off + iy;
-                    if (screenY < 0 || screenY >= bufH) continue;
+                    if (screenY < surface.top || screenY >= surface.bottom()) continue;
+                    uint32_t* row = surface.row(screenY);
                     
                     for (int ix = 0; ix < bw; ++ix) {
                         int screenX = x_off + ix;
-                        if (screenX < 0 || screenX >= bufW) continue;
+                        if (screenX < 0 || screenX >= surface.width) continue;
                         
                         uint8_t alpha = bitmap[iy * bw + ix];
                         if (alpha == 0) continue;
                         
                         uint32_t pixelColor = (color & 0x00FFFFFF) | ((uint32_t)alpha << 24);
-                        buffer[screenY * bufW + screenX] = blendColor(buffer[screenY * bufW + screenX], pixelColor);
+                        row[screenX] = blendColor(row[screenX], pixelColor);
                     }
                 }
             }
             cursorX += (int)(adv * sc);
         }
-        
-        this->w = (float)(cursorX - (int)x);
-        this->h = (float)((asc - desc) * sc);
     }
 };
@@ -0,0 +1,320 @@
+// karrolle_render: renders every slide of PPTX files to PNG without the app.
+//
+//   karrolle_render [options] deck.pptx...
+//     -o, --out DIR        output directory (default: .)
+//     -p, --pdf            one vector PDF per deck, at slide size, instead of PNGs
+//     -w, --width N        image width; height follows the slide aspect
+//     -h, --height N       image height; width follows the slide aspect
+//     -j, --threads N      worker threads (default: all cores)
+//     -f, --font FILE      TrueType font for text (no text without one)
+//
+// Decks are imported and slides rendered on one pool of workers. Slides of
+// a deck already imported are picked before the next deck is opened, so
+// only about one deck per worker is in memory at a time. Each slide renders
+// from its own SceneSnapshot, which needs no lock. A PDF is written page by
+// page by the worker that imported the deck.
+#include "core/document.hpp"
+#include "core/scene_snapshot.hpp"
+#include "import/pptx_importer.hpp"
+#include "io/png_writer.hpp"
+#include "io/pdf_writer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Options {
+    std::string outDir = ".";
+    bool pdf = false;
+    int width = 0;
+    int height = 0;
+    unsigned threads = 0;
+    std::string fontPath;
+    std::vector<std::string> inputs;
+};
+
+// One deck in flight. Slides are snapshots of the imported pages; the
+// Document that owned them is gone by the time they render.
+struct Deck {
+    std::string path;
+    std::string stem;
+    Clock::time_point start;
+    double importMs = 0;
+    int width = 0, height = 0;       // output size
+    int slideWidth = 0, slideHeight = 0;
+    std::vector<std::shared_ptr<const SceneSnapshot>> slides;
+    std::atomic<size_t> remaining{0};
+    std::atomic<size_t> failed{0};
+};
+
+// FIFO of tasks, except that urgent ones (slides of an open deck) jump ahead
+class WorkQueue {
+public:
+    void push(std::function<void()> task, bool urgent = false) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (urgent) tasks.push_front(std::move(task));
+            else tasks.push_back(std::move(task));
+            ++pending;
+        }
+        ready.notify_one();
+    }
+
+    void run() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&] { return !tasks.empty() || pending == 0; });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) ready.notify_all();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::function<void()>> tasks;
+    size_t pending = 0; // queued or running
+};
+
+static std::mutex printMutex;
+
+static std::string fileStem(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+// Box filter from the slide raster to the output size
+static void resample(const std::vector<uint32_t>& src, int sw, int sh,
+                     std::vector<uint32_t>& dst, int dw, int dh) {
+    dst.resize((size_t)dw * dh);
+    for (int y = 0; y < dh; ++y) {
+        int y0 = (int)((int64_t)y * sh / dh);
+        int y1 = std::max(y0 + 1, (int)((int64_t)(y + 1) * sh / dh));
+        for (int x = 0; x < dw; ++x) {
+            int x0 = (int)((int64_t)x * sw / dw);
+            int x1 = std::max(x0 + 1, (int)((int64_t)(x + 1) * sw / dw));
+            uint32_t a = 0, r = 0, g = 0, b = 0;
+            for (int sy = y0; sy < y1; ++sy) {
+                const uint32_t* row = &src[(size_t)sy * sw];
+                for (int sx = x0; sx < x1; ++sx) {
+                    uint32_t p = row[sx];
+                    a += p >> 24;
+                    r += (p >> 16) & 0xFF;
+                    g += (p >> 8) & 0xFF;
+                    b += p & 0xFF;
+                }
+            }
+            uint32_t n = (uint32_t)((y1 - y0) * (x1 - x0));
+            dst[(size_t)y * dw + x] = ((a + n / 2) / n) << 24 | ((r + n / 2) / n) << 16 |
+                                      ((g + n / 2) / n) << 8 | ((b + n / 2) / n);
+        }
+    }
+}
+
+// A deck with slides that could not be written counts as failed
+static void finishDeck(const Deck& deck, std::atomic<int>& failures) {
+    if (deck.failed) ++failures;
+    std::lock_guard<std::mutex> lock(printMutex);
+    double totalMs = msSince(deck.start);
+    size_t n = deck.slides.size();
+    printf("%s: %zu slides at %dx%d, import %.1f ms, render %.1f ms, total %.1f ms (%.1f ms/slide)%s\n",
+           deck.path.c_str(), n, deck.width, deck.height, deck.importMs, totalMs - deck.importMs,
+           totalMs, n ? totalMs / n : 0.0,
+           deck.failed ? " - some slides could not be written" : "");
+}
+
+static void renderSlide(const std::shared_ptr<Deck>& deck, size_t index, const Options& opt,
+                        std::atomic<int>& failures) {
+    std::vector<uint32_t> raster((size_t)deck->slideWidth * deck->slideHeight);
+    deck->slides[index]->render(raster.data(), deck->slideWidth, deck->slideHeight);
+
+    std::vector<uint32_t> scaled;
+    const std::vector<uint32_t>* image = &raster;
+    if (deck->width != deck->slideWidth || deck->height != deck->slideHeight) {
+        resample(raster, deck->slideWidth, deck->slideHeight, scaled, deck->width, deck->height);
+        image = &scaled;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "_%03zu.png", index + 1);
+    std::string path = opt.outDir + "/" + deck->stem + name;
+    // Slides already keep every worker busy: one encoding thread each
+    if (!writePng(path.c_str(), image->data(), deck->width, deck->height, 6, 1)) {
+        fprintf(stderr, "Error: Could not write %s\n", path.c_str());
+        ++deck->failed;
+    }
+
+    if (--deck->remaining == 0) finishDeck(*deck, failures);
+}
+
+static void importDeck(const std::string& path, const Options& opt,
+                       const std::vector<uint8_t>& font, unsigned decodeThreads,
+                       WorkQueue& queue, std::atomic<int>& failures) {
+    auto deck = std::make_shared<Deck>();
+    deck->path = path;
+    deck->stem = fileStem(path);
+    deck->start = Clock::now();
+
+    {
+        Document document;
+        if (!font.empty()) document.setFont(font.data(), (int)font.size());
+        PptxImporter importer(document);
+        importer.setDecodeThreads(decodeThreads);
+        if (!importer.import(path.c_str())) {
+            ++failures;
+            return;
+        }
+
+        deck->slideWidth = std::max(1, importer.getSlideWidth());
+        deck->slideHeight = std::max(1, importer.getSlideHeight());
+        for (size_t i = 0; i < document.pageCount(); ++i) {
+            deck->slides.push_back(document.page(i).scene.snapshot());
+        }
+    }
+    deck->importMs = msSince(deck->start);
+
+    deck->width = opt.width;
+    deck->height = opt.height;
+    if (!deck->width && !deck->height) {
+        deck->width = deck->slideWidth;
+        deck->height = deck->slideHeight;
+    } else if (!deck->height) {
+        deck->height = std::max(1, (int)((int64_t)deck->width * deck->slideHeight / deck->slideWidth));
+    } else if (!deck->width) {
+        deck->width = std::max(1, (int)((int64_t)deck->height * deck->slideWidth / deck->slideHeight));
+    }
+
+    if (opt.pdf) {
+        std::string out = opt.outDir + "/" + deck->stem + ".pdf";
+        PdfWriter writer;
+        bool ok = writer.open(out.c_str());
+        for (const auto& slide : deck->slides) {
+            ok = ok && writer.writePage(*slide, deck->slideWidth, deck->slideHeight);
+        }
+        if (!writer.close() || !ok) {
+            fprintf(stderr, "Error: Could not write %s\n", out.c_str());
+            ++deck->failed;
+        }
+        deck->width = deck->slideWidth;
+        deck->height = deck->slideHeight;
+        finishDeck(*deck, failures);
+        return;
+    }
+
+    if (deck->slides.empty()) {
+        finishDeck(*deck, failures);
+        return;
+    }
+    deck->remaining = deck->slides.size();
+    for (size_t i = deck->slides.size(); i-- > 0;) {
+        queue.push([deck, i, &opt, &failures] { renderSlide(deck, i, opt, failures); }, true);
+    }
+}
+
+static void usage() {
+    fprintf(stderr,
+            "usage: karrolle_render [options] deck.pptx...\n"
+            "  -o, --out DIR      output directory (default: .)\n"
+            "  -p, --pdf          one vector PDF per deck, at slide size, instead of PNGs\n"
+            "  -w, --width N      image width; height follows the slide aspect\n"
+            "  -h, --height N     image height; width follows the slide aspect\n"
+            "  -j, --threads N    worker threads (default: all cores)\n"
+            "  -f, --font FILE    TrueType font for text\n");
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (arg == "-o" || arg == "--out") {
+            if (!(v = value())) return false;
+            opt.outDir = v;
+        } else if (arg == "-p" || arg == "--pdf") {
+            opt.pdf = true;
+        } else if (arg == "-w" || arg == "--width") {
+            if (!(v = value()) || (opt.width = atoi(v)) <= 0) return false;
+        } else if (arg == "-h" || arg == "--height") {
+            if (!(v = value()) || (opt.height = atoi(v)) <= 0) return false;
+        } else if (arg == "-j" || arg == "--threads") {
+            if (!(v = value()) || atoi(v) <= 0) return false;
+            opt.threads = (unsigned)atoi(v);
+        } else if (arg == "-f" || arg == "--font") {
+            if (!(v = value())) return false;
+            opt.fontPath = v;
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            opt.inputs.push_back(arg);
+        }
+    }
+    return !opt.inputs.empty();
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+    if (opt.threads == 0) opt.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<uint8_t> font;
+    if (!opt.fontPath.empty()) {
+        std::ifstream in(opt.fontPath, std::ios::binary);
+        font.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (font.empty()) {
+            fprintf(stderr, "Error: Could not read font %s\n", opt.fontPath.c_str());
+            return 1;
+        }
+    } else {
+        fprintf(stderr, "Warning: no --font given, text will not be drawn\n");
+    }
+
+    // With more decks than workers, decks already run in parallel and
+    // each import decodes its pictures on its own thread
+    unsigned decodeThreads = opt.inputs.size() >= opt.threads ? 1 : opt.threads;
+
+    Clock::time_point start = Clock::now();
+    WorkQueue queue;
+    std::atomic<int> failures{0};
+    for (const std::string& path : opt.inputs) {
+        queue.push([&, path] { importDeck(path, opt, font, decodeThreads, queue, failures); });
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < opt.threads; ++t) workers.emplace_back([&] { queue.run(); });
+    queue.run();
+    for (auto& w : workers) w.join();
+
+    printf("%zu files in %.1f ms with %u threads, %d failed\n",
+           opt.inputs.size(), msSince(start), opt.threads, failures.load());
+    return failures ? 1 : 0;
+}